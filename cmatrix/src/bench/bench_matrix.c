@@ -0,0 +1,456 @@
+/**
+ * @file bench/bench_matrix.c
+ * @brief benchmarks of matrix library
+ *
+ * every case is swept over square sizes from 4 up to the largest one it
+ * supports, a size is warmed up and timed repeatedly, and the results are
+ * written as JSON with the median and p99 time and GFLOP/s or GB/s
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+// include
+
+#include "matrix/matrix.h"
+#include "matrix/matrix_ext.h"
+#include "matrix/utils.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// macros
+
+#ifndef CMATRIX_VERSION
+/**
+ * \def CMATRIX_VERSION
+ *
+ * the version of the library, given by the build system
+ */
+#define CMATRIX_VERSION "unknown"
+#endif
+
+/**
+ * \def MAX_SAMPLES
+ *
+ * the maximum number of timed runs of a size
+ */
+#define MAX_SAMPLES 1000
+
+// types
+
+/**
+ * @brief the inputs of a benchmark run
+ */
+typedef struct BenchStateT {
+  uint8_t size;          ///< the size of the square operands
+  MatrixT *lhs;          ///< the left hand side operand
+  MatrixT *rhs;          ///< the right hand side operand
+  const char *file_path; ///< the scratch file of the file cases
+  double file_bytes;     ///< the size of the scratch file
+} BenchStateT;
+
+/**
+ * @brief a benchmark case
+ */
+typedef struct BenchCaseT {
+  const char *name;                          ///< the name of the case
+  uint8_t max_size;                          ///< the largest size to sweep
+  void (*setup)(BenchStateT *state);         ///< prepare a size, or NULL
+  void (*run)(const BenchStateT *state);     ///< the timed function
+  double (*flop)(const BenchStateT *state); ///< nominal flops, or NULL
+  double (*byte)(const BenchStateT *state); ///< bytes moved, or NULL
+} BenchCaseT;
+
+/**
+ * @brief the options of the benchmark
+ */
+typedef struct BenchOptionT {
+  const char *filter;    ///< run only the case with this name, or NULL
+  size_t warmup;         ///< the number of warm-up runs of a size
+  size_t repeat;         ///< the number of timed runs of a size
+  double budget;         ///< the time limit of a size in seconds
+  const char *output;    ///< the JSON file, or NULL for stdout
+  const char *file_path; ///< the scratch file of the file cases
+} BenchOptionT;
+
+// functions: helpers
+
+/**
+ * @brief get the monotonic time
+ *
+ * @return the time in nanoseconds
+ */
+static double get_time_ns(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+/**
+ * @brief compare two samples for qsort
+ */
+static int compare_sample(const void *lhs, const void *rhs) {
+  double l = *(const double *)lhs;
+  double r = *(const double *)rhs;
+  return (l > r) - (l < r);
+}
+
+/**
+ * @brief the nominal flops of n^3 complex multiply-adds
+ */
+static double cube_flop(const BenchStateT *state) {
+  return 8.0 * pow(state->size, 3);
+}
+
+/**
+ * @brief the nominal flops of a complex LU factorization, 8 n^3 / 3
+ */
+static double lu_flop(const BenchStateT *state) {
+  return cube_flop(state) / 3.0;
+}
+
+/**
+ * @brief the nominal flops of a complex QR factorization, 16 n^3 / 3
+ */
+static double qr_flop(const BenchStateT *state) {
+  return 2.0 * cube_flop(state) / 3.0;
+}
+
+/**
+ * @brief the bytes of two operands read and one result written
+ */
+static double add_byte(const BenchStateT *state) {
+  return 3.0 * state->size * state->size * sizeof(complex float);
+}
+
+/**
+ * @brief the bytes of one operand read and one result written
+ */
+static double transpose_byte(const BenchStateT *state) {
+  return 2.0 * state->size * state->size * sizeof(complex float);
+}
+
+/**
+ * @brief the bytes of two operands read and their Kronecker product written
+ */
+static double tensor_byte(const BenchStateT *state) {
+  double square = (double)state->size * state->size;
+  return (2.0 + square) * square * sizeof(complex float);
+}
+
+/**
+ * @brief the bytes of the scratch file
+ */
+static double file_byte(const BenchStateT *state) {
+  return state->file_bytes;
+}
+
+/**
+ * @brief save the left hand side operand and record the file size
+ */
+static void setup_file(BenchStateT *state) {
+  save_matrix_to_file(state->file_path, &state->lhs, 1);
+  FILE *file_handle = fopen(state->file_path, "r");
+  if (file_handle == NULL) {
+    log_error("panic: failed to open file (%.64s)", state->file_path);
+    exit(EXIT_FAILURE);
+  }
+  fseek(file_handle, 0, SEEK_END);
+  state->file_bytes = ftell(file_handle);
+  fclose(file_handle);
+}
+
+// functions: cases
+
+/**
+ * @brief multiply the operands
+ */
+static void run_mul(const BenchStateT *state) {
+  drop_matrix(mul_matrix(state->lhs, state->rhs));
+}
+
+/**
+ * @brief add the operands
+ */
+static void run_add(const BenchStateT *state) {
+  drop_matrix(add_matrix(state->lhs, state->rhs));
+}
+
+/**
+ * @brief transpose the left hand side operand
+ */
+static void run_transpose(const BenchStateT *state) {
+  drop_matrix(transpose_matrix(state->lhs));
+}
+
+/**
+ * @brief do the Kronecker product of the operands
+ */
+static void run_tensor(const BenchStateT *state) {
+  drop_matrix(tensor_product_matrix(state->lhs, state->rhs));
+}
+
+/**
+ * @brief get the determinant of the left hand side operand
+ */
+static void run_determinant(const BenchStateT *state) {
+  volatile complex float determinant = get_matrix_determinant(state->lhs);
+  (void)determinant;
+}
+
+/**
+ * @brief invert the left hand side operand
+ */
+static void run_inverse(const BenchStateT *state) {
+  drop_matrix(get_inverse_matrix(state->lhs));
+}
+
+/**
+ * @brief LU decomposition of the left hand side operand
+ */
+static void run_lu(const BenchStateT *state) {
+  drop_matrices(decomposition_matrix_lu(state->lhs), 2);
+}
+
+/**
+ * @brief QR decomposition of the left hand side operand
+ */
+static void run_qr(const BenchStateT *state) {
+  drop_matrices(decomposition_matrix_qr(state->lhs), 2);
+}
+
+/**
+ * @brief eigen system of the left hand side operand, 100 iterations
+ */
+static void run_eigen(const BenchStateT *state) {
+  drop_matrices(get_matrix_eigensystem_qr(state->lhs, 100), 2);
+}
+
+/**
+ * @brief save the left hand side operand to the scratch file
+ */
+static void run_save(const BenchStateT *state) {
+  save_matrix_to_file(state->file_path, (MatrixT **)&state->lhs, 1);
+}
+
+/**
+ * @brief load the scratch file
+ */
+static void run_load(const BenchStateT *state) {
+  size_t matrix_number = 0;
+  MatrixT **matrices = new_matrix_from_file(state->file_path, &matrix_number);
+  drop_matrices(matrices, matrix_number);
+}
+
+/**
+ * @brief the benchmark cases, a Kronecker product has to fit in 255, and
+ *        the methods looping with uint8_t up to the size stop at 254
+ */
+static const BenchCaseT bench_cases[] = {
+    {"mul_matrix", UINT8_MAX, NULL, run_mul, cube_flop, NULL},
+    {"add_matrix", UINT8_MAX, NULL, run_add, NULL, add_byte},
+    {"transpose_matrix", UINT8_MAX, NULL, run_transpose, NULL,
+     transpose_byte},
+    {"tensor_product_matrix", 15, NULL, run_tensor, NULL, tensor_byte},
+    {"get_matrix_determinant", UINT8_MAX - 1, NULL, run_determinant, lu_flop,
+     NULL},
+    {"get_inverse_matrix", UINT8_MAX - 1, NULL, run_inverse, cube_flop, NULL},
+    {"decomposition_matrix_lu", UINT8_MAX - 1, NULL, run_lu, lu_flop, NULL},
+    {"decomposition_matrix_qr", UINT8_MAX, NULL, run_qr, qr_flop, NULL},
+    {"get_matrix_eigensystem_qr", UINT8_MAX, NULL, run_eigen, NULL, NULL},
+    {"save_matrix_to_file", UINT8_MAX, setup_file, run_save, NULL, file_byte},
+    {"new_matrix_from_file", UINT8_MAX, setup_file, run_load, NULL,
+     file_byte},
+};
+
+/**
+ * @brief the sizes of a sweep, clamped to the largest size of a case
+ */
+static const uint8_t bench_sizes[] = {4, 8, 16, 32, 64, 128, UINT8_MAX};
+
+/**
+ * @brief write a rate, or null if it is not defined for the case
+ *
+ * @param[in] output the JSON file
+ * @param[in] key the key of the rate
+ * @param[in] amount the amount of work, in flops or bytes
+ * @param[in] time_ns the time of the work
+ * @param[in] defined whether the rate is defined
+ */
+static void write_rate(FILE *output, const char *key, double amount,
+                       double time_ns, bool defined) {
+  if (defined) {
+    fprintf(output, ", \"%s\": %.6g", key, amount / time_ns);
+  } else {
+    fprintf(output, ", \"%s\": null", key);
+  }
+}
+
+/**
+ * @brief sweep a case over its sizes and write the results
+ *
+ * @param[in] bench_case the case to run
+ * @param[in] option the options of the benchmark
+ * @param[in] output the JSON file
+ * @param[in,out] first whether no result is written yet
+ */
+static void run_case(const BenchCaseT *bench_case, const BenchOptionT *option,
+                     FILE *output, bool *first) {
+  double *samples = malloc(option->repeat * sizeof(double));
+  uint8_t last_size = 0;
+  for (size_t i = 0; i < sizeof(bench_sizes) / sizeof(bench_sizes[0]); ++i) {
+    uint8_t size = MIN(bench_sizes[i], bench_case->max_size);
+    if (size == last_size) {
+      break;
+    }
+    last_size = size;
+    BenchStateT state = {
+        .size = size,
+        .lhs = new_random_matrix(size, size),
+        .rhs = new_random_matrix(size, size),
+        .file_path = option->file_path,
+        .file_bytes = 0.0,
+    };
+    if (bench_case->setup != NULL) {
+      bench_case->setup(&state);
+    }
+    // warm up and time until the repeat count or the budget is reached,
+    // there is always one sample
+    double budget_ns = option->budget * 1e9;
+    double begin = get_time_ns();
+    for (size_t w = 0; w < option->warmup; ++w) {
+      bench_case->run(&state);
+      if (get_time_ns() - begin > budget_ns) {
+        break;
+      }
+    }
+    begin = get_time_ns();
+    size_t count = 0;
+    while (count < option->repeat &&
+           (count == 0 || get_time_ns() - begin < budget_ns)) {
+      double start = get_time_ns();
+      bench_case->run(&state);
+      samples[count++] = get_time_ns() - start;
+    }
+    qsort(samples, count, sizeof(double), compare_sample);
+    double median = count % 2 == 1 ? samples[count / 2]
+                                   : (samples[count / 2 - 1] +
+                                      samples[count / 2]) / 2.0;
+    // p99 by nearest rank
+    double p99 = samples[(size_t)ceil(0.99 * count) - 1];
+    fprintf(output,
+            "%s\n    {\"name\": \"%s\", \"size\": %u, \"samples\": %zu, "
+            "\"min_ns\": %.0f, \"median_ns\": %.0f, \"p99_ns\": %.0f",
+            *first ? "" : ",", bench_case->name, size, count, samples[0],
+            median, p99);
+    write_rate(output, "gflops",
+               bench_case->flop ? bench_case->flop(&state) : 0.0, median,
+               bench_case->flop != NULL);
+    write_rate(output, "gbps",
+               bench_case->byte ? bench_case->byte(&state) : 0.0, median,
+               bench_case->byte != NULL);
+    fputc('}', output);
+    fflush(output);
+    *first = false;
+    drop_matrix(state.lhs);
+    drop_matrix(state.rhs);
+    // skip the larger sizes once they would exceed the budget, assuming the
+    // cost grows at least as n^3
+    if (i + 1 < sizeof(bench_sizes) / sizeof(bench_sizes[0]) &&
+        median * pow((double)bench_sizes[i + 1] / size, 3) > budget_ns) {
+      break;
+    }
+  }
+  if (bench_case->setup == setup_file) {
+    remove(option->file_path);
+  }
+  free(samples);
+}
+
+/**
+ * @brief parse a non-negative number of an option
+ *
+ * @param[in] name the name of the option
+ * @param[in] value the value of the option
+ * @return the number
+ */
+static double parse_number(const char *name, const char *value) {
+  char *end = NULL;
+  double number = value ? strtod(value, &end) : 0.0;
+  if (value == NULL || *end != '\0' || !(number >= 0.0)) {
+    log_error("panic: option %.64s needs a non-negative number", name);
+    exit(EXIT_FAILURE);
+  }
+  return number;
+}
+
+// functions: main
+
+int main(int argc, char **argv) {
+  BenchOptionT option = {
+      .filter = NULL,
+      .warmup = 3,
+      .repeat = 30,
+      .budget = 1.0,
+      .output = NULL,
+      .file_path = "bench_matrix.txt",
+  };
+  for (int i = 1; i < argc; ++i) {
+    const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+    if (strcmp(argv[i], "--filter") == 0 && value != NULL) {
+      option.filter = value;
+    } else if (strcmp(argv[i], "--warmup") == 0) {
+      option.warmup = parse_number(argv[i], value);
+    } else if (strcmp(argv[i], "--repeat") == 0) {
+      option.repeat = MAX(MIN(parse_number(argv[i], value), MAX_SAMPLES), 1);
+    } else if (strcmp(argv[i], "--budget") == 0) {
+      option.budget = parse_number(argv[i], value);
+    } else if (strcmp(argv[i], "--output") == 0 && value != NULL) {
+      option.output = value;
+    } else if (strcmp(argv[i], "--file") == 0 && value != NULL) {
+      option.file_path = value;
+    } else {
+      log_error("usage: %.64s [--filter name] [--warmup count] "
+                "[--repeat count] [--budget seconds] [--output json] "
+                "[--file scratch]",
+                argv[0]);
+      return EXIT_FAILURE;
+    }
+    ++i;
+  }
+  FILE *output = stdout;
+  if (option.output != NULL) {
+    output = fopen(option.output, "w");
+    if (output == NULL) {
+      log_error("panic: failed to open file (%.64s)", option.output);
+      return EXIT_FAILURE;
+    }
+  }
+  srand(1);
+  fprintf(output,
+          "{\n  \"library\": \"cmatrix\", \"version\": \"%s\", "
+          "\"warmup\": %zu, \"repeat\": %zu, \"budget_s\": %g,\n"
+          "  \"results\": [",
+          CMATRIX_VERSION, option.warmup, option.repeat, option.budget);
+  bool first = true;
+  for (size_t i = 0; i < sizeof(bench_cases) / sizeof(bench_cases[0]); ++i) {
+    if (option.filter == NULL ||
+        strcmp(option.filter, bench_cases[i].name) == 0) {
+      run_case(&bench_cases[i], &option, output, &first);
+    }
+  }
+  fprintf(output, "\n  ]\n}\n");
+  if (first && option.filter != NULL) {
+    log_error("panic: no benchmark case named %.64s", option.filter);
+    return EXIT_FAILURE;
+  }
+  if (output != stdout) {
+    fclose(output);
+  }
+  return 0;
+}
@@ -9,7 +9,10 @@
 
 // standard include
 
+// C++ spells complex as _Complex instead, see matrix/matrix.hpp
+#ifndef __cplusplus
 #include <complex.h>
+#endif
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -32,6 +35,15 @@ typedef enum MatrixOrientation {
   COLUMN = 1, ///< column orientation
 } MatrixOrientation;
 
+/**
+ * @brief the operation applied to an operand of multiplication
+ */
+typedef enum MatrixOperation {
+  NO_TRANSPOSE = 0,        ///< use the matrix as it is
+  TRANSPOSE = 1,           ///< use the transpose of the matrix
+  CONJUGATE_TRANSPOSE = 2, ///< use the conjugate transpose of the matrix
+} MatrixOperation;
+
 // functions: init
 
 /**
@@ -79,6 +91,15 @@ extern MatrixT *new_random_real_matrix(uint8_t row, uint8_t col);
  */
 extern MatrixT *new_random_matrix(uint8_t row, uint8_t col);
 
+/**
+ * @brief construct a random real matrix with standard normal entries
+ *
+ * @param[in] row the row size of matrix
+ * @param[in] col the col size of matrix
+ * @return the random matrix with size ( \p row, \p col )
+ */
+extern MatrixT *new_random_normal_matrix(uint8_t row, uint8_t col);
+
 /**
  * @brief construct an zero matrix from an array
  *
@@ -208,10 +229,11 @@ extern complex float get_matrix_trace(const MatrixT *matrix);
 extern complex float get_matrix_frobenius_norm(const MatrixT *matrix);
 
 /**
- * @brief get the matrix rank
+ * @brief get the numerical matrix rank by QR with column pivoting
  *
  * @param[in] matrix the matrix to use
- * @return the rank of \p matrix
+ * @return the number of diagonal values of R above |R(1, 1)| max(row, col)
+ *         FLT_EPSILON
  */
 extern uint8_t get_matrix_rank(const MatrixT *matrix);
 
@@ -297,6 +319,28 @@ extern void show_matrix_with_precision(const MatrixT *matrix,
  */
 extern MatrixT *transpose_matrix(const MatrixT *matrix);
 
+/**
+ * @brief conjugate transpose a matrix
+ *
+ * @param[in] matrix the matrix to use
+ * @return the conjugate transpose matrix of \p matrix
+ */
+extern MatrixT *conjugate_transpose_matrix(const MatrixT *matrix);
+
+/**
+ * @brief transpose a square matrix in place
+ *
+ * @param[in,out] matrix the square matrix to transpose
+ */
+extern void transpose_matrix_in_place(MatrixT *matrix);
+
+/**
+ * @brief conjugate transpose a square matrix in place
+ *
+ * @param[in,out] matrix the square matrix to conjugate transpose
+ */
+extern void conjugate_transpose_matrix_in_place(MatrixT *matrix);
+
 /**
  * @brief do scalar product with the scalar and a matrix
  *
@@ -353,7 +397,56 @@ extern MatrixT *vector_cross_product_3d(const MatrixT *lhv, const MatrixT *rhv);
 extern MatrixT *mul_matrix(const MatrixT *lhm, const MatrixT *rhm);
 
 /**
- * @brief do tensor product of two matrices
+ * @brief do multiplication of two matrices with operations applied,
+ *        the operands are read in place without being transposed
+ *
+ * @param[in] lhm_operation the operation applied to \p lhm
+ * @param[in] lhm the left hand side matrix
+ * @param[in] rhm_operation the operation applied to \p rhm
+ * @param[in] rhm the right hand side matrix
+ * @return the product of op( \p lhm ) and op( \p rhm )
+ */
+extern MatrixT *mul_matrix_with_operation(MatrixOperation lhm_operation,
+                                          const MatrixT *lhm,
+                                          MatrixOperation rhm_operation,
+                                          const MatrixT *rhm);
+
+/**
+ * @brief do multiplication of a chain of matrices in the cheapest order,
+ *        the order is found by dynamic programming on their sizes
+ *
+ * @param[in] matrices the matrices from left to right
+ * @param[in] matrices_number the number of matrices
+ * @return the product of \p matrices
+ */
+extern MatrixT *mul_matrix_chain(MatrixT **matrices, size_t matrices_number);
+
+/**
+ * @brief do multiplication of a matrix and a vector
+ *
+ * @param[in] operation the operation applied to \p matrix
+ * @param[in] matrix the matrix to use
+ * @param[in] vector the row or column vector to use
+ * @return the column vector op( \p matrix ) \p vector
+ */
+extern MatrixT *mul_matrix_vector(MatrixOperation operation,
+                                  const MatrixT *matrix, const MatrixT *vector);
+
+/**
+ * @brief do rank one update of a matrix in place
+ *        ( \p matrix += \p alpha \p lhv \p rhv ^T )
+ *
+ * @param[in,out] matrix the matrix to update
+ * @param[in] alpha the scalar of the update
+ * @param[in] lhv the vector with the row size of \p matrix
+ * @param[in] rhv the vector with the column size of \p matrix
+ */
+extern void rank_one_update_matrix(MatrixT *matrix, complex float alpha,
+                                   const MatrixT *lhv, const MatrixT *rhv);
+
+/**
+ * @brief do tensor product of two matrices, the size of the product can not
+ *        be over 255, use matrix/matrix_kron.h to apply larger ones
  *
  * @param[in] lhm the left hand side matrix
  * @param[in] rhm the right hand side matrix
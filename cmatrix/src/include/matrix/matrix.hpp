@@ -0,0 +1,506 @@
+/**
+ * @file matrix/matrix.hpp
+ * @brief C++17 header of matrix library
+ *
+ * cmatrix::Matrix owns a MatrixT and drops it when it is destroyed, it can be
+ * moved but not copied, clone() makes a copy
+ *
+ * +, -, the products with a scalar, conj() and hadamard() build expressions
+ * which are evaluated by a single loop when they are assigned to a Matrix,
+ * so a * A + b * B makes no temporary and reads A and B once, * between two
+ * matrices is evaluated at once by mul_matrix()
+ *
+ * expressions refer to the matrices they read, they should be assigned to a
+ * Matrix in the statement which builds them rather than kept with auto
+ */
+
+#pragma once
+#ifndef __MATRIX_MATRIX_HPP__
+#define __MATRIX_MATRIX_HPP__
+
+// include
+
+// the C headers write complex float, which is spelled _Complex float in C++
+#define complex _Complex
+extern "C" {
+#include "matrix/matrix.h"
+#include "matrix/utils.h"
+}
+#undef complex
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
+
+namespace cmatrix {
+
+// types
+
+/**
+ * @brief the element of matrices, it has the layout of complex float
+ */
+using Complex = std::complex<float>;
+
+class Matrix;
+
+/**
+ * @brief the base of expressions, E is the expression itself
+ */
+template <typename E> struct Expression {
+  /**
+   * @brief get the expression itself
+   *
+   * @return the expression
+   */
+  const E &self() const { return static_cast<const E &>(*this); }
+};
+
+namespace detail {
+
+/**
+ * @brief how an expression keeps an operand, matrices are kept by reference
+ *        and expressions by value
+ */
+template <typename E> struct Stored {
+  using type = E; ///< the type of the member
+};
+
+template <> struct Stored<Matrix> {
+  using type = const Matrix &; ///< the type of the member
+};
+
+/**
+ * @brief convert a value of the C library
+ *
+ * @param[in] value the value
+ * @return the same value
+ */
+inline Complex to_complex(_Complex float value) {
+  return {__real__ value, __imag__ value};
+}
+
+/**
+ * @brief convert a value for the C library
+ *
+ * @param[in] value the value
+ * @return the same value
+ */
+inline _Complex float from_complex(Complex value) {
+  _Complex float result;
+  __real__ result = value.real();
+  __imag__ result = value.imag();
+  return result;
+}
+
+/**
+ * @brief multiply two values without the checks of infinity of operator*,
+ *        which keep the loops from being vectorized
+ *
+ * @param[in] lhs the left value
+ * @param[in] rhs the right value
+ * @return the product
+ */
+inline Complex mul(Complex lhs, Complex rhs) {
+  return {lhs.real() * rhs.real() - lhs.imag() * rhs.imag(),
+          lhs.real() * rhs.imag() + lhs.imag() * rhs.real()};
+}
+
+/**
+ * @brief panic if two operands have different sizes
+ *
+ * @param[in] lhs the left operand
+ * @param[in] rhs the right operand
+ */
+template <typename L, typename R>
+void check_size(const L &lhs, const R &rhs) {
+  // boundary test: equal size
+  if (lhs.rows() != rhs.rows() || lhs.cols() != rhs.cols()) {
+    log_error(
+        "panic: lhm size (%u, %u) is not compatible with rhm size (%u, %u)",
+        lhs.rows(), lhs.cols(), rhs.rows(), rhs.cols());
+    std::exit(EXIT_FAILURE);
+  }
+}
+
+/**
+ * @brief the operation of +
+ */
+struct AddOperation {
+  static Complex apply(Complex lhs, Complex rhs) { return lhs + rhs; }
+};
+
+/**
+ * @brief the operation of -
+ */
+struct SubOperation {
+  static Complex apply(Complex lhs, Complex rhs) { return lhs - rhs; }
+};
+
+/**
+ * @brief the operation of hadamard()
+ */
+struct HadamardOperation {
+  static Complex apply(Complex lhs, Complex rhs) { return mul(lhs, rhs); }
+};
+
+} // namespace detail
+
+/**
+ * @brief an element-wise operation of two expressions with the same size
+ */
+template <typename L, typename R, typename Operation>
+class BinaryExpression
+    : public Expression<BinaryExpression<L, R, Operation>> {
+public:
+  BinaryExpression(const L &lhs, const R &rhs) : lhs_(lhs), rhs_(rhs) {
+    detail::check_size(lhs, rhs);
+  }
+  uint8_t rows() const { return lhs_.rows(); }
+  uint8_t cols() const { return lhs_.cols(); }
+  Complex operator[](size_t index) const {
+    return Operation::apply(lhs_[index], rhs_[index]);
+  }
+
+private:
+  typename detail::Stored<L>::type lhs_; ///< the left operand
+  typename detail::Stored<R>::type rhs_; ///< the right operand
+};
+
+/**
+ * @brief the product of a scalar and an expression
+ */
+template <typename E>
+class ScaleExpression : public Expression<ScaleExpression<E>> {
+public:
+  ScaleExpression(Complex scalar, const E &expression)
+      : scalar_(scalar), expression_(expression) {}
+  uint8_t rows() const { return expression_.rows(); }
+  uint8_t cols() const { return expression_.cols(); }
+  Complex operator[](size_t index) const {
+    return detail::mul(scalar_, expression_[index]);
+  }
+
+private:
+  Complex scalar_;                              ///< the scalar
+  typename detail::Stored<E>::type expression_; ///< the expression
+};
+
+/**
+ * @brief the conjugate of an expression
+ */
+template <typename E>
+class ConjugateExpression : public Expression<ConjugateExpression<E>> {
+public:
+  explicit ConjugateExpression(const E &expression) : expression_(expression) {}
+  uint8_t rows() const { return expression_.rows(); }
+  uint8_t cols() const { return expression_.cols(); }
+  Complex operator[](size_t index) const {
+    return std::conj(expression_[index]);
+  }
+
+private:
+  typename detail::Stored<E>::type expression_; ///< the expression
+};
+
+/**
+ * @brief a matrix which owns its MatrixT
+ */
+class Matrix : public Expression<Matrix> {
+public:
+  /**
+   * @brief an empty matrix, it can only be assigned or destroyed
+   */
+  Matrix() noexcept = default;
+
+  /**
+   * @brief a matrix filled with zero
+   *
+   * @param[in] row the row size of the matrix
+   * @param[in] col the column size of the matrix
+   */
+  Matrix(uint8_t row, uint8_t col) : matrix_(new_matrix(row, col)) {}
+
+  /**
+   * @brief take the ownership of a matrix of the C library
+   *
+   * @param[in] matrix the matrix, dropped with this object
+   */
+  explicit Matrix(MatrixT *matrix) noexcept : matrix_(matrix) {}
+
+  /**
+   * @brief evaluate an expression
+   *
+   * @param[in] expression the expression
+   */
+  template <typename E>
+  Matrix(const Expression<E> &expression)
+      : matrix_(new_matrix(expression.self().rows(),
+                           expression.self().cols())) {
+    assign(expression.self());
+  }
+
+  Matrix(const Matrix &) = delete;
+  Matrix &operator=(const Matrix &) = delete;
+
+  Matrix(Matrix &&other) noexcept
+      : matrix_(std::exchange(other.matrix_, nullptr)) {}
+
+  Matrix &operator=(Matrix &&other) noexcept {
+    if (this != &other) {
+      drop_matrix(matrix_);
+      matrix_ = std::exchange(other.matrix_, nullptr);
+    }
+    return *this;
+  }
+
+  ~Matrix() { drop_matrix(matrix_); }
+
+  /**
+   * @brief evaluate an expression into this matrix, the expression can read
+   *        this matrix as every element only reads the same position
+   *
+   * @param[in] expression the expression
+   * @return this matrix
+   */
+  template <typename E> Matrix &operator=(const Expression<E> &expression) {
+    const E &self = expression.self();
+    if (matrix_ == nullptr || rows() != self.rows() || cols() != self.cols()) {
+      *this = Matrix(expression);
+    } else {
+      assign(self);
+    }
+    return *this;
+  }
+
+  template <typename E> Matrix &operator+=(const Expression<E> &expression);
+  template <typename E> Matrix &operator-=(const Expression<E> &expression);
+  Matrix &operator*=(Complex scalar);
+
+  // functions: init
+
+  /**
+   * @brief get an identity matrix
+   *
+   * @param[in] row the row size of the matrix
+   * @param[in] col the column size of the matrix
+   * @return the identity matrix
+   */
+  static Matrix identity(uint8_t row, uint8_t col) {
+    return Matrix(new_identity_matrix(row, col));
+  }
+
+  /**
+   * @brief get a matrix with random real and imaginary parts in [0, 1]
+   *
+   * @param[in] row the row size of the matrix
+   * @param[in] col the column size of the matrix
+   * @return the random matrix
+   */
+  static Matrix random(uint8_t row, uint8_t col) {
+    return Matrix(new_random_matrix(row, col));
+  }
+
+  /**
+   * @brief copy the matrix
+   *
+   * @return the copy
+   */
+  Matrix clone() const { return Matrix(copy_matrix(matrix_)); }
+
+  // functions: access
+
+  uint8_t rows() const noexcept { return matrix_ ? matrix_->size[0] : 0; }
+  uint8_t cols() const noexcept { return matrix_ ? matrix_->size[1] : 0; }
+  size_t size() const noexcept { return (size_t)rows() * cols(); }
+
+  Complex *data() noexcept {
+    return reinterpret_cast<Complex *>(matrix_->data);
+  }
+  const Complex *data() const noexcept {
+    return reinterpret_cast<const Complex *>(matrix_->data);
+  }
+
+  /**
+   * @brief get an element, the indices start from 0 unlike get_matrix_val()
+   *
+   * @param[in] row the row index
+   * @param[in] col the column index
+   * @return the element
+   */
+  Complex &operator()(size_t row, size_t col) {
+    return data()[row * cols() + col];
+  }
+  Complex operator()(size_t row, size_t col) const {
+    return data()[row * cols() + col];
+  }
+
+  /**
+   * @brief get an element in row-major order
+   *
+   * @param[in] index the index from 0
+   * @return the element
+   */
+  Complex operator[](size_t index) const { return data()[index]; }
+
+  MatrixT *get() noexcept { return matrix_; }
+  const MatrixT *get() const noexcept { return matrix_; }
+
+  /**
+   * @brief give up the ownership of the matrix
+   *
+   * @return the matrix, to be dropped by drop_matrix()
+   */
+  MatrixT *release() noexcept { return std::exchange(matrix_, nullptr); }
+
+  // functions: attribute and manipulate
+
+  Matrix transpose() const { return Matrix(transpose_matrix(matrix_)); }
+  Matrix adjoint() const {
+    return Matrix(conjugate_transpose_matrix(matrix_));
+  }
+  Matrix inverse() const { return Matrix(get_inverse_matrix(matrix_)); }
+  Complex determinant() const {
+    return detail::to_complex(get_matrix_determinant(matrix_));
+  }
+  Complex trace() const {
+    return detail::to_complex(get_matrix_trace(matrix_));
+  }
+
+private:
+  /**
+   * @brief write an expression with the size of the matrix, the loop is the
+   *        only pass over the operands
+   *
+   * @param[in] expression the expression
+   */
+  template <typename E> void assign(const E &expression) {
+    Complex *output = data();
+    const size_t number = size();
+    for (size_t i = 0; i < number; ++i) {
+      output[i] = expression[i];
+    }
+  }
+
+  MatrixT *matrix_ = nullptr; ///< the owned matrix
+};
+
+// functions: expressions
+
+template <typename L, typename R>
+BinaryExpression<L, R, detail::AddOperation>
+operator+(const Expression<L> &lhs, const Expression<R> &rhs) {
+  return {lhs.self(), rhs.self()};
+}
+
+template <typename L, typename R>
+BinaryExpression<L, R, detail::SubOperation>
+operator-(const Expression<L> &lhs, const Expression<R> &rhs) {
+  return {lhs.self(), rhs.self()};
+}
+
+template <typename E>
+ScaleExpression<E> operator-(const Expression<E> &expression) {
+  return {Complex(-1.0f, 0.0f), expression.self()};
+}
+
+template <typename E>
+ScaleExpression<E> operator*(Complex scalar, const Expression<E> &expression) {
+  return {scalar, expression.self()};
+}
+
+template <typename E>
+ScaleExpression<E> operator*(const Expression<E> &expression, Complex scalar) {
+  return {scalar, expression.self()};
+}
+
+template <typename E>
+ScaleExpression<E> operator/(const Expression<E> &expression, Complex scalar) {
+  return {Complex(1.0f, 0.0f) / scalar, expression.self()};
+}
+
+/**
+ * @brief the element-wise product of two expressions
+ *
+ * @param[in] lhs the left expression
+ * @param[in] rhs the right expression
+ * @return the expression of the product
+ */
+template <typename L, typename R>
+BinaryExpression<L, R, detail::HadamardOperation>
+hadamard(const Expression<L> &lhs, const Expression<R> &rhs) {
+  return {lhs.self(), rhs.self()};
+}
+
+/**
+ * @brief the element-wise conjugate of an expression
+ *
+ * @param[in] expression the expression
+ * @return the expression of the conjugate
+ */
+template <typename E>
+ConjugateExpression<E> conj(const Expression<E> &expression) {
+  return ConjugateExpression<E>(expression.self());
+}
+
+namespace detail {
+
+/**
+ * @brief get a matrix of the C library for an operand of a product
+ *
+ * @param[in] matrix the operand
+ * @param[out] storage unused
+ * @return the matrix of the operand
+ */
+inline const MatrixT *get_operand(const Matrix &matrix, Matrix &storage) {
+  (void)storage;
+  return matrix.get();
+}
+
+/**
+ * @brief evaluate an operand of a product
+ *
+ * @param[in] expression the operand
+ * @param[out] storage the evaluated operand
+ * @return the matrix of the operand
+ */
+template <typename E>
+const MatrixT *get_operand(const Expression<E> &expression, Matrix &storage) {
+  storage = Matrix(expression);
+  return storage.get();
+}
+
+} // namespace detail
+
+/**
+ * @brief the matrix product, it is evaluated at once by mul_matrix()
+ *
+ * @param[in] lhs the left expression
+ * @param[in] rhs the right expression
+ * @return the product
+ */
+template <typename L, typename R>
+Matrix operator*(const Expression<L> &lhs, const Expression<R> &rhs) {
+  Matrix lhs_storage;
+  Matrix rhs_storage;
+  return Matrix(mul_matrix(detail::get_operand(lhs.self(), lhs_storage),
+                           detail::get_operand(rhs.self(), rhs_storage)));
+}
+
+template <typename E>
+Matrix &Matrix::operator+=(const Expression<E> &expression) {
+  return *this = *this + expression;
+}
+
+template <typename E>
+Matrix &Matrix::operator-=(const Expression<E> &expression) {
+  return *this = *this - expression;
+}
+
+inline Matrix &Matrix::operator*=(Complex scalar) {
+  return *this = scalar * *this;
+}
+
+} // namespace cmatrix
+
+#endif
@@ -0,0 +1,133 @@
+/**
+ * @file matrix/matrix_alloc.h
+ * @brief allocation header file of matrix library
+ *
+ * all the memory of the library goes through an allocator which can be
+ * replaced at runtime, the live and peak bytes are counted and every
+ * allocation is attributed to the outermost public function in progress on
+ * its thread, which is the entry the user called
+ *
+ * the matrices returned by the library must be released by its drop
+ * functions, free() can not release them, the only exceptions are the raw
+ * arrays of get_matrix_memory_site() and get_matrix_profile(), which are
+ * allocated by malloc() outside of the accounting and released by free()
+ */
+
+#pragma once
+#ifndef __MATRIX_MATRIX_ALLOC_H__
+#define __MATRIX_MATRIX_ALLOC_H__
+
+// include
+
+#include <stddef.h>
+#include <stdint.h>
+
+// types
+
+/**
+ * @brief allocate memory
+ *
+ * @param[in] byte the number of bytes, never 0
+ * @param[in] context the context of the allocator
+ * @return the memory aligned as malloc(), or NULL if it fails
+ */
+typedef void *(*MatrixAllocateFunc)(size_t byte, void *context);
+
+/**
+ * @brief resize memory allocated by the same allocator
+ *
+ * @param[in] pointer the memory
+ * @param[in] byte the new number of bytes, never 0
+ * @param[in] context the context of the allocator
+ * @return the resized memory aligned as malloc(), or NULL if it fails
+ */
+typedef void *(*MatrixReallocateFunc)(void *pointer, size_t byte,
+                                      void *context);
+
+/**
+ * @brief release memory allocated by the same allocator
+ *
+ * @param[in] pointer the memory, never NULL
+ * @param[in] context the context of the allocator
+ */
+typedef void (*MatrixReleaseFunc)(void *pointer, void *context);
+
+/**
+ * @brief an allocator of the library
+ */
+typedef struct MatrixAllocatorT {
+  MatrixAllocateFunc allocate;     ///< allocate memory
+  MatrixReallocateFunc reallocate; ///< resize memory, NULL to copy instead
+  MatrixReleaseFunc release;       ///< release memory, NULL for arenas
+  void *context;                   ///< the context passed to the functions
+} MatrixAllocatorT;
+
+/**
+ * @brief the allocation counters of the library
+ */
+typedef struct MatrixMemoryT {
+  uint64_t live_byte;   ///< the bytes allocated and not released
+  uint64_t peak_byte;   ///< the maximum of the live bytes
+  uint64_t alloc_count; ///< the number of allocations
+  uint64_t free_count;  ///< the number of releases
+} MatrixMemoryT;
+
+/**
+ * @brief the allocation counters of a public function
+ */
+typedef struct MatrixMemorySiteT {
+  const char *name;     ///< the name of the function
+  uint64_t alloc_count; ///< the number of allocations
+  uint64_t alloc_byte;  ///< the cumulative allocated bytes
+  uint64_t live_byte;   ///< the bytes allocated and not released
+  uint64_t peak_byte;   ///< the maximum of the live bytes
+} MatrixMemorySiteT;
+
+// functions: allocator
+
+/**
+ * @brief use an allocator for the following allocations, the memory allocated
+ *        before is still released by its own allocator
+ *
+ * @param[in] allocator the allocator, NULL to use malloc() again
+ */
+extern void set_matrix_allocator(const MatrixAllocatorT *allocator);
+
+/**
+ * @brief get the allocator in use
+ *
+ * @return the allocator
+ */
+extern MatrixAllocatorT get_matrix_allocator(void);
+
+// functions: accounting
+
+/**
+ * @brief get the allocation counters of the library
+ *
+ * @return the counters
+ */
+extern MatrixMemoryT get_matrix_memory(void);
+
+/**
+ * @brief get the allocation counters of the public functions, sorted by the
+ *        live bytes and then the peak bytes
+ *
+ * @param[out] site_number the number of functions
+ * @return the counters allocated by malloc() and not counted, freed by
+ *         free(), or NULL if nothing is allocated
+ */
+extern MatrixMemorySiteT *get_matrix_memory_site(size_t *site_number);
+
+/**
+ * @brief set the peak bytes to the live bytes, the counters of the public
+ *        functions included
+ */
+extern void reset_matrix_memory_peak(void);
+
+/**
+ * @brief print the allocation counters as a table
+ */
+extern void show_matrix_memory(void);
+
+#endif
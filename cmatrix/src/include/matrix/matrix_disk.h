@@ -0,0 +1,140 @@
+/**
+ * @file matrix/matrix_disk.h
+ * @brief disk matrix header file of matrix library
+ *
+ * a disk matrix lives in a binary file and is never loaded as a whole, its
+ * values are split into square tiles which are read and written one by one
+ * as MatrixT, so its size is only limited by the file system
+ *
+ * the out-of-core algorithms keep a few tiles in memory and ask the system
+ * to prefetch the next tiles while the current ones are computed, a tile
+ * of edge t takes 8 t^3 flops for 16 t^2 bytes read, so the largest tile
+ * (255) keeps the computation busy on most disks
+ */
+
+#pragma once
+#ifndef __MATRIX_MATRIX_DISK_H__
+#define __MATRIX_MATRIX_DISK_H__
+
+// include
+
+#include "matrix/matrix.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// types
+
+/**
+ * @brief disk matrix, the tiles are stored row by row after a header and
+ *        the tiles on the last row and column are padded to full tiles
+ */
+typedef struct DiskMatrixT {
+  size_t size[2];        ///< the row and column size
+  uint8_t tile;          ///< the edge of a tile
+  size_t tile_number[2]; ///< the number of tiles in a column and a row
+  int file;              ///< the file descriptor
+} DiskMatrixT;
+
+// functions: init
+
+/**
+ * @brief construct a zero disk matrix in a new file
+ *
+ * @param[in] file_path the path of the file, it is overwritten
+ * @param[in] row the row size of matrix
+ * @param[in] col the column size of matrix
+ * @param[in] tile the edge of a tile
+ * @return the disk matrix with size ( \p row, \p col )
+ */
+extern DiskMatrixT *new_disk_matrix(const char *file_path, size_t row,
+                                    size_t col, uint8_t tile);
+
+/**
+ * @brief open a disk matrix saved in a file
+ *
+ * @param[in] file_path the path of the file
+ * @return the disk matrix
+ */
+extern DiskMatrixT *open_disk_matrix(const char *file_path);
+
+/**
+ * @brief construct a disk matrix from a matrix
+ *
+ * @param[in] file_path the path of the file, it is overwritten
+ * @param[in] matrix the matrix to save
+ * @param[in] tile the edge of a tile
+ * @return the disk matrix with the same values
+ */
+extern DiskMatrixT *new_disk_matrix_from_matrix(const char *file_path,
+                                                const MatrixT *matrix,
+                                                uint8_t tile);
+
+/**
+ * @brief construct a matrix from a disk matrix
+ *
+ * @param[in] disk_matrix the disk matrix to load, its size can not be over
+ *            255
+ * @return the matrix with the same values
+ */
+extern MatrixT *new_matrix_from_disk_matrix(const DiskMatrixT *disk_matrix);
+
+/**
+ * @brief close a disk matrix, its file is kept
+ *
+ * @param[in] disk_matrix the disk matrix to close
+ */
+extern void drop_disk_matrix(DiskMatrixT *disk_matrix);
+
+// functions: tiles
+
+/**
+ * @brief read a tile of a disk matrix
+ *
+ * @param[in] disk_matrix the disk matrix
+ * @param[in] row the tile row, from 1
+ * @param[in] col the tile column, from 1
+ * @return the tile, smaller than the tile edge on the last row and column
+ */
+extern MatrixT *get_disk_matrix_tile(const DiskMatrixT *disk_matrix,
+                                     size_t row, size_t col);
+
+/**
+ * @brief write a tile of a disk matrix
+ *
+ * @param[in,out] disk_matrix the disk matrix
+ * @param[in] row the tile row, from 1
+ * @param[in] col the tile column, from 1
+ * @param[in] tile the tile with the size given by get_disk_matrix_tile()
+ */
+extern void set_disk_matrix_tile(DiskMatrixT *disk_matrix, size_t row,
+                                 size_t col, const MatrixT *tile);
+
+// functions: out-of-core
+
+/**
+ * @brief multiplication of two disk matrices with the same tile edge, only
+ *        three tiles are kept in memory
+ *
+ * @param[in] file_path the path of the file of the product
+ * @param[in] lhs the left hand side disk matrix
+ * @param[in] rhs the right hand side disk matrix
+ * @return the product
+ */
+extern DiskMatrixT *mul_disk_matrix(const char *file_path,
+                                    const DiskMatrixT *lhs,
+                                    const DiskMatrixT *rhs);
+
+/**
+ * @brief LU decomposition without pivoting of a square disk matrix in
+ *        place, L (with an unit diagonal, which is not stored) and U
+ *        overwrite the lower and upper triangles, only three tiles are kept
+ *        in memory
+ *
+ * the decomposition fails on a zero pivot, it is stable for diagonally
+ * dominant and positive definite matrices
+ *
+ * @param[in,out] disk_matrix the disk matrix to decompose
+ */
+extern void decomposition_disk_matrix_lu(DiskMatrixT *disk_matrix);
+
+#endif
@@ -11,6 +11,32 @@
 
 #include "matrix/matrix.h"
 
+// types
+
+/**
+ * @brief the side where a matrix is applied
+ */
+typedef enum MatrixSide {
+  LEFT = 0,  ///< the matrix is applied on the left hand side
+  RIGHT = 1, ///< the matrix is applied on the right hand side
+} MatrixSide;
+
+/**
+ * @brief the triangle of a matrix which is referenced
+ */
+typedef enum MatrixTriangle {
+  UPPER = 0, ///< only the upper triangle is referenced
+  LOWER = 1, ///< only the lower triangle is referenced
+} MatrixTriangle;
+
+/**
+ * @brief the diagonal of a triangular matrix
+ */
+typedef enum MatrixDiagonal {
+  NON_UNIT = 0, ///< the diagonal is read from the matrix
+  UNIT = 1,     ///< the diagonal is assumed to be ones and is not read
+} MatrixDiagonal;
+
 // function: extensions
 
 /**
@@ -30,13 +56,26 @@ extern MatrixT **upper_triangularize_matrix(const MatrixT *matrix);
 extern MatrixT **decomposition_matrix_lu(const MatrixT *matrix);
 
 /**
- * @brief simplify a matrix
+ * @brief simplify a matrix to its reduced row echelon form
  *
  * @param[in] matrix the matrix to simplify
  * @return simplified \p matrix
  */
 extern MatrixT *simplify_matrix(const MatrixT *matrix);
 
+/**
+ * @brief simplify a matrix to its reduced row echelon form, and get the
+ *        pivot columns
+ *
+ * @param[in] matrix the matrix to simplify
+ * @param[out] pivot the pivot column (from 1) of each non-zero row, ignored
+ *             if NULL, it needs min(row, col) entries
+ * @param[out] rank the number of pivots, ignored if NULL
+ * @return simplified \p matrix
+ */
+extern MatrixT *simplify_matrix_with_pivot(const MatrixT *matrix,
+                                           uint8_t *pivot, uint8_t *rank);
+
 /**
  * @brief decompose a matrix with QR method
  *
@@ -55,4 +94,159 @@ extern MatrixT **decomposition_matrix_qr(const MatrixT *matrix);
 extern MatrixT **get_matrix_eigensystem_qr(const MatrixT *matrix,
                                            size_t max_iter);
 
+/**
+ * @brief solve a triangular system, op( \p matrix ) X = \p rhs if \p side
+ *        is LEFT, or X op( \p matrix ) = \p rhs if \p side is RIGHT
+ *
+ * @param[in] side the side where \p matrix is applied
+ * @param[in] triangle the triangle of \p matrix to reference
+ * @param[in] operation the operation applied to \p matrix
+ * @param[in] diagonal whether \p matrix has an unit diagonal
+ * @param[in] matrix the square triangular matrix
+ * @param[in] rhs the right hand sides
+ * @return the solution X with the size of \p rhs
+ */
+extern MatrixT *solve_triangular_matrix(MatrixSide side,
+                                        MatrixTriangle triangle,
+                                        MatrixOperation operation,
+                                        MatrixDiagonal diagonal,
+                                        const MatrixT *matrix,
+                                        const MatrixT *rhs);
+
+/**
+ * @brief multiply a triangular matrix, op( \p matrix ) \p rhs if \p side
+ *        is LEFT, or \p rhs op( \p matrix ) if \p side is RIGHT
+ *
+ * @param[in] side the side where \p matrix is applied
+ * @param[in] triangle the triangle of \p matrix to reference
+ * @param[in] operation the operation applied to \p matrix
+ * @param[in] diagonal whether \p matrix has an unit diagonal
+ * @param[in] matrix the square triangular matrix
+ * @param[in] rhs the matrix to multiply
+ * @return the product with the size of \p rhs
+ */
+extern MatrixT *mul_triangular_matrix(MatrixSide side, MatrixTriangle triangle,
+                                      MatrixOperation operation,
+                                      MatrixDiagonal diagonal,
+                                      const MatrixT *matrix,
+                                      const MatrixT *rhs);
+
+/**
+ * @brief decompose a Hermitian positive-definite matrix with Cholesky method
+ *        ( \p matrix = L L^H ), only the lower triangle of \p matrix is read
+ *
+ * @param[in] matrix the matrix to use
+ * @return the lower triangular factor L
+ */
+extern MatrixT *decomposition_matrix_cholesky(const MatrixT *matrix);
+
+/**
+ * @brief decompose a Hermitian positive-definite matrix with Cholesky method
+ *        in place, the lower triangle is overwritten by the factor L and the
+ *        strict upper triangle is neither read nor written
+ *
+ * @param[in,out] matrix the matrix to decompose
+ */
+extern void decomposition_matrix_cholesky_in_place(MatrixT *matrix);
+
+/**
+ * @brief solve a Hermitian positive-definite system with its Cholesky factor
+ *
+ * @param[in] factor the factor L, only its lower triangle is read
+ * @param[in] rhs the right hand sides
+ * @return the solution X of L L^H X = \p rhs
+ */
+extern MatrixT *solve_matrix_cholesky(const MatrixT *factor,
+                                      const MatrixT *rhs);
+
+/**
+ * @brief get the logarithm of the determinant of a Hermitian
+ *        positive-definite matrix from its Cholesky factor
+ *
+ * @param[in] factor the factor L, only its diagonal is read
+ * @return the log determinant 2 sum(log(L(i, i)))
+ */
+extern float get_matrix_log_determinant_cholesky(const MatrixT *factor);
+
+/**
+ * @brief singular value decomposition of a matrix ( \p matrix = U S V^H ),
+ *        the triangular factor of the QR decomposition is orthogonalized by
+ *        the one-sided Jacobi method
+ *
+ * with k = min(row, col), the economy form gives U (row, k), S (k, k) and
+ * V^H (k, col), the full form gives U (row, row), S (row, col) and
+ * V^H (col, col), the singular values are in descending order
+ *
+ * @param[in] matrix the matrix to use
+ * @param[in] economy whether return the economy (thin) form
+ * @return U, S and V^H of \p matrix
+ */
+extern MatrixT **decomposition_matrix_svd(const MatrixT *matrix, bool economy);
+
+/**
+ * @brief truncated singular value decomposition of a matrix by a randomized
+ *        range finder, the leading \p rank singular triplets are returned
+ *
+ * the range of \p matrix is sampled by a Gaussian sketch with \p rank +
+ * \p oversampling columns, so the cost is O(row col rank) rather than a
+ * full decomposition, power iterations improve the accuracy when the
+ * singular values decay slowly
+ *
+ * @param[in] matrix the matrix to use
+ * @param[in] rank the number of singular triplets ( 0 < \p rank <=
+ *            min(row, col) )
+ * @param[in] oversampling the extra sketch columns, 5 to 10 is typical
+ * @param[in] power_iteration the number of power iterations, 1 or 2 is
+ *            typical
+ * @return U (row, \p rank), S ( \p rank, \p rank) and V^H ( \p rank, col)
+ */
+extern MatrixT **decomposition_matrix_randomized_svd(const MatrixT *matrix,
+                                                     uint8_t rank,
+                                                     uint8_t oversampling,
+                                                     size_t power_iteration);
+
+/**
+ * @brief solve the least squares problem min |A X - B| for every column
+ *        of B with one factorization
+ *
+ * a full rank system is solved by QR with column pivoting, of A if it is
+ * tall and of A^H if it is wide, which gives the solution with minimum
+ * norm, a rank deficient system falls back to the minimum norm solution
+ * of the singular value decomposition
+ *
+ * @param[in] matrix the matrix A
+ * @param[in] rhs the right hand sides B with the same row size as A
+ * @param[out] rank the numerical rank of A, ignored if NULL
+ * @return the solution X with size (col of A, col of B)
+ */
+extern MatrixT *solve_matrix_least_squares(const MatrixT *matrix,
+                                           const MatrixT *rhs, uint8_t *rank);
+
+/**
+ * @brief get the Moore-Penrose pseudo inverse of a matrix
+ *
+ * @param[in] matrix the matrix to use
+ * @return the pseudo inverse of \p matrix
+ */
+extern MatrixT *get_pseudo_inverse_matrix(const MatrixT *matrix);
+
+/**
+ * @brief get the condition number of a matrix in 2-norm
+ *
+ * @param[in] matrix the matrix to use
+ * @return the ratio of the largest to the smallest singular value
+ */
+extern float get_matrix_condition_number(const MatrixT *matrix);
+
+/**
+ * @brief get an orthonormal basis of the null space of a matrix by QR with
+ *        column pivoting
+ *
+ * @param[in] matrix the matrix to use
+ * @param[out] rank the numerical rank of \p matrix , ignored if NULL
+ * @return the basis with size (col, col - rank) as columns, or NULL if
+ *         \p matrix has full column rank
+ */
+extern MatrixT *get_matrix_null_space(const MatrixT *matrix, uint8_t *rank);
+
 #endif
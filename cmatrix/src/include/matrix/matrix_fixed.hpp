@@ -0,0 +1,547 @@
+/**
+ * @file matrix/matrix_fixed.hpp
+ * @brief C++17 fixed-size matrices of matrix library
+ *
+ * cmatrix::FixedMatrix<T, R, C> keeps its elements in place in row-major
+ * order, so small matrices like 3x3 rotations and 4x4 transforms need no
+ * allocation, the sizes are template arguments and the operations are
+ * expanded element by element at compile time, they are constexpr when the
+ * operations of T are (float and double in C++17)
+ *
+ * the determinant and the inverse are written out by cofactors up to 4x4 and
+ * use Gauss-Jordan elimination above it
+ *
+ * a FixedMatrix of Complex can be viewed as a MatrixT without a copy
+ */
+
+#pragma once
+#ifndef __MATRIX_MATRIX_FIXED_HPP__
+#define __MATRIX_MATRIX_FIXED_HPP__
+
+// include
+
+#include "matrix/matrix.hpp"
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <type_traits>
+#include <utility>
+
+namespace cmatrix {
+
+// types
+
+/**
+ * @brief a matrix with the size ( \p R, \p C ) known at compile time, it is
+ *        an aggregate like std::array: FixedMatrix<float, 2, 2>{{1, 2, 3, 4}}
+ */
+template <typename T, size_t R, size_t C> struct FixedMatrix {
+  static_assert(R > 0 && C > 0, "size must bigger than 0");
+
+  T data[R * C]; ///< the elements in row-major order
+
+  // functions: init
+
+  /**
+   * @brief get a matrix filled with a value
+   *
+   * @param[in] value the value
+   * @return the matrix
+   */
+  static constexpr FixedMatrix filled(T value) {
+    return filled(value, std::make_index_sequence<R * C>());
+  }
+
+  /**
+   * @brief get a matrix filled with zero
+   *
+   * @return the zero matrix
+   */
+  static constexpr FixedMatrix zero() { return filled(T(0)); }
+
+  /**
+   * @brief get an identity matrix
+   *
+   * @return the identity matrix
+   */
+  static constexpr FixedMatrix identity() {
+    return identity(std::make_index_sequence<R * C>());
+  }
+
+  /**
+   * @brief copy a matrix of the C library, panic if the size is different
+   *
+   * @param[in] matrix the matrix
+   * @return the copy
+   */
+  static FixedMatrix from_matrix(const MatrixT *matrix) {
+    static_assert(std::is_same_v<T, Complex>, "elements must be Complex");
+    // boundary test: null pointer
+    if (matrix == nullptr) {
+      log_error("panic: null pointer error at %s", __func__);
+      std::exit(EXIT_FAILURE);
+    }
+    // boundary test: equal size
+    if (matrix->size[0] != R || matrix->size[1] != C) {
+      log_error("panic: matrix size (%u, %u) is not compatible with (%zu, %zu)",
+                matrix->size[0], matrix->size[1], R, C);
+      std::exit(EXIT_FAILURE);
+    }
+    FixedMatrix result{};
+    for (size_t i = 0; i < R * C; ++i) {
+      result.data[i] = detail::to_complex(matrix->data[i]);
+    }
+    return result;
+  }
+
+  // functions: access
+
+  static constexpr size_t rows() { return R; }
+  static constexpr size_t cols() { return C; }
+  static constexpr size_t size() { return R * C; }
+
+  /**
+   * @brief get an element, the indices start from 0
+   *
+   * @param[in] row the row index
+   * @param[in] col the column index
+   * @return the element
+   */
+  constexpr T &operator()(size_t row, size_t col) {
+    return data[row * C + col];
+  }
+  constexpr const T &operator()(size_t row, size_t col) const {
+    return data[row * C + col];
+  }
+
+  constexpr T &operator[](size_t index) { return data[index]; }
+  constexpr const T &operator[](size_t index) const { return data[index]; }
+
+  /**
+   * @brief view the elements as a matrix of the C library without a copy, it
+   *        must not be dropped and lives as long as this matrix
+   *
+   * @return the view
+   */
+  MatrixT view() const {
+    static_assert(std::is_same_v<T, Complex>, "elements must be Complex");
+    static_assert(R <= UINT8_MAX && C <= UINT8_MAX, "size must fit MatrixT");
+    MatrixT matrix;
+    matrix.size[0] = R;
+    matrix.size[1] = C;
+    // the view is only read by the functions which take const MatrixT *
+    matrix.data = reinterpret_cast<_Complex float *>(const_cast<T *>(data));
+    return matrix;
+  }
+
+  /**
+   * @brief copy to a matrix of the C++ wrapper
+   *
+   * @return the copy
+   */
+  Matrix to_matrix() const {
+    MatrixT matrix = view();
+    return Matrix(copy_matrix(&matrix));
+  }
+
+  // functions: manipulate
+
+  constexpr FixedMatrix<T, C, R> transpose() const {
+    return transpose(std::make_index_sequence<R * C>());
+  }
+
+  constexpr FixedMatrix<T, C, R> adjoint() const {
+    return adjoint(std::make_index_sequence<R * C>());
+  }
+
+  constexpr T trace() const {
+    static_assert(R == C, "matrix must be squared");
+    return trace(std::make_index_sequence<R>());
+  }
+
+  constexpr T determinant() const;
+  constexpr FixedMatrix inverse() const;
+
+private:
+  template <size_t... I>
+  static constexpr FixedMatrix filled(T value, std::index_sequence<I...>) {
+    return {{((void)I, value)...}};
+  }
+
+  template <size_t... I>
+  static constexpr FixedMatrix identity(std::index_sequence<I...>) {
+    return {{(I / C == I % C ? T(1) : T(0))...}};
+  }
+
+  template <size_t... I>
+  constexpr FixedMatrix<T, C, R> transpose(std::index_sequence<I...>) const {
+    return {{data[I % R * C + I / R]...}};
+  }
+
+  template <size_t... I>
+  constexpr FixedMatrix<T, C, R> adjoint(std::index_sequence<I...>) const;
+
+  template <size_t... I>
+  constexpr T trace(std::index_sequence<I...>) const {
+    return (data[I * C + I] + ...);
+  }
+};
+
+namespace detail {
+
+/**
+ * @brief the conjugate which is constexpr for real numbers
+ *
+ * @param[in] value the value
+ * @return the conjugate
+ */
+template <typename T> constexpr T conjugate(const T &value) { return value; }
+
+template <typename T>
+constexpr std::complex<T> conjugate(const std::complex<T> &value) {
+  return std::complex<T>(value.real(), -value.imag());
+}
+
+/**
+ * @brief the squared magnitude to compare pivots
+ *
+ * @param[in] value the value
+ * @return the squared magnitude
+ */
+template <typename T> constexpr T magnitude(const T &value) {
+  return value * value;
+}
+
+template <typename T> constexpr T magnitude(const std::complex<T> &value) {
+  return value.real() * value.real() + value.imag() * value.imag();
+}
+
+/**
+ * @brief panic for a matrix which has no inverse
+ */
+inline void panic_singular() {
+  log_error("panic: the matrix isn't inversable");
+  std::exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief the matrix without a row and a column
+ */
+template <size_t Row, size_t Col, typename T, size_t N, size_t... I>
+constexpr FixedMatrix<T, N - 1, N - 1>
+get_minor(const FixedMatrix<T, N, N> &matrix, std::index_sequence<I...>) {
+  return {{matrix.data[(I / (N - 1) + (I / (N - 1) >= Row)) * N +
+                       (I % (N - 1) + (I % (N - 1) >= Col))]...}};
+}
+
+template <size_t Row, size_t Col, typename T, size_t N>
+constexpr FixedMatrix<T, N - 1, N - 1>
+get_minor(const FixedMatrix<T, N, N> &matrix) {
+  return get_minor<Row, Col>(matrix,
+                             std::make_index_sequence<(N - 1) * (N - 1)>());
+}
+
+template <typename T, size_t N>
+constexpr T get_determinant(const FixedMatrix<T, N, N> &matrix);
+
+/**
+ * @brief the determinant by the cofactors of the first row
+ */
+template <typename T, size_t N, size_t... J>
+constexpr T get_cofactor_determinant(const FixedMatrix<T, N, N> &matrix,
+                                     std::index_sequence<J...>) {
+  return (((J % 2 == 0 ? T(1) : T(-1)) * matrix.data[J] *
+           get_determinant(get_minor<0, J>(matrix))) +
+          ...);
+}
+
+/**
+ * @brief the determinant by elimination with partial pivoting
+ */
+template <typename T, size_t N>
+constexpr T get_elimination_determinant(FixedMatrix<T, N, N> matrix) {
+  T determinant = T(1);
+  for (size_t col = 0; col < N; ++col) {
+    // find the largest pivot
+    size_t pivot = col;
+    for (size_t row = col + 1; row < N; ++row) {
+      if (magnitude(matrix(row, col)) > magnitude(matrix(pivot, col))) {
+        pivot = row;
+      }
+    }
+    if (matrix(pivot, col) == T(0)) {
+      return T(0);
+    }
+    if (pivot != col) {
+      for (size_t i = 0; i < N; ++i) {
+        T value = matrix(col, i);
+        matrix(col, i) = matrix(pivot, i);
+        matrix(pivot, i) = value;
+      }
+      determinant = -determinant;
+    }
+    determinant = determinant * matrix(col, col);
+    for (size_t row = col + 1; row < N; ++row) {
+      T factor = matrix(row, col) / matrix(col, col);
+      for (size_t i = col; i < N; ++i) {
+        matrix(row, i) = matrix(row, i) - factor * matrix(col, i);
+      }
+    }
+  }
+  return determinant;
+}
+
+template <typename T, size_t N>
+constexpr T get_determinant(const FixedMatrix<T, N, N> &matrix) {
+  if constexpr (N == 1) {
+    return matrix.data[0];
+  } else if constexpr (N == 2) {
+    return matrix.data[0] * matrix.data[3] - matrix.data[1] * matrix.data[2];
+  } else if constexpr (N <= 4) {
+    return get_cofactor_determinant(matrix, std::make_index_sequence<N>());
+  } else {
+    return get_elimination_determinant(matrix);
+  }
+}
+
+/**
+ * @brief the inverse by the adjugate, inv(A)(i, j) is the cofactor (j, i)
+ *        over det(A)
+ */
+template <typename T, size_t N, size_t... I>
+constexpr FixedMatrix<T, N, N>
+get_adjugate_inverse(const FixedMatrix<T, N, N> &matrix, T determinant,
+                     std::index_sequence<I...>) {
+  return {{((I / N + I % N) % 2 == 0 ? T(1) : T(-1)) *
+           get_determinant(get_minor<I % N, I / N>(matrix)) / determinant...}};
+}
+
+/**
+ * @brief the inverse by Gauss-Jordan elimination with partial pivoting
+ */
+template <typename T, size_t N>
+constexpr FixedMatrix<T, N, N>
+get_elimination_inverse(FixedMatrix<T, N, N> matrix) {
+  FixedMatrix<T, N, N> inverse = FixedMatrix<T, N, N>::identity();
+  for (size_t col = 0; col < N; ++col) {
+    // find the largest pivot
+    size_t pivot = col;
+    for (size_t row = col + 1; row < N; ++row) {
+      if (magnitude(matrix(row, col)) > magnitude(matrix(pivot, col))) {
+        pivot = row;
+      }
+    }
+    if (matrix(pivot, col) == T(0)) {
+      panic_singular();
+    }
+    for (size_t i = 0; i < N; ++i) {
+      T value = matrix(col, i);
+      matrix(col, i) = matrix(pivot, i);
+      matrix(pivot, i) = value;
+      value = inverse(col, i);
+      inverse(col, i) = inverse(pivot, i);
+      inverse(pivot, i) = value;
+    }
+    T scale = T(1) / matrix(col, col);
+    for (size_t i = 0; i < N; ++i) {
+      matrix(col, i) = matrix(col, i) * scale;
+      inverse(col, i) = inverse(col, i) * scale;
+    }
+    for (size_t row = 0; row < N; ++row) {
+      if (row == col) {
+        continue;
+      }
+      T factor = matrix(row, col);
+      for (size_t i = 0; i < N; ++i) {
+        matrix(row, i) = matrix(row, i) - factor * matrix(col, i);
+        inverse(row, i) = inverse(row, i) - factor * inverse(col, i);
+      }
+    }
+  }
+  return inverse;
+}
+
+/**
+ * @brief the product of two matrices, the sum of an element is expanded
+ */
+template <size_t Index, typename T, size_t R, size_t K, size_t C, size_t... J>
+constexpr T get_product_element(const FixedMatrix<T, R, K> &lhs,
+                                const FixedMatrix<T, K, C> &rhs,
+                                std::index_sequence<J...>) {
+  return ((lhs.data[Index / C * K + J] * rhs.data[J * C + Index % C]) + ...);
+}
+
+template <typename T, size_t R, size_t K, size_t C, size_t... I>
+constexpr FixedMatrix<T, R, C> get_product(const FixedMatrix<T, R, K> &lhs,
+                                           const FixedMatrix<T, K, C> &rhs,
+                                           std::index_sequence<I...>) {
+  return {{get_product_element<I>(lhs, rhs, std::make_index_sequence<K>())...}};
+}
+
+/**
+ * @brief apply a function to the elements of two matrices
+ */
+template <typename T, size_t R, size_t C, typename Function, size_t... I>
+constexpr FixedMatrix<T, R, C> map(const FixedMatrix<T, R, C> &lhs,
+                                   const FixedMatrix<T, R, C> &rhs,
+                                   Function function,
+                                   std::index_sequence<I...>) {
+  return {{function(lhs.data[I], rhs.data[I])...}};
+}
+
+/**
+ * @brief apply a function to the elements of a matrix
+ */
+template <typename T, size_t R, size_t C, typename Function, size_t... I>
+constexpr FixedMatrix<T, R, C> map(const FixedMatrix<T, R, C> &matrix,
+                                   Function function,
+                                   std::index_sequence<I...>) {
+  return {{function(matrix.data[I])...}};
+}
+
+} // namespace detail
+
+// functions: attribute
+
+template <typename T, size_t R, size_t C>
+template <size_t... I>
+constexpr FixedMatrix<T, C, R>
+FixedMatrix<T, R, C>::adjoint(std::index_sequence<I...>) const {
+  return {{detail::conjugate(data[I % R * C + I / R])...}};
+}
+
+template <typename T, size_t R, size_t C>
+constexpr T FixedMatrix<T, R, C>::determinant() const {
+  static_assert(R == C, "matrix must be squared");
+  return detail::get_determinant(*this);
+}
+
+template <typename T, size_t R, size_t C>
+constexpr FixedMatrix<T, R, C> FixedMatrix<T, R, C>::inverse() const {
+  static_assert(R == C, "matrix must be squared");
+  if constexpr (R == 1) {
+    if (data[0] == T(0)) {
+      detail::panic_singular();
+    }
+    return {{T(1) / data[0]}};
+  } else if constexpr (R <= 4) {
+    T determinant = detail::get_determinant(*this);
+    if (determinant == T(0)) {
+      detail::panic_singular();
+    }
+    return detail::get_adjugate_inverse(*this, determinant,
+                                        std::make_index_sequence<R * C>());
+  } else {
+    return detail::get_elimination_inverse(*this);
+  }
+}
+
+// functions: operators
+
+template <typename T, size_t R, size_t C>
+constexpr FixedMatrix<T, R, C> operator+(const FixedMatrix<T, R, C> &lhs,
+                                         const FixedMatrix<T, R, C> &rhs) {
+  return detail::map(
+      lhs, rhs, [](const T &l, const T &r) { return l + r; },
+      std::make_index_sequence<R * C>());
+}
+
+template <typename T, size_t R, size_t C>
+constexpr FixedMatrix<T, R, C> operator-(const FixedMatrix<T, R, C> &lhs,
+                                         const FixedMatrix<T, R, C> &rhs) {
+  return detail::map(
+      lhs, rhs, [](const T &l, const T &r) { return l - r; },
+      std::make_index_sequence<R * C>());
+}
+
+template <typename T, size_t R, size_t C>
+constexpr FixedMatrix<T, R, C> operator-(const FixedMatrix<T, R, C> &matrix) {
+  return detail::map(
+      matrix, [](const T &value) { return -value; },
+      std::make_index_sequence<R * C>());
+}
+
+template <typename T, size_t R, size_t C>
+constexpr FixedMatrix<T, R, C> operator*(const T &scalar,
+                                         const FixedMatrix<T, R, C> &matrix) {
+  return detail::map(
+      matrix, [scalar](const T &value) { return scalar * value; },
+      std::make_index_sequence<R * C>());
+}
+
+template <typename T, size_t R, size_t C>
+constexpr FixedMatrix<T, R, C> operator*(const FixedMatrix<T, R, C> &matrix,
+                                         const T &scalar) {
+  return scalar * matrix;
+}
+
+template <typename T, size_t R, size_t K, size_t C>
+constexpr FixedMatrix<T, R, C> operator*(const FixedMatrix<T, R, K> &lhs,
+                                         const FixedMatrix<T, K, C> &rhs) {
+  return detail::get_product(lhs, rhs, std::make_index_sequence<R * C>());
+}
+
+template <typename T, size_t R, size_t C>
+constexpr bool operator==(const FixedMatrix<T, R, C> &lhs,
+                          const FixedMatrix<T, R, C> &rhs) {
+  for (size_t i = 0; i < R * C; ++i) {
+    if (!(lhs.data[i] == rhs.data[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename T, size_t R, size_t C>
+constexpr bool operator!=(const FixedMatrix<T, R, C> &lhs,
+                          const FixedMatrix<T, R, C> &rhs) {
+  return !(lhs == rhs);
+}
+
+// functions: vectors
+
+/**
+ * @brief the inner product of two vectors without conjugation like
+ *        vector_inner_product()
+ *
+ * @param[in] lhv the left vector
+ * @param[in] rhv the right vector
+ * @return the inner product
+ */
+template <typename T, size_t R, size_t C>
+constexpr T inner_product(const FixedMatrix<T, R, C> &lhv,
+                          const FixedMatrix<T, R, C> &rhv) {
+  static_assert(R == 1 || C == 1, "operands must be vectors");
+  T sum = T(0);
+  for (size_t i = 0; i < R * C; ++i) {
+    sum = sum + lhv.data[i] * rhv.data[i];
+  }
+  return sum;
+}
+
+/**
+ * @brief the cross product of two 3-vectors like vector_cross_product_3d()
+ *
+ * @param[in] lhv the left vector
+ * @param[in] rhv the right vector
+ * @return the cross product with the shape of the operands
+ */
+template <typename T, size_t R, size_t C>
+constexpr FixedMatrix<T, R, C> cross_product(const FixedMatrix<T, R, C> &lhv,
+                                             const FixedMatrix<T, R, C> &rhv) {
+  static_assert(R * C == 3 && (R == 1 || C == 1), "operands must be 3-vectors");
+  return {{lhv.data[1] * rhv.data[2] - lhv.data[2] * rhv.data[1],
+           lhv.data[2] * rhv.data[0] - lhv.data[0] * rhv.data[2],
+           lhv.data[0] * rhv.data[1] - lhv.data[1] * rhv.data[0]}};
+}
+
+// types: aliases
+
+template <typename T> using FixedVector3 = FixedMatrix<T, 3, 1>;
+template <typename T> using FixedMatrix3 = FixedMatrix<T, 3, 3>;
+template <typename T> using FixedMatrix4 = FixedMatrix<T, 4, 4>;
+
+} // namespace cmatrix
+
+#endif
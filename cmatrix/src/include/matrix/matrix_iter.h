@@ -0,0 +1,130 @@
+/**
+ * @file matrix/matrix_iter.h
+ * @brief iterative solvers of matrix library
+ *
+ * the solvers only need the product y = A x, so a system can be given as an
+ * operator callback without forming its matrix, vectors are plain arrays of
+ * complex float with the size of the operator
+ */
+
+#pragma once
+#ifndef __MATRIX_MATRIX_ITER_H__
+#define __MATRIX_MATRIX_ITER_H__
+
+// include
+
+#include "matrix/matrix.h"
+#ifndef __cplusplus
+#include <complex.h>
+#endif
+#include <stdbool.h>
+#include <stddef.h>
+
+// types
+
+/**
+ * @brief the callback of an operator, y = A x
+ *
+ * @param[in] x the vector to apply on
+ * @param[out] y the result, it never overlaps \p x
+ * @param[in] context the context of the operator
+ */
+typedef void (*MatrixApplyFunc)(const complex float *x, complex float *y,
+                                void *context);
+
+/**
+ * @brief a square linear operator given by its product
+ */
+typedef struct MatrixOperatorT {
+  size_t size;           ///< the row (and column) size of the operator
+  MatrixApplyFunc apply; ///< the product y = A x
+  void *context;         ///< the context passed to \p apply
+} MatrixOperatorT;
+
+/**
+ * @brief the options of an iterative solver
+ */
+typedef struct IterativeOptionT {
+  size_t max_iter; ///< the maximum number of products with the operator
+  float tolerance; ///< stop when |b - A x| <= tolerance |b|
+  size_t restart;  ///< the size of the Krylov space of GMRES
+  /// the preconditioner M^-1 applied to residuals, NULL for none
+  const MatrixOperatorT *preconditioner;
+} IterativeOptionT;
+
+/**
+ * @brief the statistics of an iterative solver
+ */
+typedef struct IterativeStatT {
+  size_t iteration; ///< the number of iterations done
+  float residual;   ///< the final relative residual |b - A x| / |b|
+  bool converged;   ///< whether the tolerance is reached
+} IterativeStatT;
+
+// functions: operator
+
+/**
+ * @brief get an operator backed by a square matrix
+ *
+ * @param[in] matrix the matrix to use, it must outlive the operator
+ * @return the operator with y = \p matrix x
+ */
+extern MatrixOperatorT new_matrix_operator(const MatrixT *matrix);
+
+/**
+ * @brief get the default options, 1000 iterations, tolerance 1e-5,
+ *        restart 30 and no preconditioner
+ *
+ * @return the default options
+ */
+extern IterativeOptionT new_iterative_option(void);
+
+// functions: solver
+
+/**
+ * @brief solve a Hermitian positive-definite system by the (preconditioned)
+ *        conjugate gradient method
+ *
+ * @param[in] linear_operator the operator A
+ * @param[in] rhs the right hand side b
+ * @param[in,out] solution the initial guess, overwritten by the solution
+ * @param[in] option the options, the preconditioner must be Hermitian
+ *            positive-definite, NULL for the default
+ * @return the statistics of the solver
+ */
+extern IterativeStatT
+solve_iterative_cg(const MatrixOperatorT *linear_operator,
+                   const complex float *rhs, complex float *solution,
+                   const IterativeOptionT *option);
+
+/**
+ * @brief solve a general system by the restarted GMRES method with right
+ *        preconditioning
+ *
+ * @param[in] linear_operator the operator A
+ * @param[in] rhs the right hand side b
+ * @param[in,out] solution the initial guess, overwritten by the solution
+ * @param[in] option the options, NULL for the default
+ * @return the statistics of the solver
+ */
+extern IterativeStatT
+solve_iterative_gmres(const MatrixOperatorT *linear_operator,
+                      const complex float *rhs, complex float *solution,
+                      const IterativeOptionT *option);
+
+/**
+ * @brief solve a general system by the BiCGSTAB method with right
+ *        preconditioning
+ *
+ * @param[in] linear_operator the operator A
+ * @param[in] rhs the right hand side b
+ * @param[in,out] solution the initial guess, overwritten by the solution
+ * @param[in] option the options, NULL for the default
+ * @return the statistics of the solver
+ */
+extern IterativeStatT
+solve_iterative_bicgstab(const MatrixOperatorT *linear_operator,
+                         const complex float *rhs, complex float *solution,
+                         const IterativeOptionT *option);
+
+#endif
@@ -0,0 +1,95 @@
+/**
+ * @file matrix/matrix_kron.h
+ * @brief Kronecker product operator header file of matrix library
+ *
+ * a Kronecker matrix A1 x A2 x ... x Ad keeps its factors instead of its
+ * values, a product with a vector is done factor by factor on the vector
+ * reshaped as a tensor, so its size is not limited like MatrixT
+ */
+
+#pragma once
+#ifndef __MATRIX_MATRIX_KRON_H__
+#define __MATRIX_MATRIX_KRON_H__
+
+// include
+
+#include "matrix/matrix.h"
+#include "matrix/matrix_iter.h"
+#ifndef __cplusplus
+#include <complex.h>
+#endif
+#include <stddef.h>
+
+// types
+
+/**
+ * @brief Kronecker product of matrices
+ */
+typedef struct KroneckerMatrixT {
+  size_t size[2];       ///< the row and column size of the product
+  size_t factor_number; ///< the number of factors
+  MatrixT **factors;    ///< the copied factors, from left to right
+} KroneckerMatrixT;
+
+// functions: init
+
+/**
+ * @brief construct a Kronecker product of matrices without forming it
+ *
+ * @param[in] factors the factors from left to right, they are copied
+ * @param[in] factor_number the number of factors
+ * @return the Kronecker matrix
+ */
+extern KroneckerMatrixT *new_kronecker_matrix(MatrixT **factors,
+                                              size_t factor_number);
+
+/**
+ * @brief construct the matrix of a Kronecker product
+ *
+ * @param[in] kronecker_matrix the Kronecker matrix to use, its size can not
+ *            be over 255
+ * @return the matrix with the same values
+ */
+extern MatrixT *
+new_matrix_from_kronecker_matrix(const KroneckerMatrixT *kronecker_matrix);
+
+/**
+ * @brief drop a Kronecker matrix
+ *
+ * @param[in] kronecker_matrix the Kronecker matrix to drop
+ */
+extern void drop_kronecker_matrix(KroneckerMatrixT *kronecker_matrix);
+
+// functions: manipulate
+
+/**
+ * @brief multiplication of a Kronecker matrix and a vector
+ *        y = alpha op(K) x + beta y
+ *
+ * the cost of (A x B) x is O(mnq + mpq) for A (m, n) and B (p, q) instead
+ * of O(mnpq), and the factors are applied in the cheapest order
+ *
+ * @param[in] operation the operation applied to the Kronecker matrix
+ * @param[in] kronecker_matrix the Kronecker matrix K
+ * @param[in] alpha the scalar of the product
+ * @param[in] vector the vector x with the column size of op(K)
+ * @param[in] beta the scalar of \p result , it is not read if zero
+ * @param[in,out] result the vector y with the row size of op(K)
+ */
+extern void mul_kronecker_matrix_vector(
+    MatrixOperation operation, const KroneckerMatrixT *kronecker_matrix,
+    complex float alpha, const complex float *vector, complex float beta,
+    complex float *result);
+
+/**
+ * @brief get an operator backed by a square Kronecker matrix, for the
+ *        iterative solvers
+ *
+ * @param[in] kronecker_matrix the Kronecker matrix to use, it must outlive
+ *            the operator
+ * @return the operator with y = \p kronecker_matrix x
+ */
+extern MatrixOperatorT
+new_kronecker_matrix_operator(const KroneckerMatrixT *kronecker_matrix);
+
+#endif
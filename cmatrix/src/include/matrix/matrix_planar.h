@@ -0,0 +1,170 @@
+/**
+ * @file matrix/matrix_planar.h
+ * @brief planar matrix header file of matrix library
+ *
+ * a planar matrix stores the real and imaginary parts of its values in two
+ * separate row-major arrays, so the real part can be read without touching
+ * the imaginary one and the loops over it work on plain floats
+ */
+
+#pragma once
+#ifndef __MATRIX_MATRIX_PLANAR_H__
+#define __MATRIX_MATRIX_PLANAR_H__
+
+// include
+
+#include "matrix/matrix.h"
+#ifndef __cplusplus
+#include <complex.h>
+#endif
+#include <stdint.h>
+
+// types
+
+/**
+ * @brief planar matrix, \p real and \p imag can point to any two arrays of
+ *        size[0] * size[1] floats, new_planar_matrix() puts \p imag after
+ *        \p real in the same allocation which drop_planar_matrix() frees
+ */
+typedef struct PlanarMatrixT {
+  uint8_t size[2]; ///< size of matrix
+  float *real;     ///< the real parts, row by row
+  float *imag;     ///< the imaginary parts, row by row
+} PlanarMatrixT;
+
+// functions: init
+
+/**
+ * @brief construct a zero planar matrix
+ *
+ * @param[in] row the row size of matrix
+ * @param[in] col the column size of matrix
+ * @return the planar matrix with size ( \p row, \p col )
+ */
+extern PlanarMatrixT *new_planar_matrix(uint8_t row, uint8_t col);
+
+/**
+ * @brief construct a planar matrix from a matrix
+ *
+ * @param[in] matrix the matrix to split
+ * @return the planar matrix with the same values
+ */
+extern PlanarMatrixT *new_planar_matrix_from_matrix(const MatrixT *matrix);
+
+/**
+ * @brief construct a matrix from a planar matrix
+ *
+ * @param[in] planar_matrix the planar matrix to merge
+ * @return the matrix with the same values
+ */
+extern MatrixT *new_matrix_from_planar_matrix(
+    const PlanarMatrixT *planar_matrix);
+
+/**
+ * @brief split a matrix into a planar matrix of the same size without any
+ *        allocation
+ *
+ * @param[in] matrix the matrix to split
+ * @param[out] planar_matrix the planar matrix to overwrite
+ */
+extern void load_planar_matrix(const MatrixT *matrix,
+                               PlanarMatrixT *planar_matrix);
+
+/**
+ * @brief merge a planar matrix into a matrix of the same size without any
+ *        allocation
+ *
+ * @param[in] planar_matrix the planar matrix to merge
+ * @param[out] matrix the matrix to overwrite
+ */
+extern void store_planar_matrix(const PlanarMatrixT *planar_matrix,
+                                MatrixT *matrix);
+
+/**
+ * @brief copy a planar matrix
+ *
+ * @param[in] planar_matrix the planar matrix to copy
+ * @return the copied planar matrix
+ */
+extern PlanarMatrixT *copy_planar_matrix(const PlanarMatrixT *planar_matrix);
+
+/**
+ * @brief drop a planar matrix
+ *
+ * @param[in] planar_matrix the planar matrix to drop, which is constructed
+ *            by this library and not over the arrays of the caller
+ */
+extern void drop_planar_matrix(PlanarMatrixT *planar_matrix);
+
+// functions: attribute
+
+/**
+ * @brief get the trace of a planar matrix
+ *
+ * @param[in] planar_matrix the square planar matrix
+ * @return the trace
+ */
+extern complex float
+get_planar_matrix_trace(const PlanarMatrixT *planar_matrix);
+
+/**
+ * @brief get the sum of all values of a planar matrix
+ *
+ * @param[in] planar_matrix the planar matrix
+ * @return the sum
+ */
+extern complex float get_planar_matrix_sum(const PlanarMatrixT *planar_matrix);
+
+/**
+ * @brief get the Frobenius norm sqrt(sum(|A|^2)) of a planar matrix
+ *
+ * @param[in] planar_matrix the planar matrix
+ * @return the norm
+ */
+extern float get_planar_matrix_frobenius_norm(
+    const PlanarMatrixT *planar_matrix);
+
+// functions: manipulate
+
+/**
+ * @brief scalar multiplication of a planar matrix
+ *
+ * @param[in] scalar the scalar
+ * @param[in] planar_matrix the planar matrix
+ * @return the scaled planar matrix
+ */
+extern PlanarMatrixT *
+scalar_mul_planar_matrix(complex float scalar,
+                         const PlanarMatrixT *planar_matrix);
+
+/**
+ * @brief addition of two planar matrices
+ *
+ * @param[in] lhs the left hand side planar matrix
+ * @param[in] rhs the right hand side planar matrix
+ * @return the sum
+ */
+extern PlanarMatrixT *add_planar_matrix(const PlanarMatrixT *lhs,
+                                        const PlanarMatrixT *rhs);
+
+/**
+ * @brief element-wise multiplication of two planar matrices
+ *
+ * @param[in] lhs the left hand side planar matrix
+ * @param[in] rhs the right hand side planar matrix
+ * @return the element-wise product
+ */
+extern PlanarMatrixT *hadamard_planar_matrix(const PlanarMatrixT *lhs,
+                                             const PlanarMatrixT *rhs);
+
+/**
+ * @brief multiplication of two planar matrices by four real products
+ *
+ * @param[in] lhs the left hand side planar matrix
+ * @param[in] rhs the right hand side planar matrix
+ * @return the product
+ */
+extern PlanarMatrixT *mul_planar_matrix(const PlanarMatrixT *lhs,
+                                        const PlanarMatrixT *rhs);
+
+#endif
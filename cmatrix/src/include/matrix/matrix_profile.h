@@ -0,0 +1,88 @@
+/**
+ * @file matrix/matrix_profile.h
+ * @brief profiling header file of matrix library
+ *
+ * the public functions of matrix/matrix.h and matrix/matrix_ext.h record
+ * their calls, time, allocated bytes and flops while profiling is started,
+ * the numbers of a call include the functions it calls, every thread
+ * records into its own buffer and the buffers are merged when read
+ *
+ * the records are only compiled in with the profile option of meson, the
+ * functions here still exist without it but find nothing to report
+ */
+
+#pragma once
+#ifndef __MATRIX_MATRIX_PROFILE_H__
+#define __MATRIX_MATRIX_PROFILE_H__
+
+// include
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// types
+
+/**
+ * @brief the merged record of a function
+ */
+typedef struct ProfileRecordT {
+  const char *name;  ///< the name of the function
+  uint64_t calls;    ///< the number of calls
+  uint64_t total_ns; ///< the cumulative time of the calls
+  uint64_t max_ns;   ///< the time of the longest call
+  uint64_t byte;     ///< the bytes allocated by the calls
+  uint64_t flop;     ///< the real floating-point operations of the kernels
+} ProfileRecordT;
+
+// functions: control
+
+/**
+ * @brief check whether the records are compiled in
+ *
+ * @return true if the library is built with the profile option
+ */
+extern bool is_matrix_profile_available(void);
+
+/**
+ * @brief start recording the calls of all threads
+ *
+ * @param[in] trace also keep every call for save_matrix_profile_trace
+ */
+extern void start_matrix_profile(bool trace);
+
+/**
+ * @brief stop recording, the records are kept
+ */
+extern void stop_matrix_profile(void);
+
+/**
+ * @brief clear the records and the trace
+ */
+extern void reset_matrix_profile(void);
+
+// functions: report
+
+/**
+ * @brief get the records merged across threads, sorted by cumulative time
+ *
+ * @param[out] record_number the number of records
+ * @return the records allocated by malloc() and not counted, freed by
+ *         free(), or NULL if there is none
+ */
+extern ProfileRecordT *get_matrix_profile(size_t *record_number);
+
+/**
+ * @brief print the records as a table
+ */
+extern void show_matrix_profile(void);
+
+/**
+ * @brief save the recorded calls as a Chrome trace, it can be opened by
+ *        chrome://tracing or Perfetto
+ *
+ * @param[in] file_path the path of the JSON file
+ */
+extern void save_matrix_profile_trace(const char *file_path);
+
+#endif
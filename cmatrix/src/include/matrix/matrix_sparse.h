@@ -0,0 +1,199 @@
+/**
+ * @file matrix/matrix_sparse.h
+ * @brief sparse matrix header file of matrix library
+ *
+ * only the nonzeros of a sparse matrix are stored, so its size is not
+ * limited like MatrixT, vectors of products are plain arrays of complex
+ * float
+ */
+
+#pragma once
+#ifndef __MATRIX_MATRIX_SPARSE_H__
+#define __MATRIX_MATRIX_SPARSE_H__
+
+// include
+
+#include "matrix/matrix.h"
+#include "matrix/matrix_iter.h"
+#ifndef __cplusplus
+#include <complex.h>
+#endif
+#include <stddef.h>
+
+// types
+
+/**
+ * @brief the storage format of a sparse matrix
+ */
+typedef enum SparseFormat {
+  COO = 0, ///< coordinate list, the format to assemble a matrix
+  CSR = 1, ///< compressed sparse row
+  CSC = 2, ///< compressed sparse column
+} SparseFormat;
+
+/**
+ * @brief sparse matrix, indexes are stored from 0
+ *
+ * COO uses \p row_index and \p col_index , CSR uses \p offset (row size + 1)
+ * and \p col_index , CSC uses \p offset (column size + 1) and \p row_index ,
+ * the unused array is NULL
+ */
+typedef struct SparseMatrixT {
+  SparseFormat format; ///< the storage format
+  size_t size[2];      ///< the row and column size
+  size_t nnz;          ///< the number of stored values
+  size_t capacity;     ///< the capacity of the value arrays
+  size_t *offset;      ///< the offsets of rows (CSR) or columns (CSC)
+  size_t *row_index;   ///< the row index of every value
+  size_t *col_index;   ///< the column index of every value
+  complex float *data; ///< the stored values
+} SparseMatrixT;
+
+// functions: init
+
+/**
+ * @brief construct an empty sparse matrix in COO format
+ *
+ * @param[in] row the row size of matrix
+ * @param[in] col the column size of matrix
+ * @param[in] capacity the number of values to reserve
+ * @return the sparse matrix with size ( \p row, \p col ) and no value
+ */
+extern SparseMatrixT *new_sparse_matrix(size_t row, size_t col,
+                                        size_t capacity);
+
+/**
+ * @brief construct a sparse matrix from the nonzeros of a matrix
+ *
+ * @param[in] matrix the matrix to use
+ * @param[in] format the format of the sparse matrix
+ * @return the sparse matrix
+ */
+extern SparseMatrixT *new_sparse_matrix_from_matrix(const MatrixT *matrix,
+                                                    SparseFormat format);
+
+/**
+ * @brief construct a matrix from a sparse matrix
+ *
+ * @param[in] sparse_matrix the sparse matrix to use, its size can not be
+ *            over 255
+ * @return the matrix with the same values
+ */
+extern MatrixT *new_matrix_from_sparse_matrix(
+    const SparseMatrixT *sparse_matrix);
+
+/**
+ * @brief construct sparse matrices from a file, a sparse matrix is stored as
+ *        "[sparse]", "size = row col", "nnz = count" and
+ *        "data = row col value ..." lines with indexes from 1
+ *
+ * @param[in] file_path the path of the file
+ * @param[out] matrix_number the number of matrices in the file
+ * @return the sparse matrices in CSR format
+ */
+extern SparseMatrixT **new_sparse_matrix_from_file(const char *file_path,
+                                                   size_t *matrix_number);
+
+/**
+ * @brief save sparse matrices to a file
+ *
+ * @param[in] file_path the path of the file
+ * @param[in] matrices the sparse matrices to save
+ * @param[in] matrix_number the number of matrices
+ */
+extern void save_sparse_matrix_to_file(const char *file_path,
+                                       SparseMatrixT **matrices,
+                                       size_t matrix_number);
+
+/**
+ * @brief convert a sparse matrix to another format, duplicate entries of
+ *        COO are summed, and the indexes of a row (CSR) or a column (CSC)
+ *        are sorted
+ *
+ * @param[in] sparse_matrix the sparse matrix to convert
+ * @param[in] format the format to convert to
+ * @return the converted sparse matrix
+ */
+extern SparseMatrixT *convert_sparse_matrix(const SparseMatrixT *sparse_matrix,
+                                            SparseFormat format);
+
+/**
+ * @brief copy a sparse matrix
+ *
+ * @param[in] sparse_matrix the sparse matrix to copy
+ * @return the copied sparse matrix
+ */
+extern SparseMatrixT *copy_sparse_matrix(const SparseMatrixT *sparse_matrix);
+
+/**
+ * @brief drop a sparse matrix
+ *
+ * @param[in] sparse_matrix the sparse matrix to drop
+ */
+extern void drop_sparse_matrix(SparseMatrixT *sparse_matrix);
+
+/**
+ * @brief drop sparse matrices
+ *
+ * @param[in] matrices the sparse matrices to drop
+ * @param[in] matrices_number the number of matrices
+ */
+extern void drop_sparse_matrices(SparseMatrixT **matrices,
+                                 size_t matrices_number);
+
+// functions: manipulate
+
+/**
+ * @brief add a value to a sparse matrix in COO format, a value at the same
+ *        position is summed when the matrix is converted
+ *
+ * @param[in,out] sparse_matrix the sparse matrix to assemble
+ * @param[in] row the row index (from 1)
+ * @param[in] col the column index (from 1)
+ * @param[in] value the value to add
+ */
+extern void add_sparse_matrix_val(SparseMatrixT *sparse_matrix, size_t row,
+                                  size_t col, complex float value);
+
+/**
+ * @brief multiplication of a sparse matrix and a vector
+ *        y = alpha op(A) x + beta y
+ *
+ * @param[in] operation the operation applied to the sparse matrix
+ * @param[in] sparse_matrix the sparse matrix A
+ * @param[in] alpha the scalar of the product
+ * @param[in] vector the vector x with the column size of op(A)
+ * @param[in] beta the scalar of \p result , it is not read if zero
+ * @param[in,out] result the vector y with the row size of op(A)
+ */
+extern void mul_sparse_matrix_vector(MatrixOperation operation,
+                                     const SparseMatrixT *sparse_matrix,
+                                     complex float alpha,
+                                     const complex float *vector,
+                                     complex float beta,
+                                     complex float *result);
+
+/**
+ * @brief multiplication of a sparse matrix and a matrix
+ *
+ * @param[in] operation the operation applied to the sparse matrix
+ * @param[in] sparse_matrix the left hand side sparse matrix
+ * @param[in] matrix the right hand side matrix
+ * @return op( \p sparse_matrix ) \p matrix
+ */
+extern MatrixT *mul_sparse_matrix(MatrixOperation operation,
+                                  const SparseMatrixT *sparse_matrix,
+                                  const MatrixT *matrix);
+
+/**
+ * @brief get an operator backed by a square sparse matrix, for the
+ *        iterative solvers
+ *
+ * @param[in] sparse_matrix the sparse matrix to use, it must outlive the
+ *            operator
+ * @return the operator with y = \p sparse_matrix x
+ */
+extern MatrixOperatorT
+new_sparse_matrix_operator(const SparseMatrixT *sparse_matrix);
+
+#endif
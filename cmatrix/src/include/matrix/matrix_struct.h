@@ -0,0 +1,176 @@
+/**
+ * @file matrix/matrix_struct.h
+ * @brief structured matrix header file of matrix library
+ *
+ * a structured matrix only stores the values which its structure allows,
+ * every row keeps them in one contiguous segment
+ */
+
+#pragma once
+#ifndef __MATRIX_MATRIX_STRUCT_H__
+#define __MATRIX_MATRIX_STRUCT_H__
+
+// include
+
+#include "matrix/matrix.h"
+#include "matrix/matrix_ext.h"
+#ifndef __cplusplus
+#include <complex.h>
+#endif
+#include <stdint.h>
+
+// types
+
+/**
+ * @brief the structure of a structured matrix
+ */
+typedef enum MatrixStructure {
+  DIAGONAL = 0,   ///< only the main diagonal, min(row, col) values
+  TRIANGULAR = 1, ///< a packed triangle of a square matrix
+  BANDED = 2,     ///< the diagonals from -lower to +upper
+  HERMITIAN = 3,  ///< a packed triangle, the other one is its conjugate
+} MatrixStructure;
+
+/**
+ * @brief structured matrix
+ *
+ * a TRIANGULAR or HERMITIAN matrix stores n (n + 1) / 2 values row by row,
+ * a BANDED matrix stores lower + upper + 1 values for every row with A(i, j)
+ * at i (lower + upper + 1) + j - i + lower
+ */
+typedef struct StructuredMatrixT {
+  MatrixStructure structure; ///< the structure of matrix
+  uint8_t size[2];           ///< size of matrix
+  MatrixTriangle triangle;   ///< the stored triangle of TRIANGULAR, HERMITIAN
+  uint8_t band[2];           ///< the lower and upper bandwidth of BANDED
+  complex float *data;       ///< the stored values
+} StructuredMatrixT;
+
+// functions: init
+
+/**
+ * @brief construct an identity matrix stored as DIAGONAL
+ *
+ * @param[in] row the row size of matrix
+ * @param[in] col the column size of matrix
+ * @return the identity matrix with size ( \p row, \p col )
+ */
+extern StructuredMatrixT *new_diagonal_identity_matrix(uint8_t row,
+                                                       uint8_t col);
+
+/**
+ * @brief construct a DIAGONAL matrix from the diagonal of a matrix
+ *
+ * @param[in] matrix the matrix to use
+ * @return the diagonal matrix with the size of \p matrix
+ */
+extern StructuredMatrixT *new_diagonal_matrix_from_matrix(
+    const MatrixT *matrix);
+
+/**
+ * @brief construct a TRIANGULAR matrix from a triangle of a square matrix
+ *
+ * @param[in] matrix the matrix to use
+ * @param[in] triangle the triangle to keep
+ * @return the triangular matrix
+ */
+extern StructuredMatrixT *
+new_triangular_matrix_from_matrix(const MatrixT *matrix,
+                                  MatrixTriangle triangle);
+
+/**
+ * @brief construct a BANDED matrix from the band of a matrix
+ *
+ * @param[in] matrix the matrix to use
+ * @param[in] lower the number of diagonals under the main diagonal
+ * @param[in] upper the number of diagonals above the main diagonal
+ * @return the banded matrix with the size of \p matrix
+ */
+extern StructuredMatrixT *new_banded_matrix_from_matrix(const MatrixT *matrix,
+                                                        uint8_t lower,
+                                                        uint8_t upper);
+
+/**
+ * @brief construct a HERMITIAN matrix from a triangle of a square matrix,
+ *        the other triangle is not read
+ *
+ * @param[in] matrix the matrix to use
+ * @param[in] triangle the triangle to keep
+ * @return the Hermitian matrix
+ */
+extern StructuredMatrixT *
+new_hermitian_matrix_from_matrix(const MatrixT *matrix,
+                                 MatrixTriangle triangle);
+
+/**
+ * @brief construct a matrix from a structured matrix
+ *
+ * @param[in] structured_matrix the structured matrix to use
+ * @return the matrix with the same values
+ */
+extern MatrixT *
+new_matrix_from_structured_matrix(const StructuredMatrixT *structured_matrix);
+
+/**
+ * @brief drop a structured matrix
+ *
+ * @param[in] structured_matrix the structured matrix to drop
+ */
+extern void drop_structured_matrix(StructuredMatrixT *structured_matrix);
+
+// functions: attribute
+
+/**
+ * @brief get a value of a structured matrix
+ *
+ * @param[in] structured_matrix the structured matrix to use
+ * @param[in] row the row index (from 1)
+ * @param[in] col the column index (from 1)
+ * @return the value, zero outside the structure
+ */
+extern complex float
+get_structured_matrix_val(const StructuredMatrixT *structured_matrix,
+                          uint8_t row, uint8_t col);
+
+// functions: manipulate
+
+/**
+ * @brief add two structured matrices with the same structure, banded
+ *        matrices may have different bandwidths
+ *
+ * @param[in] lhs the left hand side structured matrix
+ * @param[in] rhs the right hand side structured matrix
+ * @return the sum with the same structure
+ */
+extern StructuredMatrixT *add_structured_matrix(const StructuredMatrixT *lhs,
+                                                const StructuredMatrixT *rhs);
+
+/**
+ * @brief multiplication of a structured matrix and a matrix, only the
+ *        stored values are visited
+ *
+ * @param[in] side LEFT for S M, RIGHT for M S
+ * @param[in] structured_matrix the structured matrix S
+ * @param[in] matrix the matrix M
+ * @return the product
+ */
+extern MatrixT *
+mul_structured_matrix(MatrixSide side,
+                      const StructuredMatrixT *structured_matrix,
+                      const MatrixT *matrix);
+
+/**
+ * @brief solve a square structured system S X = B
+ *
+ * a BANDED system is solved by banded LU with partial pivoting, and a
+ * HERMITIAN system by packed Cholesky, so it has to be positive definite
+ *
+ * @param[in] structured_matrix the structured matrix S
+ * @param[in] rhs the right hand sides B
+ * @return the solution X
+ */
+extern MatrixT *
+solve_structured_matrix(const StructuredMatrixT *structured_matrix,
+                        const MatrixT *rhs);
+
+#endif
@@ -0,0 +1,207 @@
+/**
+ * @file matrix/matrix_tune.h
+ * @brief tuning header file of matrix library
+ *
+ * the products C = A B above a cutoff size are split by the Winograd variant
+ * of Strassen, which does 7 block products instead of 8 per level at the
+ * cost of a weaker error bound, it can be turned off for the results of the
+ * classical product
+ *
+ * the products above another cutoff can take the 3M method of Gauss, which
+ * does three real products instead of four at the cost of the accuracy of
+ * the imaginary part
+ *
+ * the options and the block sizes of the kernels can be saved to a config
+ * file of "#define NAME VALUE" lines, the library loads the file named by
+ * the CMATRIX_TUNE environment variable before its first product, and the
+ * same file can be compiled in as the defaults with the "tune" option of
+ * meson, autotune_matrix writes such a file for the local machine
+ */
+
+#pragma once
+#ifndef __MATRIX_MATRIX_TUNE_H__
+#define __MATRIX_MATRIX_TUNE_H__
+
+// include
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// constants
+
+#ifndef MATRIX_GEMM_BLOCK_K
+/**
+ * \def MATRIX_GEMM_BLOCK_K
+ *
+ * the default depth of a panel of multiplication
+ */
+#define MATRIX_GEMM_BLOCK_K 64
+#endif
+
+#ifndef MATRIX_GEMM_BLOCK_N
+/**
+ * \def MATRIX_GEMM_BLOCK_N
+ *
+ * the default width of a panel of multiplication, a panel of op(B) takes
+ * 64 KiB with the default depth
+ */
+#define MATRIX_GEMM_BLOCK_N 128
+#endif
+
+#ifndef MATRIX_TRANSPOSE_LEAF
+/**
+ * \def MATRIX_TRANSPOSE_LEAF
+ *
+ * the default size at which the recursion of transposition stops, it is
+ * rounded down to a multiple of 8
+ */
+#define MATRIX_TRANSPOSE_LEAF 8
+#endif
+
+#ifndef MATRIX_STRASSEN_ENABLE
+/**
+ * \def MATRIX_STRASSEN_ENABLE
+ *
+ * whether Strassen-Winograd is used by default
+ */
+#define MATRIX_STRASSEN_ENABLE 1
+#endif
+
+#ifndef MATRIX_STRASSEN_CUTOFF
+/**
+ * \def MATRIX_STRASSEN_CUTOFF
+ *
+ * the default cutoff of Strassen-Winograd, a product is split while all its
+ * sizes are above it
+ */
+#define MATRIX_STRASSEN_CUTOFF 48
+#endif
+
+#ifndef MATRIX_GEMM_3M_ENABLE
+/**
+ * \def MATRIX_GEMM_3M_ENABLE
+ *
+ * whether the 3M method is used by default
+ */
+#define MATRIX_GEMM_3M_ENABLE 0
+#endif
+
+#ifndef MATRIX_GEMM_3M_CUTOFF
+/**
+ * \def MATRIX_GEMM_3M_CUTOFF
+ *
+ * the default cutoff of the 3M method, a product takes it when all its sizes
+ * are above it
+ */
+#define MATRIX_GEMM_3M_CUTOFF 16
+#endif
+
+// types
+
+/**
+ * @brief the options of Strassen-Winograd
+ */
+typedef struct MatrixStrassenT {
+  bool enable;   ///< whether the large products are split
+  size_t cutoff; ///< the size at which the recursion stops
+} MatrixStrassenT;
+
+/**
+ * @brief the options of the 3M method
+ */
+typedef struct MatrixGemm3mT {
+  bool enable;   ///< whether the large products take the 3M method
+  size_t cutoff; ///< the size above which the 3M method is used
+} MatrixGemm3mT;
+
+/**
+ * @brief the block sizes of the kernels
+ */
+typedef struct MatrixBlockT {
+  size_t gemm_k;         ///< the depth of a panel of multiplication
+  size_t gemm_n;         ///< the width of a panel of multiplication
+  size_t transpose_leaf; ///< the size at which transposition stops halving
+} MatrixBlockT;
+
+// functions: Strassen-Winograd
+
+/**
+ * @brief set the options of Strassen-Winograd
+ *
+ * @param[in] option the options, NULL to restore the defaults
+ */
+extern void set_matrix_strassen(const MatrixStrassenT *option);
+
+/**
+ * @brief get the options of Strassen-Winograd
+ *
+ * @return the options
+ */
+extern MatrixStrassenT get_matrix_strassen(void);
+
+/**
+ * @brief get the error bound of a product with the current options, the
+ *        result satisfies max|C - AB| <= bound * max|A| * max|B| to the first
+ *        order of the rounding error
+ *
+ * @param[in] m the row size of C
+ * @param[in] n the column size of C
+ * @param[in] k the inner size
+ * @return the relative bound
+ */
+extern float get_matrix_strassen_error_bound(size_t m, size_t n, size_t k);
+
+// functions: 3M
+
+/**
+ * @brief set the options of the 3M method, the real part of a product is as
+ *        accurate as before, the error of the imaginary part is bounded by
+ *        |Re(A) + Im(A)| |Re(B) + Im(B)| instead of
+ *        |Re(A)| |Im(B)| + |Im(A)| |Re(B)|, which is worse when the real and
+ *        imaginary parts cancel
+ *
+ * @param[in] option the options, NULL to restore the defaults
+ */
+extern void set_matrix_gemm_3m(const MatrixGemm3mT *option);
+
+/**
+ * @brief get the options of the 3M method
+ *
+ * @return the options
+ */
+extern MatrixGemm3mT get_matrix_gemm_3m(void);
+
+// functions: block sizes
+
+/**
+ * @brief set the block sizes of the kernels
+ *
+ * @param[in] block the block sizes, NULL to restore the defaults
+ */
+extern void set_matrix_block(const MatrixBlockT *block);
+
+/**
+ * @brief get the block sizes of the kernels
+ *
+ * @return the block sizes
+ */
+extern MatrixBlockT get_matrix_block(void);
+
+// functions: config
+
+/**
+ * @brief load the options and the block sizes from a config file, the
+ *        parameters which are not in the file are kept
+ *
+ * @param[in] file_path the path of the file
+ */
+extern void load_matrix_tune(const char *file_path);
+
+/**
+ * @brief save the options and the block sizes to a config file
+ *
+ * @param[in] file_path the path of the file
+ */
+extern void save_matrix_tune(const char *file_path);
+
+#endif
@@ -9,7 +9,9 @@
 
 // include
 
+#ifndef __cplusplus
 #include <complex.h>
+#endif
 #include <stdbool.h>
 
 // macros
@@ -19,14 +21,14 @@
  *
  * get the maximum value between \p x and \p y
  */
-#define MAX(x, y) (x) > (y) ? (x) : (y)
+#define MAX(x, y) ((x) > (y) ? (x) : (y))
 
 /**
  * \def MIN (x, y)
  *
  * get the minimum value between \p x and \p y
  */
-#define MIN(x, y) (x) > (y) ? (y) : (x)
+#define MIN(x, y) ((x) > (y) ? (y) : (x))
 
 /**
  * \def IS_ODD(x)
@@ -0,0 +1,425 @@
+/**
+ * @file matrix/alloc_matrix.c
+ * @brief allocation and its accounting of matrix library
+ */
+
+// include
+
+#include "alloc_matrix.h"
+#include "matrix/matrix_alloc.h"
+#include "matrix/utils.h"
+#include "profile_matrix.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// constants
+
+/**
+ * \def ALLOC_MAX_ALLOCATOR
+ *
+ * the maximum number of allocators set during a run, the first one is malloc
+ */
+#define ALLOC_MAX_ALLOCATOR 16
+
+// types
+
+/**
+ * @brief the header before every allocation, it keeps the alignment of
+ *        malloc for the memory after it
+ */
+typedef union AllocHeaderT {
+  struct {
+    size_t byte;        ///< the bytes requested
+    uint32_t site;      ///< the site which the bytes are attributed to
+    uint32_t allocator; ///< the allocator which owns the memory
+  } info;               ///< the information of the allocation
+  max_align_t align;    ///< the alignment
+} AllocHeaderT;
+
+/**
+ * @brief the allocation counters of a site
+ */
+typedef struct AllocCounterT {
+  _Atomic uint64_t alloc_count; ///< the number of allocations
+  _Atomic uint64_t alloc_byte;  ///< the cumulative allocated bytes
+  _Atomic uint64_t live_byte;   ///< the bytes allocated and not released
+  _Atomic uint64_t peak_byte;   ///< the maximum of the live bytes
+} AllocCounterT;
+
+// functions: default allocator
+
+/**
+ * @brief allocate by malloc()
+ */
+static void *allocate_default(size_t byte, void *context) {
+  (void)context;
+  return malloc(byte);
+}
+
+/**
+ * @brief resize by realloc()
+ */
+static void *reallocate_default(void *pointer, size_t byte, void *context) {
+  (void)context;
+  return realloc(pointer, byte);
+}
+
+/**
+ * @brief release by free()
+ */
+static void release_default(void *pointer, void *context) {
+  (void)context;
+  free(pointer);
+}
+
+// variables
+
+/**
+ * @brief the allocators set during the run, an allocation keeps the index of
+ *        its allocator to be released by it
+ */
+static MatrixAllocatorT alloc_allocators[ALLOC_MAX_ALLOCATOR] = {
+    {allocate_default, reallocate_default, release_default, NULL},
+};
+
+/**
+ * @brief the number of the allocators
+ */
+static size_t alloc_allocator_number = 1;
+
+/**
+ * @brief the index of the allocator in use
+ */
+static atomic_size_t alloc_current = 0;
+
+/**
+ * @brief guards the allocators
+ */
+static atomic_flag alloc_lock = ATOMIC_FLAG_INIT;
+
+/**
+ * @brief the counters of the library
+ */
+static AllocCounterT alloc_total;
+
+/**
+ * @brief the number of releases
+ */
+static _Atomic uint64_t alloc_free_count = 0;
+
+/**
+ * @brief the counters of the sites, the last one is for the allocations
+ *        outside of the public functions
+ */
+static AllocCounterT alloc_sites[PROFILE_MAX_SITE + 1];
+
+// functions: helpers
+
+/**
+ * @brief raise a peak to a value
+ *
+ * @param[in,out] peak the peak
+ * @param[in] value the value
+ */
+static void raise_peak(_Atomic uint64_t *peak, uint64_t value) {
+  uint64_t old = atomic_load_explicit(peak, memory_order_relaxed);
+  while (old < value && !atomic_compare_exchange_weak_explicit(
+                            peak, &old, value, memory_order_relaxed,
+                            memory_order_relaxed)) {
+  }
+}
+
+/**
+ * @brief count bytes which become live
+ *
+ * @param[in] counter the counter
+ * @param[in] byte the bytes
+ * @param[in] is_new whether it is a new allocation
+ */
+static void count_alloc(AllocCounterT *counter, uint64_t byte, bool is_new) {
+  if (is_new) {
+    atomic_fetch_add_explicit(&counter->alloc_count, 1, memory_order_relaxed);
+  }
+  atomic_fetch_add_explicit(&counter->alloc_byte, byte, memory_order_relaxed);
+  uint64_t live = atomic_fetch_add_explicit(&counter->live_byte, byte,
+                                            memory_order_relaxed) +
+                  byte;
+  raise_peak(&counter->peak_byte, live);
+}
+
+/**
+ * @brief count bytes which are released
+ *
+ * @param[in] counter the counter
+ * @param[in] byte the bytes
+ */
+static void count_free(AllocCounterT *counter, uint64_t byte) {
+  atomic_fetch_sub_explicit(&counter->live_byte, byte, memory_order_relaxed);
+}
+
+/**
+ * @brief get the header of an allocation
+ *
+ * @param[in] pointer the memory returned to the caller
+ * @return the header
+ */
+static AllocHeaderT *get_header(void *pointer) {
+  return (AllocHeaderT *)pointer - 1;
+}
+
+/**
+ * @brief panic for an allocation which fails
+ *
+ * @param[in] byte the bytes requested
+ */
+static void panic_alloc(size_t byte) {
+  log_error("panic: failed to allocate %zu bytes", byte);
+  exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief spin until the allocators are free to change
+ */
+static void lock_alloc(void) {
+  while (atomic_flag_test_and_set_explicit(&alloc_lock, memory_order_acquire)) {
+  }
+}
+
+/**
+ * @brief release the allocators
+ */
+static void unlock_alloc(void) {
+  atomic_flag_clear_explicit(&alloc_lock, memory_order_release);
+}
+
+/**
+ * @brief compare sites by live bytes and then peak bytes for qsort, largest
+ *        first
+ */
+static int compare_site(const void *lhs, const void *rhs) {
+  const MatrixMemorySiteT *l = lhs;
+  const MatrixMemorySiteT *r = rhs;
+  if (l->live_byte != r->live_byte) {
+    return (l->live_byte < r->live_byte) - (l->live_byte > r->live_byte);
+  }
+  return (l->peak_byte < r->peak_byte) - (l->peak_byte > r->peak_byte);
+}
+
+// functions: allocation
+
+void *matrix_malloc(size_t byte) {
+  // boundary test: overflow of the header
+  if (byte > SIZE_MAX - sizeof(AllocHeaderT)) {
+    panic_alloc(byte);
+  }
+  size_t index = atomic_load_explicit(&alloc_current, memory_order_acquire);
+  const MatrixAllocatorT *allocator = &alloc_allocators[index];
+  AllocHeaderT *header =
+      allocator->allocate(sizeof(AllocHeaderT) + byte, allocator->context);
+  if (header == NULL) {
+    panic_alloc(byte);
+  }
+  size_t site = profile_entry_site();
+  header->info.byte = byte;
+  header->info.site = (uint32_t)site;
+  header->info.allocator = (uint32_t)index;
+  count_alloc(&alloc_total, byte, true);
+  count_alloc(&alloc_sites[site], byte, true);
+  PROFILE_BYTE(byte);
+  return header + 1;
+}
+
+void *matrix_calloc(size_t number, size_t size) {
+  // boundary test: overflow of the size
+  if (size != 0 && number > SIZE_MAX / size) {
+    log_error("panic: failed to allocate %zu elements of %zu bytes", number,
+              size);
+    exit(EXIT_FAILURE);
+  }
+  void *pointer = matrix_malloc(number * size);
+  memset(pointer, 0, number * size);
+  return pointer;
+}
+
+void *matrix_realloc(void *pointer, size_t byte) {
+  if (pointer == NULL) {
+    return matrix_malloc(byte);
+  }
+  // boundary test: overflow of the header
+  if (byte > SIZE_MAX - sizeof(AllocHeaderT)) {
+    panic_alloc(byte);
+  }
+  AllocHeaderT *header = get_header(pointer);
+  size_t old_byte = header->info.byte;
+  size_t site = header->info.site;
+  const MatrixAllocatorT *allocator =
+      &alloc_allocators[header->info.allocator];
+  AllocHeaderT *resized = NULL;
+  if (allocator->reallocate != NULL) {
+    resized = allocator->reallocate(header, sizeof(AllocHeaderT) + byte,
+                                    allocator->context);
+    if (resized == NULL) {
+      panic_alloc(byte);
+    }
+  } else {
+    resized =
+        allocator->allocate(sizeof(AllocHeaderT) + byte, allocator->context);
+    if (resized == NULL) {
+      panic_alloc(byte);
+    }
+    memcpy(resized, header, sizeof(AllocHeaderT) + MIN(old_byte, byte));
+    if (allocator->release != NULL) {
+      allocator->release(header, allocator->context);
+    }
+  }
+  resized->info.byte = byte;
+  // the bytes stay with the site of the original allocation
+  if (byte > old_byte) {
+    count_alloc(&alloc_total, byte - old_byte, false);
+    count_alloc(&alloc_sites[site], byte - old_byte, false);
+    PROFILE_BYTE(byte - old_byte);
+  } else {
+    count_free(&alloc_total, old_byte - byte);
+    count_free(&alloc_sites[site], old_byte - byte);
+  }
+  return resized + 1;
+}
+
+void matrix_free(void *pointer) {
+  // if pointer is null, it's fine
+  if (pointer == NULL) {
+    return;
+  }
+  AllocHeaderT *header = get_header(pointer);
+  count_free(&alloc_total, header->info.byte);
+  count_free(&alloc_sites[header->info.site], header->info.byte);
+  atomic_fetch_add_explicit(&alloc_free_count, 1, memory_order_relaxed);
+  const MatrixAllocatorT *allocator =
+      &alloc_allocators[header->info.allocator];
+  if (allocator->release != NULL) {
+    allocator->release(header, allocator->context);
+  }
+}
+
+// functions: allocator
+
+void set_matrix_allocator(const MatrixAllocatorT *allocator) {
+  // NULL restores malloc
+  if (allocator == NULL) {
+    atomic_store_explicit(&alloc_current, 0, memory_order_release);
+    return;
+  }
+  // boundary test: null pointer
+  if (allocator->allocate == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  lock_alloc();
+  // reuse the index of an allocator set before
+  size_t index = 0;
+  while (index < alloc_allocator_number &&
+         memcmp(&alloc_allocators[index], allocator,
+                sizeof(MatrixAllocatorT)) != 0) {
+    ++index;
+  }
+  if (index == alloc_allocator_number) {
+    if (alloc_allocator_number == ALLOC_MAX_ALLOCATOR) {
+      unlock_alloc();
+      log_error("panic: more than %d allocators are set",
+                ALLOC_MAX_ALLOCATOR);
+      exit(EXIT_FAILURE);
+    }
+    alloc_allocators[alloc_allocator_number++] = *allocator;
+  }
+  unlock_alloc();
+  atomic_store_explicit(&alloc_current, index, memory_order_release);
+}
+
+MatrixAllocatorT get_matrix_allocator(void) {
+  return alloc_allocators[atomic_load_explicit(&alloc_current,
+                                               memory_order_acquire)];
+}
+
+// functions: accounting
+
+MatrixMemoryT get_matrix_memory(void) {
+  return (MatrixMemoryT){
+      .live_byte = atomic_load(&alloc_total.live_byte),
+      .peak_byte = atomic_load(&alloc_total.peak_byte),
+      .alloc_count = atomic_load(&alloc_total.alloc_count),
+      .free_count = atomic_load(&alloc_free_count),
+  };
+}
+
+MatrixMemorySiteT *get_matrix_memory_site(size_t *site_number) {
+  // boundary test: null pointer
+  if (site_number == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  // keep the sites which have allocated
+  size_t number = 0;
+  // the array is given to the user, so it stays out of the accounting
+  MatrixMemorySiteT *sites =
+      calloc(PROFILE_MAX_SITE + 1, sizeof(MatrixMemorySiteT));
+  if (sites == NULL) {
+    panic_alloc((PROFILE_MAX_SITE + 1) * sizeof(MatrixMemorySiteT));
+  }
+  for (size_t i = 0; i <= PROFILE_MAX_SITE; ++i) {
+    AllocCounterT *counter = &alloc_sites[i];
+    uint64_t alloc_count = atomic_load(&counter->alloc_count);
+    if (alloc_count == 0) {
+      continue;
+    }
+    sites[number++] = (MatrixMemorySiteT){
+        .name = profile_site_name(i),
+        .alloc_count = alloc_count,
+        .alloc_byte = atomic_load(&counter->alloc_byte),
+        .live_byte = atomic_load(&counter->live_byte),
+        .peak_byte = atomic_load(&counter->peak_byte),
+    };
+  }
+  *site_number = number;
+  if (number == 0) {
+    free(sites);
+    return NULL;
+  }
+  qsort(sites, number, sizeof(MatrixMemorySiteT), compare_site);
+  return sites;
+}
+
+void reset_matrix_memory_peak(void) {
+  atomic_store(&alloc_total.peak_byte, atomic_load(&alloc_total.live_byte));
+  for (size_t i = 0; i <= PROFILE_MAX_SITE; ++i) {
+    AllocCounterT *counter = &alloc_sites[i];
+    atomic_store(&counter->peak_byte, atomic_load(&counter->live_byte));
+  }
+}
+
+void show_matrix_memory(void) {
+  MatrixMemoryT memory = get_matrix_memory();
+  printf("live: %llu bytes, peak: %llu bytes, allocations: %llu, "
+         "releases: %llu\n",
+         (unsigned long long)memory.live_byte,
+         (unsigned long long)memory.peak_byte,
+         (unsigned long long)memory.alloc_count,
+         (unsigned long long)memory.free_count);
+  size_t site_number = 0;
+  MatrixMemorySiteT *sites = get_matrix_memory_site(&site_number);
+  printf("%-36s %12s %14s %14s %14s\n", "function", "allocations", "bytes",
+         "live bytes", "peak bytes");
+  for (size_t i = 0; i < site_number; ++i) {
+    MatrixMemorySiteT *site = &sites[i];
+    printf("%-36s %12llu %14llu %14llu %14llu\n", site->name,
+           (unsigned long long)site->alloc_count,
+           (unsigned long long)site->alloc_byte,
+           (unsigned long long)site->live_byte,
+           (unsigned long long)site->peak_byte);
+  }
+  free(sites);
+}
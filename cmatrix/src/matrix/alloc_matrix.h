@@ -0,0 +1,53 @@
+/**
+ * @file matrix/alloc_matrix.h
+ * @brief internal allocation functions of matrix library
+ *
+ * they behave like the functions of stdlib.h, but use the allocator set by
+ * set_matrix_allocator() and count the bytes, the memory can only be
+ * released by matrix_free()
+ */
+
+#pragma once
+#ifndef __MATRIX_ALLOC_MATRIX_H__
+#define __MATRIX_ALLOC_MATRIX_H__
+
+// include
+
+#include <stddef.h>
+
+// functions: allocation
+
+/**
+ * @brief allocate memory, panic if it fails
+ *
+ * @param[in] byte the number of bytes
+ * @return the memory
+ */
+extern void *matrix_malloc(size_t byte);
+
+/**
+ * @brief allocate memory filled with zero, panic if it fails
+ *
+ * @param[in] number the number of elements
+ * @param[in] size the size of an element
+ * @return the memory
+ */
+extern void *matrix_calloc(size_t number, size_t size);
+
+/**
+ * @brief resize memory, panic if it fails
+ *
+ * @param[in] pointer the memory, or NULL to allocate
+ * @param[in] byte the new number of bytes
+ * @return the resized memory
+ */
+extern void *matrix_realloc(void *pointer, size_t byte);
+
+/**
+ * @brief release memory
+ *
+ * @param[in] pointer the memory, it is fine to be NULL
+ */
+extern void matrix_free(void *pointer);
+
+#endif
@@ -5,9 +5,12 @@
 
 // include
 
+#include "alloc_matrix.h"
+#include "kernel_matrix.h"
 #include "matrix/matrix.h"
 #include "matrix/matrix_ext.h"
 #include "matrix/utils.h"
+#include "profile_matrix.h"
 #include <complex.h>
 #include <float.h>
 #include <math.h>
@@ -51,6 +54,7 @@ void set_matrix_val(MatrixT *matrix, uint8_t row, uint8_t col,
 }
 
 MatrixT *get_matrix_row(const MatrixT *matrix, uint8_t row) {
+  PROFILE_FUNCTION();
   // boundary test: null pointer
   if (matrix == NULL) {
     log_error("panic: null pointer error at %s", __func__);
@@ -72,6 +76,7 @@ MatrixT *get_matrix_row(const MatrixT *matrix, uint8_t row) {
 }
 
 MatrixT *get_matrix_col(const MatrixT *matrix, uint8_t col) {
+  PROFILE_FUNCTION();
   // boundary test: null pointer
   if (matrix == NULL) {
     log_error("panic: null pointer error at %s", __func__);
@@ -93,6 +98,7 @@ MatrixT *get_matrix_col(const MatrixT *matrix, uint8_t col) {
 }
 
 bool is_upper_triangle(const MatrixT *matrix) {
+  PROFILE_FUNCTION();
   // boundary test: null pointer
   if (matrix == NULL) {
     log_error("panic: null pointer error at %s", __func__);
@@ -120,6 +126,7 @@ bool is_upper_triangle(const MatrixT *matrix) {
 }
 
 complex float get_matrix_trace(const MatrixT *matrix) {
+  PROFILE_FUNCTION();
   // boundary test: null pointer
   if (matrix == NULL) {
     log_error("panic: null pointer error at %s", __func__);
@@ -141,6 +148,7 @@ complex float get_matrix_trace(const MatrixT *matrix) {
 }
 
 complex float get_matrix_frobenius_norm(const MatrixT *matrix) {
+  PROFILE_FUNCTION();
   // boundary test: null pointer
   if (matrix == NULL) {
     log_error("panic: null pointer error at %s", __func__);
@@ -156,29 +164,32 @@ complex float get_matrix_frobenius_norm(const MatrixT *matrix) {
 }
 
 uint8_t get_matrix_rank(const MatrixT *matrix) {
-  // simplify the matrix
-  MatrixT *simplest_matrix = simplify_matrix(matrix);
-  // get basic infomation of the matrix
-  uint8_t matrix_diagonal_size =
-      MIN(simplest_matrix->size[0], simplest_matrix->size[1]);
-  // start to count
-  uint8_t offset = 0;
-  uint8_t iter = 1;
-  while (iter <= matrix_diagonal_size &&
-         iter + offset <= simplest_matrix->size[1]) {
-    complex float pivot_value =
-        get_matrix_val(simplest_matrix, iter, iter + offset);
-    if (is_complex_zero(pivot_value)) {
-      offset++;
-      continue;
-    }
-    iter++;
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (matrix == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  size_t matrix_row = matrix->size[0];
+  size_t matrix_col = matrix->size[1];
+  // A P = Q R, the rank is read from the diagonal of R
+  complex float *qr =
+      matrix_malloc(matrix_row * matrix_col * sizeof(complex float));
+  size_t *pivot = matrix_malloc(matrix_col * sizeof(size_t));
+  complex float *tau =
+      matrix_malloc(MIN(matrix_row, matrix_col) * sizeof(complex float));
+  for (size_t i = 0; i < matrix_row * matrix_col; ++i) {
+    qr[i] = matrix->data[i];
   }
-  drop_matrix(simplest_matrix);
-  return iter - 1;
+  size_t rank = kernel_geqp3(matrix_row, matrix_col, qr, matrix_col, pivot, tau);
+  matrix_free(tau);
+  matrix_free(pivot);
+  matrix_free(qr);
+  return (uint8_t)rank;
 }
 
 MatrixT *get_submatrix(const MatrixT *matrix, uint8_t row, uint8_t col) {
+  PROFILE_FUNCTION();
   // boundary test: null pointer
   if (matrix == NULL) {
     log_error("panic: null pointer error at %s", __func__);
@@ -218,6 +229,7 @@ MatrixT *get_submatrix(const MatrixT *matrix, uint8_t row, uint8_t col) {
 
 complex float get_matrix_cofactor(const MatrixT *matrix, uint8_t row,
                                   uint8_t col) {
+  PROFILE_FUNCTION();
   // cofactor(r, c) = det(sub(A, r, c))
   MatrixT *submatrix = get_submatrix(matrix, row, col);
   complex float cofacter = get_matrix_determinant(submatrix);
@@ -227,11 +239,13 @@ complex float get_matrix_cofactor(const MatrixT *matrix, uint8_t row,
 
 complex float get_matrix_algebraic_cofactor(const MatrixT *matrix, uint8_t row,
                                             uint8_t col) {
+  PROFILE_FUNCTION();
   complex float cofacter = get_matrix_cofactor(matrix, row, col);
   return IS_ODD(row + col) ? (-cofacter) : cofacter;
 }
 
 complex float get_matrix_determinant(const MatrixT *matrix) {
+  PROFILE_FUNCTION();
   // boundary test: null pointer
   if (matrix == NULL) {
     log_error("panic: null pointer error at %s", __func__);
@@ -253,6 +267,7 @@ complex float get_matrix_determinant(const MatrixT *matrix) {
 }
 
 MatrixT *get_adjoint_matrix(const MatrixT *matrix) {
+  PROFILE_FUNCTION();
   // init: adjoint matrix
   MatrixT *adjoint_matrix = new_matrix(matrix->size[1], matrix->size[0]);
   // fill adjoint matrix with algebraic cofactor by transposition
@@ -267,6 +282,7 @@ MatrixT *get_adjoint_matrix(const MatrixT *matrix) {
 }
 
 MatrixT *get_inverse_matrix(const MatrixT *matrix) {
+  PROFILE_FUNCTION();
   // inv(A) = adj(A) / det(A)
   complex float determinant = get_matrix_determinant(matrix);
   // boundary test: determinant can not be zero
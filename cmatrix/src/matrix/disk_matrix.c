@@ -0,0 +1,540 @@
+/**
+ * @file matrix/disk_matrix.c
+ * @brief disk matrices and out-of-core algorithms of matrix library
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+// include
+
+#include "alloc_matrix.h"
+#include "kernel_matrix.h"
+#include "matrix/matrix.h"
+#include "matrix/matrix_disk.h"
+#include "matrix/matrix_ext.h"
+#include "matrix/utils.h"
+#include "profile_matrix.h"
+#include <complex.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+// constants
+
+/**
+ * \def DISK_MAGIC
+ *
+ * the first bytes of the file of a disk matrix
+ */
+#define DISK_MAGIC "CMATDISK"
+
+/**
+ * \def DISK_HEADER_BYTE
+ *
+ * the bytes of the header before the tiles
+ */
+#define DISK_HEADER_BYTE 64
+
+// types
+
+/**
+ * @brief the header of the file of a disk matrix
+ */
+typedef union DiskHeaderT {
+  struct {
+    char magic[8]; ///< DISK_MAGIC without the terminating zero
+    uint64_t row;  ///< the row size
+    uint64_t col;  ///< the column size
+    uint64_t tile; ///< the edge of a tile
+  } info;          ///< the information of the matrix
+  unsigned char byte[DISK_HEADER_BYTE]; ///< the size of the header
+} DiskHeaderT;
+
+// functions: helpers
+
+/**
+ * @brief get the bytes of a tile
+ *
+ * @param[in] disk_matrix the disk matrix
+ * @return the bytes
+ */
+static size_t get_tile_byte(const DiskMatrixT *disk_matrix) {
+  return (size_t)disk_matrix->tile * disk_matrix->tile * sizeof(complex float);
+}
+
+/**
+ * @brief get the offset of a tile in the file
+ *
+ * @param[in] disk_matrix the disk matrix
+ * @param[in] row the tile row, from 0
+ * @param[in] col the tile column, from 0
+ * @return the offset
+ */
+static off_t get_tile_offset(const DiskMatrixT *disk_matrix, size_t row,
+                             size_t col) {
+  size_t index = row * disk_matrix->tile_number[1] + col;
+  return (off_t)DISK_HEADER_BYTE + (off_t)index * get_tile_byte(disk_matrix);
+}
+
+/**
+ * @brief get the number of rows or columns of the tiles at an index
+ *
+ * @param[in] disk_matrix the disk matrix
+ * @param[in] dimension 0 for rows, 1 for columns
+ * @param[in] index the tile index, from 0
+ * @return the extent, smaller than the tile edge at the last index
+ */
+static size_t get_tile_extent(const DiskMatrixT *disk_matrix, size_t dimension,
+                              size_t index) {
+  size_t start = index * disk_matrix->tile;
+  return MIN(disk_matrix->tile, disk_matrix->size[dimension] - start);
+}
+
+/**
+ * @brief read or write bytes at an offset until all of them are done
+ *
+ * @param[in] file the file descriptor
+ * @param[in,out] buffer the bytes
+ * @param[in] byte the number of bytes
+ * @param[in] offset the offset in the file
+ * @param[in] is_write write \p buffer instead of reading it
+ */
+static void transfer_byte(int file, void *buffer, size_t byte, off_t offset,
+                          bool is_write) {
+  unsigned char *cursor = buffer;
+  while (byte > 0) {
+    ssize_t done = is_write ? pwrite(file, cursor, byte, offset)
+                            : pread(file, cursor, byte, offset);
+    if (done < 0 && errno == EINTR) {
+      continue;
+    }
+    // boundary test: end of file
+    if (done == 0) {
+      log_error("panic: disk matrix is truncated at byte %lld",
+                (long long)offset);
+      exit(EXIT_FAILURE);
+    }
+    if (done < 0) {
+      log_error("panic: failed to %s disk matrix (%s)",
+                is_write ? "write" : "read", strerror(errno));
+      exit(EXIT_FAILURE);
+    }
+    cursor += done;
+    byte -= (size_t)done;
+    offset += done;
+  }
+}
+
+/**
+ * @brief read a full tile into a buffer with the tile edge as its leading
+ *        dimension
+ */
+static void read_tile(const DiskMatrixT *disk_matrix, size_t row, size_t col,
+                      complex float *buffer) {
+  transfer_byte(disk_matrix->file, buffer, get_tile_byte(disk_matrix),
+                get_tile_offset(disk_matrix, row, col), false);
+}
+
+/**
+ * @brief write a full tile from a buffer with the tile edge as its leading
+ *        dimension
+ */
+static void write_tile(const DiskMatrixT *disk_matrix, size_t row, size_t col,
+                       const complex float *buffer) {
+  transfer_byte(disk_matrix->file, (void *)buffer, get_tile_byte(disk_matrix),
+                get_tile_offset(disk_matrix, row, col), true);
+}
+
+/**
+ * @brief ask the system to read a tile ahead, the read runs in background
+ *        while the current tiles are computed, it is only a hint
+ *
+ * @param[in] disk_matrix the disk matrix
+ * @param[in] row the tile row, from 0, ignored if out of range
+ * @param[in] col the tile column, from 0, ignored if out of range
+ */
+static void prefetch_tile(const DiskMatrixT *disk_matrix, size_t row,
+                          size_t col) {
+  if (row >= disk_matrix->tile_number[0] ||
+      col >= disk_matrix->tile_number[1]) {
+    return;
+  }
+  (void)posix_fadvise(disk_matrix->file,
+                      get_tile_offset(disk_matrix, row, col),
+                      (off_t)get_tile_byte(disk_matrix), POSIX_FADV_WILLNEED);
+}
+
+/**
+ * @brief allocate a disk matrix for an opened file
+ *
+ * @param[in] file the file descriptor
+ * @param[in] row the row size of matrix
+ * @param[in] col the column size of matrix
+ * @param[in] tile the edge of a tile
+ * @return the disk matrix
+ */
+static DiskMatrixT *alloc_disk_matrix(int file, size_t row, size_t col,
+                                      uint8_t tile) {
+  DiskMatrixT *disk_matrix = matrix_malloc(sizeof(DiskMatrixT));
+  disk_matrix->size[0] = row;
+  disk_matrix->size[1] = col;
+  disk_matrix->tile = tile;
+  disk_matrix->tile_number[0] = (row + tile - 1) / tile;
+  disk_matrix->tile_number[1] = (col + tile - 1) / tile;
+  disk_matrix->file = file;
+  return disk_matrix;
+}
+
+/**
+ * @brief factor a diagonal tile A = LU in place without pivoting
+ *
+ * @param[in] n the size of the tile
+ * @param[in,out] a the tile
+ * @param[in] lda the leading dimension of \p a
+ * @param[in] offset the index of the first row of the tile in the matrix
+ */
+static void factor_tile_lu(size_t n, complex float *a, size_t lda,
+                           size_t offset) {
+  for (size_t k = 0; k < n; ++k) {
+    complex float pivot = a[k * lda + k];
+    // boundary test: zero pivot
+    if (pivot == 0.0f) {
+      log_error("panic: zero pivot at row %zu, the matrix needs pivoting",
+                offset + k + 1);
+      exit(EXIT_FAILURE);
+    }
+    for (size_t i = k + 1; i < n; ++i) {
+      complex float factor = a[i * lda + k] / pivot;
+      a[i * lda + k] = factor;
+      kernel_axpy(n - k - 1, -factor, a + k * lda + k + 1,
+                  a + i * lda + k + 1);
+    }
+  }
+}
+
+// functions: init
+
+DiskMatrixT *new_disk_matrix(const char *file_path, size_t row, size_t col,
+                             uint8_t tile) {
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (file_path == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  // boundary test: size
+  if (row == 0 || col == 0 || tile == 0) {
+    log_error("panic: disk matrix size (%zu, %zu) with tile %u is illegal",
+              row, col, tile);
+    exit(EXIT_FAILURE);
+  }
+  // test: open file
+  int file = open(file_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (file < 0) {
+    log_error("panic: failed to open file (%.64s)", file_path);
+    exit(EXIT_FAILURE);
+  }
+  DiskMatrixT *disk_matrix = alloc_disk_matrix(file, row, col, tile);
+  DiskHeaderT header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.info.magic, DISK_MAGIC, sizeof(header.info.magic));
+  header.info.row = row;
+  header.info.col = col;
+  header.info.tile = tile;
+  transfer_byte(file, &header, sizeof(header), 0, true);
+  // the tiles are zeros until written, most file systems do not store them
+  off_t end = get_tile_offset(disk_matrix, disk_matrix->tile_number[0], 0);
+  if (ftruncate(file, end) != 0) {
+    log_error("panic: failed to resize file (%.64s)", file_path);
+    exit(EXIT_FAILURE);
+  }
+  return disk_matrix;
+}
+
+DiskMatrixT *open_disk_matrix(const char *file_path) {
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (file_path == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  // test: open file
+  int file = open(file_path, O_RDWR);
+  if (file < 0) {
+    log_error("panic: failed to open file (%.64s)", file_path);
+    exit(EXIT_FAILURE);
+  }
+  DiskHeaderT header;
+  transfer_byte(file, &header, sizeof(header), 0, false);
+  // test: file format
+  if (memcmp(header.info.magic, DISK_MAGIC, sizeof(header.info.magic)) != 0 ||
+      header.info.row == 0 || header.info.col == 0 || header.info.tile == 0 ||
+      header.info.tile > UINT8_MAX) {
+    log_error("panic: %.64s is not a disk matrix", file_path);
+    exit(EXIT_FAILURE);
+  }
+  return alloc_disk_matrix(file, header.info.row, header.info.col,
+                           (uint8_t)header.info.tile);
+}
+
+DiskMatrixT *new_disk_matrix_from_matrix(const char *file_path,
+                                         const MatrixT *matrix,
+                                         uint8_t tile) {
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (matrix == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  DiskMatrixT *disk_matrix =
+      new_disk_matrix(file_path, matrix->size[0], matrix->size[1], tile);
+  complex float *buffer = matrix_calloc(
+      (size_t)disk_matrix->tile * disk_matrix->tile, sizeof(complex float));
+  for (size_t i = 0; i < disk_matrix->tile_number[0]; ++i) {
+    for (size_t j = 0; j < disk_matrix->tile_number[1]; ++j) {
+      size_t row = get_tile_extent(disk_matrix, 0, i);
+      size_t col = get_tile_extent(disk_matrix, 1, j);
+      // an edge tile does not overwrite the padding left by a full tile
+      if (row < tile || col < tile) {
+        memset(buffer, 0, get_tile_byte(disk_matrix));
+      }
+      for (size_t r = 0; r < row; ++r) {
+        memcpy(buffer + r * tile,
+               matrix->data + (i * tile + r) * matrix->size[1] + j * tile,
+               col * sizeof(complex float));
+      }
+      write_tile(disk_matrix, i, j, buffer);
+    }
+  }
+  matrix_free(buffer);
+  return disk_matrix;
+}
+
+MatrixT *new_matrix_from_disk_matrix(const DiskMatrixT *disk_matrix) {
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (disk_matrix == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  // boundary test: size
+  if (disk_matrix->size[0] > UINT8_MAX || disk_matrix->size[1] > UINT8_MAX) {
+    log_error("panic: disk matrix size (%zu, %zu) is too large for matrix",
+              disk_matrix->size[0], disk_matrix->size[1]);
+    exit(EXIT_FAILURE);
+  }
+  MatrixT *matrix = new_matrix(disk_matrix->size[0], disk_matrix->size[1]);
+  size_t tile = disk_matrix->tile;
+  complex float *buffer = matrix_malloc(get_tile_byte(disk_matrix));
+  for (size_t i = 0; i < disk_matrix->tile_number[0]; ++i) {
+    for (size_t j = 0; j < disk_matrix->tile_number[1]; ++j) {
+      prefetch_tile(disk_matrix, i, j + 1);
+      read_tile(disk_matrix, i, j, buffer);
+      size_t row = get_tile_extent(disk_matrix, 0, i);
+      size_t col = get_tile_extent(disk_matrix, 1, j);
+      for (size_t r = 0; r < row; ++r) {
+        memcpy(matrix->data + (i * tile + r) * matrix->size[1] + j * tile,
+               buffer + r * tile, col * sizeof(complex float));
+      }
+    }
+  }
+  matrix_free(buffer);
+  return matrix;
+}
+
+void drop_disk_matrix(DiskMatrixT *disk_matrix) {
+  PROFILE_FUNCTION();
+  // if matrix is null, it's fine
+  if (disk_matrix == NULL) {
+    return;
+  }
+  close(disk_matrix->file);
+  matrix_free(disk_matrix);
+}
+
+// functions: tiles
+
+MatrixT *get_disk_matrix_tile(const DiskMatrixT *disk_matrix, size_t row,
+                              size_t col) {
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (disk_matrix == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  // boundary test: position
+  if (row == 0 || col == 0 || row > disk_matrix->tile_number[0] ||
+      col > disk_matrix->tile_number[1]) {
+    log_error("panic: %s out of boundary (%zu, %zu)", __func__, row, col);
+    exit(EXIT_FAILURE);
+  }
+  size_t tile_row = get_tile_extent(disk_matrix, 0, row - 1);
+  size_t tile_col = get_tile_extent(disk_matrix, 1, col - 1);
+  complex float *buffer = matrix_malloc(get_tile_byte(disk_matrix));
+  read_tile(disk_matrix, row - 1, col - 1, buffer);
+  MatrixT *tile = new_matrix(tile_row, tile_col);
+  for (size_t r = 0; r < tile_row; ++r) {
+    memcpy(tile->data + r * tile_col, buffer + r * disk_matrix->tile,
+           tile_col * sizeof(complex float));
+  }
+  matrix_free(buffer);
+  return tile;
+}
+
+void set_disk_matrix_tile(DiskMatrixT *disk_matrix, size_t row, size_t col,
+                          const MatrixT *tile) {
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (disk_matrix == NULL || tile == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  // boundary test: position
+  if (row == 0 || col == 0 || row > disk_matrix->tile_number[0] ||
+      col > disk_matrix->tile_number[1]) {
+    log_error("panic: %s out of boundary (%zu, %zu)", __func__, row, col);
+    exit(EXIT_FAILURE);
+  }
+  size_t tile_row = get_tile_extent(disk_matrix, 0, row - 1);
+  size_t tile_col = get_tile_extent(disk_matrix, 1, col - 1);
+  // boundary test: equal size
+  if (tile->size[0] != tile_row || tile->size[1] != tile_col) {
+    log_error("panic: tile size (%u, %u) is not compatible with (%zu, %zu)",
+              tile->size[0], tile->size[1], tile_row, tile_col);
+    exit(EXIT_FAILURE);
+  }
+  // the padding of the tile stays zero
+  complex float *buffer = matrix_calloc(
+      (size_t)disk_matrix->tile * disk_matrix->tile, sizeof(complex float));
+  for (size_t r = 0; r < tile_row; ++r) {
+    memcpy(buffer + r * disk_matrix->tile, tile->data + r * tile_col,
+           tile_col * sizeof(complex float));
+  }
+  write_tile(disk_matrix, row - 1, col - 1, buffer);
+  matrix_free(buffer);
+}
+
+// functions: out-of-core
+
+DiskMatrixT *mul_disk_matrix(const char *file_path, const DiskMatrixT *lhs,
+                             const DiskMatrixT *rhs) {
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (lhs == NULL || rhs == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  // boundary test: compatible size
+  if (lhs->size[1] != rhs->size[0] || lhs->tile != rhs->tile) {
+    log_error("panic: lhs size (%zu, %zu) with tile %u is not compatible "
+              "with rhs size (%zu, %zu) with tile %u",
+              lhs->size[0], lhs->size[1], lhs->tile, rhs->size[0],
+              rhs->size[1], rhs->tile);
+    exit(EXIT_FAILURE);
+  }
+  DiskMatrixT *product =
+      new_disk_matrix(file_path, lhs->size[0], rhs->size[1], lhs->tile);
+  size_t tile = lhs->tile;
+  size_t depth = lhs->tile_number[1];
+  // init: one tile of each operand
+  complex float *a = matrix_malloc(3 * get_tile_byte(product));
+  complex float *b = a + tile * tile;
+  complex float *c = b + tile * tile;
+  for (size_t i = 0; i < product->tile_number[0]; ++i) {
+    size_t mi = get_tile_extent(product, 0, i);
+    for (size_t j = 0; j < product->tile_number[1]; ++j) {
+      size_t nj = get_tile_extent(product, 1, j);
+      // kernel_gemm() only writes the mi x nj block, the padding of an edge
+      // tile is cleared so that it stays zero on disk
+      if (mi < tile || nj < tile) {
+        memset(c, 0, get_tile_byte(product));
+      }
+      for (size_t p = 0; p < depth; ++p) {
+        // the next pair is read ahead while this one is multiplied
+        bool is_last = p + 1 == depth;
+        size_t next_j = is_last ? j + 1 : j;
+        size_t next_p = is_last ? 0 : p + 1;
+        size_t next_i = is_last && next_j == product->tile_number[1] ? i + 1
+                                                                     : i;
+        next_j = next_j == product->tile_number[1] ? 0 : next_j;
+        prefetch_tile(lhs, next_i, next_p);
+        prefetch_tile(rhs, next_p, next_j);
+        read_tile(lhs, i, p, a);
+        read_tile(rhs, p, j, b);
+        kernel_gemm(NO_TRANSPOSE, NO_TRANSPOSE, mi, nj,
+                    get_tile_extent(lhs, 1, p), 1.0f, a, tile, b, tile,
+                    p == 0 ? 0.0f : 1.0f, c, tile);
+      }
+      write_tile(product, i, j, c);
+    }
+  }
+  matrix_free(a);
+  return product;
+}
+
+void decomposition_disk_matrix_lu(DiskMatrixT *disk_matrix) {
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (disk_matrix == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  // boundary test: square matrix
+  if (disk_matrix->size[0] != disk_matrix->size[1]) {
+    log_error("panic: matrix must be squared at %s with size (%zu, %zu)",
+              __func__, disk_matrix->size[0], disk_matrix->size[1]);
+    exit(EXIT_FAILURE);
+  }
+  size_t tile = disk_matrix->tile;
+  size_t number = disk_matrix->tile_number[0];
+  // init: the diagonal tile, a tile of the panel and a trailing tile
+  complex float *d = matrix_malloc(3 * get_tile_byte(disk_matrix));
+  complex float *a = d + tile * tile;
+  complex float *c = a + tile * tile;
+  for (size_t k = 0; k < number; ++k) {
+    size_t nk = get_tile_extent(disk_matrix, 0, k);
+    // A(k, k) = L(k, k) U(k, k)
+    prefetch_tile(disk_matrix, k, k + 1);
+    read_tile(disk_matrix, k, k, d);
+    factor_tile_lu(nk, d, tile, k * tile);
+    write_tile(disk_matrix, k, k, d);
+    // A(k, j) = L(k, k)^-1 A(k, j), the block row of U
+    for (size_t j = k + 1; j < number; ++j) {
+      prefetch_tile(disk_matrix, k, j + 1);
+      read_tile(disk_matrix, k, j, a);
+      kernel_trsm(LEFT, LOWER, NO_TRANSPOSE, UNIT, nk,
+                  get_tile_extent(disk_matrix, 1, j), d, tile, a, tile);
+      write_tile(disk_matrix, k, j, a);
+    }
+    // A(i, k) = A(i, k) U(k, k)^-1, the block column of L, then the
+    // trailing tiles of its row A(i, j) -= A(i, k) A(k, j)
+    for (size_t i = k + 1; i < number; ++i) {
+      size_t ni = get_tile_extent(disk_matrix, 0, i);
+      read_tile(disk_matrix, i, k, a);
+      kernel_trsm(RIGHT, UPPER, NO_TRANSPOSE, NON_UNIT, ni, nk, d, tile, a,
+                  tile);
+      write_tile(disk_matrix, i, k, a);
+      for (size_t j = k + 1; j < number; ++j) {
+        prefetch_tile(disk_matrix, i, j + 1);
+        prefetch_tile(disk_matrix, k, j + 1);
+        read_tile(disk_matrix, k, j, d);
+        read_tile(disk_matrix, i, j, c);
+        kernel_gemm(NO_TRANSPOSE, NO_TRANSPOSE, ni,
+                    get_tile_extent(disk_matrix, 1, j), nk, -1.0f, a, tile,
+                    d, tile, 1.0f, c, tile);
+        write_tile(disk_matrix, i, j, c);
+      }
+      // the diagonal tile is needed again by the next block row
+      if (i + 1 < number) {
+        read_tile(disk_matrix, k, k, d);
+      }
+    }
+  }
+  matrix_free(d);
+}
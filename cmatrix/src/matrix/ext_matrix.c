@@ -5,18 +5,44 @@
 
 // include
 
+#include "alloc_matrix.h"
+#include "kernel_matrix.h"
 #include "matrix/matrix.h"
 #include "matrix/matrix_ext.h"
 #include "matrix/utils.h"
+#include "profile_matrix.h"
 #include <complex.h>
 #include <float.h>
+#include <math.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
 
+// functions: helpers
+
+/**
+ * @brief exchange two rows of a matrix in place
+ *
+ * @param[in,out] matrix the matrix
+ * @param[in] lhs the row index from 1
+ * @param[in] rhs the other row index from 1
+ */
+static void swap_rows(MatrixT *matrix, size_t lhs, size_t rhs) {
+  size_t col = matrix->size[1];
+  complex float *lhs_row = matrix->data + (lhs - 1) * col;
+  complex float *rhs_row = matrix->data + (rhs - 1) * col;
+  for (size_t i = 0; i < col; ++i) {
+    complex float value = lhs_row[i];
+    lhs_row[i] = rhs_row[i];
+    rhs_row[i] = value;
+  }
+}
+
 // function: extensions
 
 MatrixT **upper_triangularize_matrix(const MatrixT *matrix) {
+  PROFILE_FUNCTION();
   // boundary test: null pointer
   if (matrix == NULL) {
     log_error("panic: null pointer error at %s", __func__);
@@ -29,7 +55,7 @@ MatrixT **upper_triangularize_matrix(const MatrixT *matrix) {
   uint8_t matrix_diagonal_size = MIN(matrix_row, matrix_col);
   uint8_t offset = 0;
   // init: LU decomposition result
-  MatrixT **lu_result = calloc(2, sizeof(MatrixT *));
+  MatrixT **lu_result = matrix_calloc(2, sizeof(MatrixT *));
   lu_result[0] = new_identity_matrix(matrix_row, matrix_row);
   lu_result[1] = copy_matrix(matrix);
   size_t change_cnt = 0;
@@ -39,27 +65,14 @@ MatrixT **upper_triangularize_matrix(const MatrixT *matrix) {
     // check: pivot can not be zero
     if (is_complex_zero(get_matrix_val(lu_result[1], iter, iter + offset))) {
       // do row exchange
-      for (uint8_t r = iter + 1; r <= matrix_row; ++r) {
+      for (uint16_t r = iter + 1; r <= matrix_row; ++r) {
         // find a non-zero value
         if (!is_complex_zero(get_matrix_val(lu_result[1], r, iter))) {
-          // construct exchange matrix
-          MatrixT *exchange_matrix =
-              new_identity_matrix(matrix_row, matrix_row);
-          set_matrix_val(exchange_matrix, iter, iter, new_complex(0.0f, 0.0f));
-          set_matrix_val(exchange_matrix, r, r, new_complex(0.0f, 0.0f));
-          set_matrix_val(exchange_matrix, iter, r, new_complex(1.0f, 0.0f));
-          set_matrix_val(exchange_matrix, r, iter, new_complex(1.0f, 0.0f));
-          // apply changes
-          MatrixT *changed_matrix = mul_matrix(exchange_matrix, lu_result[1]);
-          drop_matrix(lu_result[1]);
-          lu_result[1] = changed_matrix;
+          // apply the exchange to both matrices in place
+          swap_rows(lu_result[1], iter, r);
+          swap_rows(lu_result[0], iter, r);
           change_cnt++;
-          // store changes
-          MatrixT *new_left_matrix = mul_matrix(exchange_matrix, lu_result[0]);
-          drop_matrix(lu_result[0]);
-          lu_result[0] = new_left_matrix;
           // skip loop
-          drop_matrix(exchange_matrix);
           break;
         }
       }
@@ -72,39 +85,34 @@ MatrixT **upper_triangularize_matrix(const MatrixT *matrix) {
     // do elimilation
     complex float pivot_value =
         get_matrix_val(lu_result[1], iter, iter + offset);
-    for (uint8_t elim_row = iter + 1; elim_row <= matrix_row; ++elim_row) {
+    for (uint16_t elim_row = iter + 1; elim_row <= matrix_row; ++elim_row) {
       complex float elim_value =
           get_matrix_val(lu_result[1], elim_row, iter + offset);
       if (is_complex_zero(elim_value)) {
         continue;
       }
-      // construct elimilation matrix
-      MatrixT *elim_matrix = new_identity_matrix(matrix_row, matrix_row);
-      set_matrix_val(elim_matrix, elim_row, iter, -elim_value / pivot_value);
-      // apply elimilation
-      MatrixT *new_right_matrix = mul_matrix(elim_matrix, lu_result[1]);
-      drop_matrix(lu_result[1]);
-      lu_result[1] = new_right_matrix;
-      // store elimilation
-      MatrixT *new_left_matrix = mul_matrix(elim_matrix, lu_result[0]);
-      drop_matrix(lu_result[0]);
-      lu_result[0] = new_left_matrix;
-      drop_matrix(elim_matrix);
+      // apply elimilation and store it, both add a multiple of the pivot row
+      complex float factor = -elim_value / pivot_value;
+      kernel_axpy(matrix_col, factor,
+                  lu_result[1]->data + (size_t)(iter - 1) * matrix_col,
+                  lu_result[1]->data + (size_t)(elim_row - 1) * matrix_col);
+      kernel_axpy(matrix_row, factor,
+                  lu_result[0]->data + (size_t)(iter - 1) * matrix_row,
+                  lu_result[0]->data + (size_t)(elim_row - 1) * matrix_row);
     }
     // keep on iter
     iter++;
   }
   // check change times
   if (IS_ODD(change_cnt)) {
-    MatrixT *final_right_matrix = scalar_mul_matrix(-1, lu_result[1]);
-    drop_matrix(lu_result[1]);
-    lu_result[1] = final_right_matrix;
+    kernel_scal(matrix_row * matrix_col, -1.0f, lu_result[1]->data);
   }
   // return: result of LU decomposition
   return lu_result;
 }
 
 MatrixT **decomposition_matrix_lu(const MatrixT *matrix) {
+  PROFILE_FUNCTION();
   MatrixT **lu_result = upper_triangularize_matrix(matrix);
   MatrixT *left_matrix = get_inverse_matrix(lu_result[0]);
   drop_matrix(lu_result[0]);
@@ -113,134 +121,74 @@ MatrixT **decomposition_matrix_lu(const MatrixT *matrix) {
 }
 
 MatrixT *simplify_matrix(const MatrixT *matrix) {
-  MatrixT **lu_result = upper_triangularize_matrix(matrix);
-  MatrixT *simplest_matrix = copy_matrix(lu_result[1]);
-  drop_matrices(lu_result, 2);
-  // get basic info of matrix
-  uint8_t matrix_row = simplest_matrix->size[0];
-  uint8_t matrix_col = simplest_matrix->size[1];
-  // get matrix diagonal size
-  uint8_t matrix_diagonal_size = MIN(matrix_row, matrix_col);
-  uint8_t offset = 0;
-  for (uint8_t iter = 1;
-       iter <= matrix_diagonal_size && iter + offset <= matrix_col;) {
-    complex float pivot_value =
-        get_matrix_val(simplest_matrix, iter, iter + offset);
-    if (is_complex_zero(pivot_value)) {
-      offset++;
-      continue;
-    }
-    // make pivot to 1+0I
-    if (!is_complex_zero(pivot_value - new_complex(1.0f, 0.0f))) {
-      MatrixT *unitify_matrix = new_identity_matrix(matrix_row, matrix_row);
-      set_matrix_val(unitify_matrix, iter, iter,
-                     new_complex(1.0f, 0.0f) / pivot_value);
-      MatrixT *temp_matrix = mul_matrix(unitify_matrix, simplest_matrix);
-      drop_matrix(unitify_matrix);
-      drop_matrix(simplest_matrix);
-      simplest_matrix = temp_matrix;
-    }
-    // elimilation
-    for (uint8_t row_back = iter - 1; row_back > 0; --row_back) {
-      complex float elim_value =
-          get_matrix_val(simplest_matrix, row_back, iter + offset);
-      if (is_complex_zero(elim_value)) {
-        continue;
-      }
-      MatrixT *elim_matrix = new_identity_matrix(matrix_row, matrix_row);
-      set_matrix_val(elim_matrix, row_back, iter, -elim_value);
-      MatrixT *new_simplest_matrix = mul_matrix(elim_matrix, simplest_matrix);
-      drop_matrix(elim_matrix);
-      drop_matrix(simplest_matrix);
-      simplest_matrix = new_simplest_matrix;
+  PROFILE_FUNCTION();
+  return simplify_matrix_with_pivot(matrix, NULL, NULL);
+}
+
+MatrixT *simplify_matrix_with_pivot(const MatrixT *matrix, uint8_t *pivot,
+                                    uint8_t *rank) {
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (matrix == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  uint8_t matrix_row = matrix->size[0];
+  uint8_t matrix_col = matrix->size[1];
+  // init: the reduced row echelon form
+  MatrixT *simplest_matrix = copy_matrix(matrix);
+  size_t *pivot_col =
+      matrix_malloc(MIN(matrix_row, matrix_col) * sizeof(size_t));
+  size_t pivot_number = kernel_rref(matrix_row, matrix_col,
+                                    simplest_matrix->data, matrix_col,
+                                    pivot_col);
+  // pivot columns start from 1 like the other accessors
+  if (pivot != NULL) {
+    for (size_t i = 0; i < pivot_number; ++i) {
+      pivot[i] = (uint8_t)(pivot_col[i] + 1);
     }
-    iter++;
   }
+  if (rank != NULL) {
+    *rank = (uint8_t)pivot_number;
+  }
+  matrix_free(pivot_col);
+  // return: the reduced row echelon form
   return simplest_matrix;
 }
 
 MatrixT **decomposition_matrix_qr(const MatrixT *matrix) {
+  PROFILE_FUNCTION();
   // boundary test: null pointer
   if (matrix == NULL) {
     log_error("panic: null pointer error at %s", __func__);
     exit(EXIT_FAILURE);
   }
-  uint8_t size = matrix->size[0];
+  uint8_t matrix_row = matrix->size[0];
+  uint8_t matrix_col = matrix->size[1];
+  uint8_t reflector_number = MIN(matrix_row, matrix_col);
   // init: result of QR decomposition
-  MatrixT **qr_result = calloc(2, sizeof(MatrixT *));
-  qr_result[0] = new_identity_matrix(size, size);
+  MatrixT **qr_result = matrix_calloc(2, sizeof(MatrixT *));
+  qr_result[0] = new_matrix(matrix_row, matrix_row);
   qr_result[1] = copy_matrix(matrix);
-  // construct P_k
-  for (uint8_t iter = 1; iter < size; ++iter) {
-    // get the `iter` column of matrix (P^m A)
-    // m from 0 to (n - 1)
-    MatrixT *col_iter = get_matrix_col(qr_result[1], iter);
-    // normalize the column vector
-    complex float norm = get_matrix_frobenius_norm(col_iter);
-    MatrixT *norm_col_iter = scalar_mul_matrix(1 / norm, col_iter);
-    drop_matrix(col_iter);
-    // calculate the value of d_rare = sqrt(sum(column_iter ^ 2))
-    complex float d_rare = new_complex(0.0f, 0.0f);
-    for (uint8_t j = iter; j <= size; ++j) {
-      complex float val_at_j = get_matrix_val(norm_col_iter, j, 1);
-      d_rare += val_at_j * val_at_j;
+  // R = H(k)^H ... H(1)^H A, with the reflectors under the diagonal
+  complex float *tau = matrix_malloc(reflector_number * sizeof(complex float));
+  kernel_geqrf(matrix_row, matrix_col, qr_result[1]->data, matrix_col, tau);
+  // Q = H(1) ... H(k)
+  kernel_ungqr(matrix_row, matrix_row, reflector_number, qr_result[1]->data,
+               matrix_col, tau, qr_result[0]->data, matrix_row);
+  matrix_free(tau);
+  // clear the reflectors from R
+  for (size_t i = 1; i < matrix_row; ++i) {
+    for (size_t j = 0; j < i && j < matrix_col; ++j) {
+      qr_result[1]->data[i * matrix_col + j] = new_complex(0.0f, 0.0f);
     }
-    d_rare = csqrtf(d_rare);
-    // use the `iter`-th value to get the sign of D
-    // if value > 0, then get negative, or positive
-    complex float d_iter = get_matrix_val(norm_col_iter, iter, 1);
-    if (crealf(d_iter) > FLT_MIN) {
-      d_rare = -d_rare;
-    }
-    // construct vector V_iter
-    MatrixT *V_iter = new_matrix(size, 1);
-    // v_j = 0, j in [0, iter - 1]
-    // v_iter = sqrt(1/2 (1 - d_iter / d_rare))
-    complex float v_iter = csqrtf(0.5 * (1 - d_iter / d_rare));
-    set_matrix_val(V_iter, iter, 1, v_iter);
-    // p = - d_rare / v_iter
-    complex float p = -d_rare * v_iter;
-    // v_j = d_j / (2 p), j in [iter + 1, n]
-    for (uint8_t j = iter + 1; j <= size; ++j) {
-      set_matrix_val(V_iter, j, 1,
-                     get_matrix_val(norm_col_iter, j, 1) / (2 * p));
-    }
-    drop_matrix(norm_col_iter);
-    // get transposed V_iter
-    MatrixT *trans_V_iter = transpose_matrix(V_iter);
-    // calculate V V^T
-    MatrixT *matrix_V_Vt = mul_matrix(V_iter, trans_V_iter);
-    drop_matrix(trans_V_iter);
-    drop_matrix(V_iter);
-    // get the matrix -2 V V^T
-    MatrixT *double_V_Vt =
-        scalar_mul_matrix(new_complex(-2.0f, 0.0f), matrix_V_Vt);
-    drop_matrix(matrix_V_Vt);
-    // the identity matrix with size (n, n)
-    MatrixT *id = new_identity_matrix(size, size);
-    // matrix p = I - 2 V V^T
-    MatrixT *new_matrix_p = add_matrix(id, double_V_Vt);
-    drop_matrix(id);
-    drop_matrix(double_V_Vt);
-    // store P = P_{n} P_{n - 1} ...
-    MatrixT *temp_p = mul_matrix(new_matrix_p, qr_result[0]);
-    drop_matrix(qr_result[0]);
-    qr_result[0] = temp_p;
-    // apply p matrix R = P_{n} (P_{n - 1} ...) A
-    MatrixT *temp_r = mul_matrix(new_matrix_p, qr_result[1]);
-    drop_matrix(qr_result[1]);
-    qr_result[1] = temp_r;
-    drop_matrix(new_matrix_p);
-  }
-  // get matrix Q = (P_{n} P_{n - 1} ...)^T
-  MatrixT *matrix_q = transpose_matrix(qr_result[0]);
-  drop_matrix(qr_result[0]);
-  qr_result[0] = matrix_q;
+  }
   // return: result of QR decomposition
   return qr_result;
 }
 
 MatrixT **get_matrix_eigensystem_qr(const MatrixT *matrix, size_t max_iter) {
+  PROFILE_FUNCTION();
   // boundary test: null pointer
   if (matrix == NULL) {
     log_error("panic: null pointer error at %s", __func__);
@@ -253,7 +201,7 @@ MatrixT **get_matrix_eigensystem_qr(const MatrixT *matrix, size_t max_iter) {
     exit(EXIT_FAILURE);
   }
   // init: eigen system
-  MatrixT **eigen_system = calloc(2, sizeof(MatrixT *));
+  MatrixT **eigen_system = matrix_calloc(2, sizeof(MatrixT *));
   eigen_system[0] = copy_matrix(matrix);
   eigen_system[1] = new_identity_matrix(matrix->size[0], matrix->size[1]);
   // start iter
@@ -279,3 +227,603 @@ MatrixT **get_matrix_eigensystem_qr(const MatrixT *matrix, size_t max_iter) {
   }
   return eigen_system;
 }
+
+MatrixT *solve_triangular_matrix(MatrixSide side, MatrixTriangle triangle,
+                                 MatrixOperation operation,
+                                 MatrixDiagonal diagonal,
+                                 const MatrixT *matrix, const MatrixT *rhs) {
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (matrix == NULL || rhs == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  // boundary tes: square matrix
+  if (matrix->size[0] != matrix->size[1]) {
+    log_error("panic: matrix must be squared at %s with size (%u, %u)",
+              __func__, matrix->size[0], matrix->size[1]);
+    exit(EXIT_FAILURE);
+  }
+  // boundary test: compitable size
+  if (matrix->size[0] != rhs->size[side == LEFT ? 0 : 1]) {
+    log_error(
+        "panic: matrix size (%u, %u) is not compatible with rhs size (%u, %u)",
+        matrix->size[0], matrix->size[1], rhs->size[0], rhs->size[1]);
+    exit(EXIT_FAILURE);
+  }
+  // boundary test: diagonal can not be zero
+  for (size_t i = 0; diagonal == NON_UNIT && i < matrix->size[0]; ++i) {
+    if (is_complex_zero(matrix->data[i * matrix->size[1] + i])) {
+      log_error("panic: the triangular matrix isn't inversable at %s",
+                __func__);
+      exit(EXIT_FAILURE);
+    }
+  }
+  // init: solution, overwritten in place
+  MatrixT *solution = copy_matrix(rhs);
+  kernel_trsm(side, triangle, operation, diagonal, solution->size[0],
+              solution->size[1], matrix->data, matrix->size[1],
+              solution->data, solution->size[1]);
+  // return: solution
+  return solution;
+}
+
+MatrixT *mul_triangular_matrix(MatrixSide side, MatrixTriangle triangle,
+                               MatrixOperation operation,
+                               MatrixDiagonal diagonal, const MatrixT *matrix,
+                               const MatrixT *rhs) {
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (matrix == NULL || rhs == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  // boundary tes: square matrix
+  if (matrix->size[0] != matrix->size[1]) {
+    log_error("panic: matrix must be squared at %s with size (%u, %u)",
+              __func__, matrix->size[0], matrix->size[1]);
+    exit(EXIT_FAILURE);
+  }
+  // boundary test: compitable size
+  if (matrix->size[0] != rhs->size[side == LEFT ? 0 : 1]) {
+    log_error(
+        "panic: matrix size (%u, %u) is not compatible with rhs size (%u, %u)",
+        matrix->size[0], matrix->size[1], rhs->size[0], rhs->size[1]);
+    exit(EXIT_FAILURE);
+  }
+  // init: product, overwritten in place
+  MatrixT *prod_matrix = copy_matrix(rhs);
+  kernel_trmm(side, triangle, operation, diagonal, prod_matrix->size[0],
+              prod_matrix->size[1], matrix->data, matrix->size[1],
+              prod_matrix->data, prod_matrix->size[1]);
+  // return: product
+  return prod_matrix;
+}
+
+MatrixT *decomposition_matrix_cholesky(const MatrixT *matrix) {
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (matrix == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  // init: factor from the lower triangle
+  MatrixT *factor = new_matrix(matrix->size[0], matrix->size[1]);
+  for (size_t i = 0; i < factor->size[0]; ++i) {
+    for (size_t j = 0; j <= i && j < factor->size[1]; ++j) {
+      factor->data[i * factor->size[1] + j] =
+          matrix->data[i * matrix->size[1] + j];
+    }
+  }
+  decomposition_matrix_cholesky_in_place(factor);
+  // return: the factor L
+  return factor;
+}
+
+void decomposition_matrix_cholesky_in_place(MatrixT *matrix) {
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (matrix == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  // boundary tes: square matrix
+  if (matrix->size[0] != matrix->size[1]) {
+    log_error("panic: matrix must be squared at %s with size (%u, %u)",
+              __func__, matrix->size[0], matrix->size[1]);
+    exit(EXIT_FAILURE);
+  }
+  size_t minor =
+      kernel_potrf(matrix->size[0], matrix->data, matrix->size[1]);
+  // boundary test: positive definite
+  if (minor < matrix->size[0]) {
+    log_error("panic: the matrix isn't positive definite, "
+              "the leading minor of order %zu is not positive",
+              minor + 1);
+    exit(EXIT_FAILURE);
+  }
+}
+
+MatrixT *solve_matrix_cholesky(const MatrixT *factor, const MatrixT *rhs) {
+  PROFILE_FUNCTION();
+  // L Y = B
+  MatrixT *solution =
+      solve_triangular_matrix(LEFT, LOWER, NO_TRANSPOSE, NON_UNIT, factor, rhs);
+  // L^H X = Y, in place
+  kernel_trsm(LEFT, LOWER, CONJUGATE_TRANSPOSE, NON_UNIT, solution->size[0],
+              solution->size[1], factor->data, factor->size[1],
+              solution->data, solution->size[1]);
+  // return: solution
+  return solution;
+}
+
+float get_matrix_log_determinant_cholesky(const MatrixT *factor) {
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (factor == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  // boundary tes: square matrix
+  if (factor->size[0] != factor->size[1]) {
+    log_error("panic: matrix must be squared at %s with size (%u, %u)",
+              __func__, factor->size[0], factor->size[1]);
+    exit(EXIT_FAILURE);
+  }
+  // log det(A) = log det(L) det(L^H) = 2 sum(log(L(i, i)))
+  float log_determinant = 0.0f;
+  for (size_t i = 0; i < factor->size[0]; ++i) {
+    log_determinant += logf(crealf(factor->data[i * factor->size[1] + i]));
+  }
+  return 2.0f * log_determinant;
+}
+
+/**
+ * @brief complete a set of orthonormal rows with unit vectors by
+ *        Gram-Schmidt, for the singular vectors of zero singular values
+ *
+ * @param[in] count the number of rows to fill
+ * @param[in] valid the number of leading rows which are orthonormal
+ * @param[in] len the length of the rows ( \p count <= \p len )
+ * @param[in,out] rows the rows to complete
+ */
+static void complete_orthonormal_rows(size_t count, size_t valid, size_t len,
+                                      complex float *rows) {
+  size_t candidate = 0;
+  for (size_t r = valid; r < count && candidate < len; ++candidate) {
+    complex float *row = rows + r * len;
+    for (size_t j = 0; j < len; ++j) {
+      row[j] = new_complex(j == candidate ? 1.0f : 0.0f, 0.0f);
+    }
+    // orthogonalize twice against the rows before
+    for (size_t pass = 0; pass < 2; ++pass) {
+      for (size_t k = 0; k < r; ++k) {
+        complex float proj = new_complex(0.0f, 0.0f);
+        for (size_t j = 0; j < len; ++j) {
+          proj += conjf(rows[k * len + j]) * row[j];
+        }
+        for (size_t j = 0; j < len; ++j) {
+          row[j] -= proj * rows[k * len + j];
+        }
+      }
+    }
+    float norm = 0.0f;
+    for (size_t j = 0; j < len; ++j) {
+      norm += crealf(row[j] * conjf(row[j]));
+    }
+    norm = sqrtf(norm);
+    // the unit vector lies in the span already, try the next one
+    if (norm < 0.5f) {
+      continue;
+    }
+    for (size_t j = 0; j < len; ++j) {
+      row[j] /= norm;
+    }
+    r++;
+  }
+}
+
+/**
+ * @brief singular value decomposition of a matrix with row >= col,
+ *        QR first, then one-sided Jacobi on the triangular factor
+ *
+ * @param[in] matrix the matrix to use
+ * @param[in] economy keep only the leading col columns of U
+ * @return U, Sigma and V^H
+ */
+static MatrixT **svd_tall_matrix(const MatrixT *matrix, bool economy) {
+  uint8_t m = matrix->size[0];
+  uint8_t n = matrix->size[1];
+  // A = Q R
+  complex float *qr = matrix_malloc(m * n * sizeof(complex float));
+  complex float *tau = matrix_malloc(n * sizeof(complex float));
+  for (size_t i = 0; i < (size_t)m * n; ++i) {
+    qr[i] = matrix->data[i];
+  }
+  kernel_geqrf(m, n, qr, n, tau);
+  // rows of w are the columns of R, rows of v the columns of V
+  complex float *w = matrix_calloc(n * n, sizeof(complex float));
+  complex float *v = matrix_calloc(n * n, sizeof(complex float));
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = i; j < n; ++j) {
+      w[j * n + i] = qr[i * n + j];
+    }
+    v[i * n + i] = new_complex(1.0f, 0.0f);
+  }
+  float *sigma = matrix_malloc(n * sizeof(float));
+  kernel_jacobi_svd(n, n, w, n, n, v, n, sigma);
+  // order: singular values in descending order
+  size_t *order = matrix_malloc(n * sizeof(size_t));
+  for (size_t i = 0; i < n; ++i) {
+    size_t j = i;
+    for (; j > 0 && sigma[order[j - 1]] < sigma[i]; --j) {
+      order[j] = order[j - 1];
+    }
+    order[j] = i;
+  }
+  // init: result of singular value decomposition
+  MatrixT **svd_result = matrix_calloc(3, sizeof(MatrixT *));
+  uint8_t u_col = economy ? n : m;
+  svd_result[0] = new_matrix(m, u_col);
+  svd_result[1] = new_matrix(u_col, n);
+  svd_result[2] = new_matrix(n, n);
+  // rows of ur are the columns of U_R = W Sigma^-1
+  complex float *ur = matrix_malloc(n * n * sizeof(complex float));
+  float threshold = sigma[order[0]] * (float)m * FLT_EPSILON;
+  size_t valid = 0;
+  for (size_t k = 0; k < n; ++k) {
+    float value = sigma[order[k]];
+    svd_result[1]->data[k * n + k] = new_complex(value, 0.0f);
+    // V^H(k, :) = conj(V(:, k))
+    for (size_t j = 0; j < n; ++j) {
+      svd_result[2]->data[k * n + j] = conjf(v[order[k] * n + j]);
+    }
+    if (value > threshold && value > 0.0f) {
+      for (size_t j = 0; j < n; ++j) {
+        ur[k * n + j] = w[order[k] * n + j] / value;
+      }
+      valid++;
+    }
+  }
+  complete_orthonormal_rows(n, valid, n, ur);
+  // U = Q [U_R 0; 0 I]
+  complex float *q = matrix_malloc(m * u_col * sizeof(complex float));
+  kernel_ungqr(m, u_col, n, qr, n, tau, q, u_col);
+  kernel_gemm(NO_TRANSPOSE, TRANSPOSE, m, n, n, new_complex(1.0f, 0.0f), q,
+              u_col, ur, n, new_complex(0.0f, 0.0f), svd_result[0]->data,
+              u_col);
+  for (size_t i = 0; i < m; ++i) {
+    for (size_t j = n; j < u_col; ++j) {
+      svd_result[0]->data[i * u_col + j] = q[i * u_col + j];
+    }
+  }
+  matrix_free(q);
+  matrix_free(ur);
+  matrix_free(order);
+  matrix_free(sigma);
+  matrix_free(v);
+  matrix_free(w);
+  matrix_free(tau);
+  matrix_free(qr);
+  // return: result of singular value decomposition
+  return svd_result;
+}
+
+MatrixT **decomposition_matrix_svd(const MatrixT *matrix, bool economy) {
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (matrix == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  if (matrix->size[0] >= matrix->size[1]) {
+    return svd_tall_matrix(matrix, economy);
+  }
+  // A^H = U' S' V'^H  =>  A = V' S'^T U'^H
+  MatrixT *adjoint = conjugate_transpose_matrix(matrix);
+  MatrixT **svd_result = svd_tall_matrix(adjoint, economy);
+  drop_matrix(adjoint);
+  MatrixT *matrix_u = conjugate_transpose_matrix(svd_result[2]);
+  MatrixT *matrix_vh = conjugate_transpose_matrix(svd_result[0]);
+  MatrixT *matrix_sigma = transpose_matrix(svd_result[1]);
+  drop_matrix(svd_result[0]);
+  drop_matrix(svd_result[1]);
+  drop_matrix(svd_result[2]);
+  svd_result[0] = matrix_u;
+  svd_result[1] = matrix_sigma;
+  svd_result[2] = matrix_vh;
+  // return: result of singular value decomposition
+  return svd_result;
+}
+
+/**
+ * @brief replace the columns of a block by an orthonormal basis of their
+ *        span, the thin Q of its QR decomposition
+ *
+ * @param[in] row the row size of the block
+ * @param[in] col the column size of the block ( \p col <= \p row )
+ * @param[in,out] data the block, overwritten by Q
+ */
+static void orthonormalize_columns(size_t row, size_t col,
+                                   complex float *data) {
+  complex float *tau = matrix_malloc(col * sizeof(complex float));
+  complex float *q = matrix_malloc(row * col * sizeof(complex float));
+  kernel_geqrf(row, col, data, col, tau);
+  kernel_ungqr(row, col, col, data, col, tau, q, col);
+  for (size_t i = 0; i < row * col; ++i) {
+    data[i] = q[i];
+  }
+  matrix_free(q);
+  matrix_free(tau);
+}
+
+MatrixT **decomposition_matrix_randomized_svd(const MatrixT *matrix,
+                                              uint8_t rank,
+                                              uint8_t oversampling,
+                                              size_t power_iteration) {
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (matrix == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  size_t m = matrix->size[0];
+  size_t n = matrix->size[1];
+  // boundary test: rank
+  if (rank == 0 || rank > MIN(m, n)) {
+    log_error("panic: the rank %u is out of range [1, %zu]", rank, MIN(m, n));
+    exit(EXIT_FAILURE);
+  }
+  size_t l = MIN((size_t)rank + oversampling, MIN(m, n));
+  const complex float one = new_complex(1.0f, 0.0f);
+  const complex float zero = new_complex(0.0f, 0.0f);
+  // range finder: Q = orth(A Omega) with a Gaussian sketch Omega (n, l)
+  MatrixT *sketch = new_random_normal_matrix(n, l);
+  complex float *q = matrix_malloc(m * l * sizeof(complex float));
+  kernel_gemm(NO_TRANSPOSE, NO_TRANSPOSE, m, l, n, one, matrix->data, n,
+              sketch->data, l, zero, q, l);
+  orthonormalize_columns(m, l, q);
+  // power iteration: Q = orth(A orth(A^H Q)), re-orthonormalized every step
+  // so the small singular values are not lost in rounding
+  complex float *z = sketch->data;
+  for (size_t i = 0; i < power_iteration; ++i) {
+    kernel_gemm(CONJUGATE_TRANSPOSE, NO_TRANSPOSE, n, l, m, one, matrix->data,
+                n, q, l, zero, z, l);
+    orthonormalize_columns(n, l, z);
+    kernel_gemm(NO_TRANSPOSE, NO_TRANSPOSE, m, l, n, one, matrix->data, n, z,
+                l, zero, q, l);
+    orthonormalize_columns(m, l, q);
+  }
+  drop_matrix(sketch);
+  // B = Q^H A with size (l, n), then B = U_B S V^H
+  MatrixT *projection = new_matrix(l, n);
+  kernel_gemm(CONJUGATE_TRANSPOSE, NO_TRANSPOSE, l, n, m, one, q, l,
+              matrix->data, n, zero, projection->data, n);
+  MatrixT **projection_svd = decomposition_matrix_svd(projection, true);
+  drop_matrix(projection);
+  // init: result of randomized singular value decomposition
+  MatrixT **svd_result = matrix_calloc(3, sizeof(MatrixT *));
+  svd_result[0] = new_matrix(m, rank);
+  svd_result[1] = new_matrix(rank, rank);
+  svd_result[2] = new_matrix(rank, n);
+  // U = Q U_B, keep the leading rank columns only
+  kernel_gemm(NO_TRANSPOSE, NO_TRANSPOSE, m, rank, l, one, q, l,
+              projection_svd[0]->data, l, zero, svd_result[0]->data, rank);
+  for (size_t k = 0; k < rank; ++k) {
+    svd_result[1]->data[k * rank + k] = projection_svd[1]->data[k * l + k];
+    for (size_t j = 0; j < n; ++j) {
+      svd_result[2]->data[k * n + j] = projection_svd[2]->data[k * n + j];
+    }
+  }
+  drop_matrices(projection_svd, 3);
+  matrix_free(q);
+  // return: result of randomized singular value decomposition
+  return svd_result;
+}
+
+MatrixT *get_matrix_null_space(const MatrixT *matrix, uint8_t *rank) {
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (matrix == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  size_t m = matrix->size[0];
+  size_t n = matrix->size[1];
+  // A P = Q R
+  complex float *qr = matrix_malloc(m * n * sizeof(complex float));
+  size_t *pivot = matrix_malloc(n * sizeof(size_t));
+  complex float *tau = matrix_malloc(MIN(m, n) * sizeof(complex float));
+  for (size_t i = 0; i < m * n; ++i) {
+    qr[i] = matrix->data[i];
+  }
+  size_t r = kernel_geqp3(m, n, qr, n, pivot, tau);
+  matrix_free(tau);
+  if (rank != NULL) {
+    *rank = (uint8_t)r;
+  }
+  // full column rank has no null space
+  if (r == n) {
+    matrix_free(pivot);
+    matrix_free(qr);
+    return NULL;
+  }
+  size_t nullity = n - r;
+  // R11 X + R12 = 0 gives the null space P [X; I] of A
+  complex float *x = matrix_malloc(n * nullity * sizeof(complex float));
+  for (size_t i = 0; i < r; ++i) {
+    for (size_t j = 0; j < nullity; ++j) {
+      x[i * nullity + j] = -qr[i * n + r + j];
+    }
+  }
+  kernel_trsm(LEFT, UPPER, NO_TRANSPOSE, NON_UNIT, r, nullity, qr, n, x,
+              nullity);
+  for (size_t i = 0; i < nullity; ++i) {
+    for (size_t j = 0; j < nullity; ++j) {
+      x[(r + i) * nullity + j] = new_complex(i == j ? 1.0f : 0.0f, 0.0f);
+    }
+  }
+  orthonormalize_columns(n, nullity, x);
+  // init: null space basis, undo the column pivoting on its rows
+  MatrixT *null_space = new_matrix(n, nullity);
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = 0; j < nullity; ++j) {
+      null_space->data[pivot[i] * nullity + j] = x[i * nullity + j];
+    }
+  }
+  matrix_free(x);
+  matrix_free(pivot);
+  matrix_free(qr);
+  // return: null space basis
+  return null_space;
+}
+
+/**
+ * @brief minimum norm least squares solution by the singular value
+ *        decomposition, X = V Sigma^+ U^H B
+ *
+ * @param[in] matrix the matrix A
+ * @param[in] rhs the right hand sides B
+ * @return the solution X
+ */
+static MatrixT *solve_least_squares_svd(const MatrixT *matrix,
+                                        const MatrixT *rhs) {
+  size_t n = matrix->size[1];
+  size_t nrhs = rhs->size[1];
+  MatrixT **svd_result = decomposition_matrix_svd(matrix, true);
+  size_t m = svd_result[0]->size[0];
+  size_t k = svd_result[0]->size[1];
+  const complex float one = new_complex(1.0f, 0.0f);
+  const complex float zero = new_complex(0.0f, 0.0f);
+  // C = Sigma^+ U^H B, singular values under the noise level are dropped
+  complex float *c = matrix_malloc(k * nrhs * sizeof(complex float));
+  kernel_gemm(CONJUGATE_TRANSPOSE, NO_TRANSPOSE, k, nrhs, m, one,
+              svd_result[0]->data, k, rhs->data, nrhs, zero, c, nrhs);
+  float threshold =
+      crealf(svd_result[1]->data[0]) * (float)MAX(m, n) * FLT_EPSILON;
+  for (size_t i = 0; i < k; ++i) {
+    float value = crealf(svd_result[1]->data[i * k + i]);
+    float inverse = value > threshold ? 1.0f / value : 0.0f;
+    for (size_t j = 0; j < nrhs; ++j) {
+      c[i * nrhs + j] *= inverse;
+    }
+  }
+  // X = V C
+  MatrixT *solution = new_matrix(n, nrhs);
+  kernel_gemm(CONJUGATE_TRANSPOSE, NO_TRANSPOSE, n, nrhs, k, one,
+              svd_result[2]->data, n, c, nrhs, zero, solution->data, nrhs);
+  matrix_free(c);
+  drop_matrices(svd_result, 3);
+  return solution;
+}
+
+MatrixT *solve_matrix_least_squares(const MatrixT *matrix, const MatrixT *rhs,
+                                    uint8_t *rank) {
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (matrix == NULL || rhs == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  // boundary test: compitable size
+  if (matrix->size[0] != rhs->size[0]) {
+    log_error(
+        "panic: matrix size (%u, %u) is not compatible with rhs size (%u, %u)",
+        matrix->size[0], matrix->size[1], rhs->size[0], rhs->size[1]);
+    exit(EXIT_FAILURE);
+  }
+  size_t m = matrix->size[0];
+  size_t n = matrix->size[1];
+  size_t nrhs = rhs->size[1];
+  bool tall = m >= n;
+  // factorize A P = Q R if tall, or A^H P = Q R if wide
+  size_t qr_row = tall ? m : n;
+  size_t qr_col = tall ? n : m;
+  complex float *qr = matrix_malloc(m * n * sizeof(complex float));
+  size_t *pivot = matrix_malloc(qr_col * sizeof(size_t));
+  complex float *tau = matrix_malloc(qr_col * sizeof(complex float));
+  if (tall) {
+    for (size_t i = 0; i < m * n; ++i) {
+      qr[i] = matrix->data[i];
+    }
+  } else {
+    kernel_transpose(m, n, matrix->data, n, qr, m, true);
+  }
+  size_t r = kernel_geqp3(qr_row, qr_col, qr, qr_col, pivot, tau);
+  if (rank != NULL) {
+    *rank = (uint8_t)r;
+  }
+  MatrixT *solution = NULL;
+  if (r < qr_col) {
+    // rank deficient: minimum norm solution
+    solution = solve_least_squares_svd(matrix, rhs);
+  } else if (tall) {
+    // R z = (Q^H B)(1:n, :), x = P z
+    complex float *c = matrix_malloc(m * nrhs * sizeof(complex float));
+    for (size_t i = 0; i < m * nrhs; ++i) {
+      c[i] = rhs->data[i];
+    }
+    kernel_unmqr(CONJUGATE_TRANSPOSE, m, nrhs, n, qr, n, tau, c, nrhs);
+    kernel_trsm(LEFT, UPPER, NO_TRANSPOSE, NON_UNIT, n, nrhs, qr, n, c, nrhs);
+    solution = new_matrix(n, nrhs);
+    for (size_t i = 0; i < n; ++i) {
+      for (size_t j = 0; j < nrhs; ++j) {
+        solution->data[pivot[i] * nrhs + j] = c[i * nrhs + j];
+      }
+    }
+    matrix_free(c);
+  } else {
+    // P^T A = R^H Q^H, so R^H y = P^T B and x = Q [y; 0] has minimum norm
+    solution = new_matrix(n, nrhs);
+    for (size_t i = 0; i < m; ++i) {
+      for (size_t j = 0; j < nrhs; ++j) {
+        solution->data[i * nrhs + j] = rhs->data[pivot[i] * nrhs + j];
+      }
+    }
+    kernel_trsm(LEFT, UPPER, CONJUGATE_TRANSPOSE, NON_UNIT, m, nrhs, qr, m,
+                solution->data, nrhs);
+    kernel_unmqr(NO_TRANSPOSE, n, nrhs, m, qr, m, tau, solution->data, nrhs);
+  }
+  matrix_free(tau);
+  matrix_free(pivot);
+  matrix_free(qr);
+  // return: solution
+  return solution;
+}
+
+MatrixT *get_pseudo_inverse_matrix(const MatrixT *matrix) {
+  PROFILE_FUNCTION();
+  MatrixT **svd_result = decomposition_matrix_svd(matrix, true);
+  uint8_t rank_size = svd_result[1]->size[0];
+  // drop singular values under the noise level
+  float threshold = crealf(svd_result[1]->data[0]) *
+                    (float)MAX(matrix->size[0], matrix->size[1]) *
+                    FLT_EPSILON;
+  // pinv(A) = V Sigma^+ U^H, scale the rows of V^H first
+  for (size_t k = 0; k < rank_size; ++k) {
+    float value = crealf(svd_result[1]->data[k * rank_size + k]);
+    float inverse = value > threshold ? 1.0f / value : 0.0f;
+    for (size_t j = 0; j < svd_result[2]->size[1]; ++j) {
+      svd_result[2]->data[k * svd_result[2]->size[1] + j] *= inverse;
+    }
+  }
+  MatrixT *pseudo_inverse = mul_matrix_with_operation(
+      CONJUGATE_TRANSPOSE, svd_result[2], CONJUGATE_TRANSPOSE, svd_result[0]);
+  drop_matrices(svd_result, 3);
+  return pseudo_inverse;
+}
+
+float get_matrix_condition_number(const MatrixT *matrix) {
+  PROFILE_FUNCTION();
+  MatrixT **svd_result = decomposition_matrix_svd(matrix, true);
+  uint8_t rank_size = svd_result[1]->size[0];
+  float largest = crealf(svd_result[1]->data[0]);
+  float smallest =
+      crealf(svd_result[1]->data[(rank_size - 1) * (rank_size + 1)]);
+  drop_matrices(svd_result, 3);
+  // singular matrix has infinite condition number
+  if (smallest == 0.0f) {
+    return INFINITY;
+  }
+  return largest / smallest;
+}
@@ -5,9 +5,13 @@
 
 // inlcude
 
+#include "alloc_matrix.h"
+#include "kernel_matrix.h"
 #include "matrix/matrix.h"
 #include "matrix/utils.h"
+#include "profile_matrix.h"
 #include <complex.h>
+#include <math.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -25,18 +29,19 @@ complex float new_complex(float real, float imag) {
 }
 
 MatrixT *new_matrix(uint8_t row, uint8_t col) {
+  PROFILE_FUNCTION();
   // boundary test: size
   if (row == 0 || col == 0) {
     log_error("panic: size must bigger than 0");
     exit(EXIT_FAILURE);
   }
   // malloc: matrix type
-  MatrixT *matrix = malloc(sizeof(MatrixT));
+  MatrixT *matrix = matrix_malloc(sizeof(MatrixT));
   // assign: size
   matrix->size[0] = row;
   matrix->size[1] = col;
   // malloc: matrix data
-  matrix->data = calloc(row * col, sizeof(complex float));
+  matrix->data = matrix_calloc(row * col, sizeof(complex float));
   // assign: set data to zeros
   for (size_t i = 0; i < matrix->size[0] * matrix->size[1]; ++i) {
     matrix->data[i] = new_complex(0.0f, 0.0f);
@@ -46,12 +51,13 @@ MatrixT *new_matrix(uint8_t row, uint8_t col) {
 }
 
 MatrixT *new_identity_matrix(uint8_t row, uint8_t col) {
+  PROFILE_FUNCTION();
   // get an empty matrix
   MatrixT *identity_matrix = new_matrix(row, col);
   // get the size of the diagonal of matrix
   uint8_t matrix_diagonal_size = MIN(row, col);
   // fill the diagonal with <1.0 + 0.0 I>
-  for (uint8_t i = 1; i <= matrix_diagonal_size; ++i) {
+  for (uint16_t i = 1; i <= matrix_diagonal_size; ++i) {
     set_matrix_val(identity_matrix, i, i, new_complex(1.0f, 0.0f));
   }
   // return: identity matrix
@@ -59,6 +65,7 @@ MatrixT *new_identity_matrix(uint8_t row, uint8_t col) {
 }
 
 MatrixT *new_random_real_matrix(uint8_t row, uint8_t col) {
+  PROFILE_FUNCTION();
   srand(time(NULL));
   MatrixT *rand_matrix = new_matrix(row, col);
   for (uint16_t i = 0; i < row * col; ++i) {
@@ -68,6 +75,7 @@ MatrixT *new_random_real_matrix(uint8_t row, uint8_t col) {
 }
 
 MatrixT *new_random_matrix(uint8_t row, uint8_t col) {
+  PROFILE_FUNCTION();
   srand(time(NULL));
   MatrixT *rand_matrix = new_matrix(row, col);
   for (uint16_t i = 0; i < row * col; ++i) {
@@ -77,20 +85,37 @@ MatrixT *new_random_matrix(uint8_t row, uint8_t col) {
   return rand_matrix;
 }
 
+MatrixT *new_random_normal_matrix(uint8_t row, uint8_t col) {
+  PROFILE_FUNCTION();
+  srand(time(NULL));
+  MatrixT *rand_matrix = new_matrix(row, col);
+  const float pi = acosf(-1.0f);
+  // Box-Muller: two uniform numbers in (0, 1] give two standard normal ones
+  for (size_t i = 0; i < (size_t)row * col; i += 2) {
+    float radius = sqrtf(-2.0f * logf(((float)rand() + 1.0f) /
+                                      ((float)RAND_MAX + 1.0f)));
+    float angle = 2.0f * pi * (float)rand() / (float)RAND_MAX;
+    rand_matrix->data[i] = new_complex(radius * cosf(angle), 0.0f);
+    if (i + 1 < (size_t)row * col) {
+      rand_matrix->data[i + 1] = new_complex(radius * sinf(angle), 0.0f);
+    }
+  }
+  return rand_matrix;
+}
+
 MatrixT *new_matrix_from_array(uint8_t row, uint8_t col,
                                MatrixOrientation orientation,
                                const complex float *array) {
+  PROFILE_FUNCTION();
   MatrixT *matrix = new_matrix(row, col);
   if (orientation == ROW) {
     for (size_t i = 0; i < matrix->size[0] * matrix->size[1]; ++i) {
       matrix->data[i] = array[i];
     }
   } else if (orientation == COLUMN) {
-    MatrixT *row_matrix = new_matrix_from_array(row, col, ROW, array);
-    MatrixT *col_matrix = transpose_matrix(row_matrix);
-    drop_matrix(row_matrix);
-    drop_matrix(matrix);
-    matrix = col_matrix;
+    // the array holds the columns one by one, which is the row layout of
+    // the transposed matrix with size (col, row)
+    kernel_transpose(col, row, array, row, matrix->data, col, false);
   } else {
     log_error("panic: illegal argument of orientation: %d", orientation);
     exit(EXIT_FAILURE);
@@ -99,6 +124,7 @@ MatrixT *new_matrix_from_array(uint8_t row, uint8_t col,
 }
 
 MatrixT *new_matrix_from_input() {
+  PROFILE_FUNCTION();
   printf("matrix size: ");
   uint8_t row = 0;
   uint8_t col = 0;
@@ -123,6 +149,7 @@ MatrixT *new_matrix_from_input() {
 }
 
 MatrixT **new_matrix_from_file(const char *file_path, size_t *matrix_number) {
+  PROFILE_FUNCTION();
   // test: open file
   FILE *file_handle = fopen(file_path, "r");
   if (file_handle == NULL) {
@@ -139,32 +166,33 @@ MatrixT **new_matrix_from_file(const char *file_path, size_t *matrix_number) {
   size_t matrices_capacity = 16;
   size_t matrix_cnt = 0;
   bool is_read_matrix = false;
-  MatrixT **matrices = calloc(matrices_capacity, sizeof(MatrixT *));
+  MatrixT **matrices = matrix_calloc(matrices_capacity, sizeof(MatrixT *));
   // init: read buffer
-  char *read_buffer = malloc(file_stat.st_size);
+  char *read_buffer = matrix_malloc(file_stat.st_size);
   // start to read file
   while (fscanf(file_handle, "%[^\n] ", read_buffer) != EOF) {
     // boundary test: matrices capacity
     if (matrix_cnt + 2 > matrices_capacity) {
       matrices_capacity *= 2;
-      matrices = realloc(matrices, matrices_capacity * sizeof(MatrixT *));
+      matrices =
+          matrix_realloc(matrices, matrices_capacity * sizeof(MatrixT *));
     }
     // init: matrix data
     if (strcmp("[matrix]", read_buffer) == 0) {
       is_read_matrix = true;
-      matrices[matrix_cnt] = malloc(sizeof(MatrixT));
+      matrices[matrix_cnt] = matrix_malloc(sizeof(MatrixT));
     } else if (strncmp("size =", read_buffer, strlen("size =")) == 0 &&
                is_read_matrix) {
       // read size infomation
       sscanf(read_buffer, "size = %hhu %hhu", &matrices[matrix_cnt]->size[0],
              &matrices[matrix_cnt]->size[1]);
-      matrices[matrix_cnt]->data =
-          calloc(matrices[matrix_cnt]->size[0] * matrices[matrix_cnt]->size[1],
-                 sizeof(complex float));
+      matrices[matrix_cnt]->data = matrix_calloc(
+          matrices[matrix_cnt]->size[0] * matrices[matrix_cnt]->size[1],
+          sizeof(complex float));
     } else if (strncmp("data =", read_buffer, strlen("data =")) == 0 &&
                is_read_matrix) {
       // read data infomantion
-      char *data_buffer = malloc(file_stat.st_size);
+      char *data_buffer = matrix_malloc(file_stat.st_size);
       sscanf(read_buffer, "data = %[^\n]", data_buffer);
       // clangd can not find `strtok_r`, weired
       char *value_buffer;
@@ -179,7 +207,7 @@ MatrixT **new_matrix_from_file(const char *file_path, size_t *matrix_number) {
         matrices[matrix_cnt]->data[data_cnt++] = new_complex(real, imag);
         value_buffer = strtok(NULL, " ");
       }
-      free(data_buffer);
+      matrix_free(data_buffer);
       is_read_matrix = false;
       matrix_cnt++;
     } else {
@@ -188,7 +216,7 @@ MatrixT **new_matrix_from_file(const char *file_path, size_t *matrix_number) {
     }
   }
   // free read buffer
-  free(read_buffer);
+  matrix_free(read_buffer);
   // close file
   fclose(file_handle);
   // return: matrices
@@ -198,6 +226,7 @@ MatrixT **new_matrix_from_file(const char *file_path, size_t *matrix_number) {
 
 void save_matrix_to_file(const char *file_path, MatrixT **matrices,
                          size_t matrix_number) {
+  PROFILE_FUNCTION();
   // boundary test: null pointer
   if (matrices == NULL) {
     log_error("panic: null pointer error at %s", __func__);
@@ -230,6 +259,7 @@ void save_matrix_to_file(const char *file_path, MatrixT **matrices,
 }
 
 MatrixT *copy_matrix(const MatrixT *matrix) {
+  PROFILE_FUNCTION();
   // boundary test: null pointer
   if (matrix == NULL) {
     log_error("panic: null pointer error at %s", __func__);
@@ -246,21 +276,23 @@ MatrixT *copy_matrix(const MatrixT *matrix) {
 }
 
 extern void drop_matrix(MatrixT *matrix) {
+  PROFILE_FUNCTION();
   // if matrix is null, it's fine
   if (matrix == NULL) {
     return;
   }
   // data of matrix maybe null
   if (matrix->data != NULL) {
-    free(matrix->data);
+    matrix_free(matrix->data);
   }
   // free the matrix
-  free(matrix);
+  matrix_free(matrix);
 }
 
 void drop_matrices(MatrixT **matrices, size_t matrices_number) {
+  PROFILE_FUNCTION();
   for (size_t i = 0; i < matrices_number; ++i) {
     drop_matrix(matrices[i]);
   }
-  free(matrices);
+  matrix_free(matrices);
 }
@@ -0,0 +1,409 @@
+/**
+ * @file matrix/iter_matrix.c
+ * @brief iterative solvers of matrix library
+ */
+
+// include
+
+#include "alloc_matrix.h"
+#include "kernel_matrix.h"
+#include "matrix/matrix.h"
+#include "matrix/matrix_ext.h"
+#include "matrix/matrix_iter.h"
+#include "matrix/utils.h"
+#include "profile_matrix.h"
+#include <complex.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+// functions: helpers
+
+/**
+ * @brief the product of an operator backed by a matrix
+ *
+ * @param[in] x the vector to apply on
+ * @param[out] y the result
+ * @param[in] context the matrix
+ */
+static void apply_matrix(const complex float *x, complex float *y,
+                         void *context) {
+  const MatrixT *matrix = context;
+  kernel_gemv(NO_TRANSPOSE, matrix->size[0], matrix->size[1],
+              new_complex(1.0f, 0.0f), matrix->data, matrix->size[1], x,
+              new_complex(0.0f, 0.0f), y);
+}
+
+/**
+ * @brief check the arguments of a solver, and fill the default options
+ *
+ * @param[in] linear_operator the operator A
+ * @param[in] rhs the right hand side b
+ * @param[in] solution the initial guess
+ * @param[in] option the options given by the caller
+ * @param[in] func_name the name of the solver
+ * @return the options to use
+ */
+static IterativeOptionT check_system(const MatrixOperatorT *linear_operator,
+                                     const complex float *rhs,
+                                     const complex float *solution,
+                                     const IterativeOptionT *option,
+                                     const char *func_name) {
+  // boundary test: null pointer
+  if (linear_operator == NULL || linear_operator->apply == NULL ||
+      rhs == NULL || solution == NULL) {
+    log_error("panic: null pointer error at %s", func_name);
+    exit(EXIT_FAILURE);
+  }
+  IterativeOptionT checked = option == NULL ? new_iterative_option() : *option;
+  // boundary test: compitable size
+  if (checked.preconditioner != NULL &&
+      (checked.preconditioner->apply == NULL ||
+       checked.preconditioner->size != linear_operator->size)) {
+    log_error("panic: preconditioner is not compatible with operator size "
+              "%zu at %s",
+              linear_operator->size, func_name);
+    exit(EXIT_FAILURE);
+  }
+  return checked;
+}
+
+/**
+ * @brief apply the preconditioner y = M^-1 x, or copy \p x without one
+ *
+ * @param[in] preconditioner the preconditioner, NULL for none
+ * @param[in] n the length of the vectors
+ * @param[in] x the vector to apply on
+ * @param[out] y the result
+ */
+static void apply_preconditioner(const MatrixOperatorT *preconditioner,
+                                 size_t n, const complex float *x,
+                                 complex float *y) {
+  if (preconditioner != NULL) {
+    preconditioner->apply(x, y, preconditioner->context);
+    return;
+  }
+  for (size_t i = 0; i < n; ++i) {
+    y[i] = x[i];
+  }
+}
+
+/**
+ * @brief compute the residual r = b - A x
+ *
+ * @param[in] linear_operator the operator A
+ * @param[in] rhs the right hand side b
+ * @param[in] solution the solution x
+ * @param[out] residual the residual r
+ */
+static void compute_residual(const MatrixOperatorT *linear_operator,
+                             const complex float *rhs,
+                             const complex float *solution,
+                             complex float *residual) {
+  linear_operator->apply(solution, residual, linear_operator->context);
+  for (size_t i = 0; i < linear_operator->size; ++i) {
+    residual[i] = rhs[i] - residual[i];
+  }
+}
+
+/**
+ * @brief get the norm of the right hand side, and solve b = 0 directly
+ *
+ * @param[in] n the length of the vectors
+ * @param[in] rhs the right hand side b
+ * @param[out] solution set to zero if \p rhs is zero
+ * @return the norm of \p rhs
+ */
+static float get_rhs_norm(size_t n, const complex float *rhs,
+                          complex float *solution) {
+  float rhs_norm = kernel_norm(n, rhs);
+  if (rhs_norm == 0.0f) {
+    for (size_t i = 0; i < n; ++i) {
+      solution[i] = new_complex(0.0f, 0.0f);
+    }
+  }
+  return rhs_norm;
+}
+
+// functions: operator
+
+MatrixOperatorT new_matrix_operator(const MatrixT *matrix) {
+  // boundary test: null pointer
+  if (matrix == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  // boundary tes: square matrix
+  if (matrix->size[0] != matrix->size[1]) {
+    log_error("panic: matrix must be squared at %s with size (%u, %u)",
+              __func__, matrix->size[0], matrix->size[1]);
+    exit(EXIT_FAILURE);
+  }
+  MatrixOperatorT matrix_operator = {
+      .size = matrix->size[0],
+      .apply = apply_matrix,
+      .context = (void *)matrix,
+  };
+  return matrix_operator;
+}
+
+IterativeOptionT new_iterative_option(void) {
+  IterativeOptionT option = {
+      .max_iter = 1000,
+      .tolerance = 1e-5f,
+      .restart = 30,
+      .preconditioner = NULL,
+  };
+  return option;
+}
+
+// functions: solver
+
+IterativeStatT solve_iterative_cg(const MatrixOperatorT *linear_operator,
+                                  const complex float *rhs,
+                                  complex float *solution,
+                                  const IterativeOptionT *option) {
+  PROFILE_FUNCTION();
+  IterativeOptionT checked =
+      check_system(linear_operator, rhs, solution, option, __func__);
+  size_t n = linear_operator->size;
+  IterativeStatT stat = {.iteration = 0, .residual = 0.0f, .converged = true};
+  float rhs_norm = get_rhs_norm(n, rhs, solution);
+  if (rhs_norm == 0.0f) {
+    return stat;
+  }
+  // init: r = b - A x, z = M^-1 r, p = z
+  complex float *work = matrix_malloc(4 * n * sizeof(complex float));
+  complex float *r = work;
+  complex float *z = work + n;
+  complex float *p = work + 2 * n;
+  complex float *q = work + 3 * n;
+  compute_residual(linear_operator, rhs, solution, r);
+  apply_preconditioner(checked.preconditioner, n, r, z);
+  for (size_t i = 0; i < n; ++i) {
+    p[i] = z[i];
+  }
+  complex float rz = kernel_dot(n, r, true, z);
+  stat.residual = kernel_norm(n, r) / rhs_norm;
+  while (stat.residual > checked.tolerance &&
+         stat.iteration < checked.max_iter) {
+    linear_operator->apply(p, q, linear_operator->context);
+    complex float pq = kernel_dot(n, p, true, q);
+    // breakdown: the operator is not positive definite
+    if (crealf(pq) <= 0.0f) {
+      break;
+    }
+    complex float alpha = rz / pq;
+    kernel_axpy(n, alpha, p, solution);
+    kernel_axpy(n, -alpha, q, r);
+    stat.iteration++;
+    stat.residual = kernel_norm(n, r) / rhs_norm;
+    if (stat.residual <= checked.tolerance) {
+      break;
+    }
+    // p = z + beta p
+    apply_preconditioner(checked.preconditioner, n, r, z);
+    complex float rz_next = kernel_dot(n, r, true, z);
+    kernel_scal(n, rz_next / rz, p);
+    kernel_axpy(n, new_complex(1.0f, 0.0f), z, p);
+    rz = rz_next;
+  }
+  matrix_free(work);
+  stat.converged = stat.residual <= checked.tolerance;
+  return stat;
+}
+
+IterativeStatT solve_iterative_gmres(const MatrixOperatorT *linear_operator,
+                                     const complex float *rhs,
+                                     complex float *solution,
+                                     const IterativeOptionT *option) {
+  PROFILE_FUNCTION();
+  IterativeOptionT checked =
+      check_system(linear_operator, rhs, solution, option, __func__);
+  size_t n = linear_operator->size;
+  IterativeStatT stat = {.iteration = 0, .residual = 0.0f, .converged = true};
+  float rhs_norm = get_rhs_norm(n, rhs, solution);
+  if (rhs_norm == 0.0f) {
+    return stat;
+  }
+  size_t restart = MAX(MIN(checked.restart, n), 1);
+  // init: Krylov basis V, Hessenberg matrix H and Givens rotations
+  complex float *basis =
+      matrix_malloc((restart + 1) * n * sizeof(complex float));
+  complex float *hessenberg =
+      matrix_malloc((restart + 1) * restart * sizeof(complex float));
+  complex float *rotation = matrix_malloc(restart * sizeof(complex float));
+  float *cosine = matrix_malloc(restart * sizeof(float));
+  complex float *g = matrix_malloc((restart + 1) * sizeof(complex float));
+  complex float *w = matrix_malloc(n * sizeof(complex float));
+  complex float *z = matrix_malloc(n * sizeof(complex float));
+  while (true) {
+    // restart from the true residual v(0) = r / |r|
+    compute_residual(linear_operator, rhs, solution, basis);
+    float beta = kernel_norm(n, basis);
+    stat.residual = beta / rhs_norm;
+    if (stat.residual <= checked.tolerance ||
+        stat.iteration >= checked.max_iter) {
+      break;
+    }
+    kernel_scal(n, new_complex(1.0f / beta, 0.0f), basis);
+    for (size_t i = 0; i <= restart; ++i) {
+      g[i] = new_complex(0.0f, 0.0f);
+    }
+    g[0] = new_complex(beta, 0.0f);
+    size_t j = 0;
+    while (j < restart && stat.iteration < checked.max_iter) {
+      complex float *h = hessenberg + j;
+      // w = A M^-1 v(j), orthogonalized by modified Gram-Schmidt
+      apply_preconditioner(checked.preconditioner, n, basis + j * n, z);
+      linear_operator->apply(z, w, linear_operator->context);
+      for (size_t i = 0; i <= j; ++i) {
+        h[i * restart] = kernel_dot(n, basis + i * n, true, w);
+        kernel_axpy(n, -h[i * restart], basis + i * n, w);
+      }
+      float h_next = kernel_norm(n, w);
+      h[(j + 1) * restart] = new_complex(h_next, 0.0f);
+      if (h_next > 0.0f) {
+        for (size_t i = 0; i < n; ++i) {
+          basis[(j + 1) * n + i] = w[i] / h_next;
+        }
+      }
+      // apply the previous rotations to the new column of H
+      for (size_t i = 0; i < j; ++i) {
+        complex float upper = h[i * restart];
+        complex float lower = h[(i + 1) * restart];
+        h[i * restart] = cosine[i] * upper + rotation[i] * lower;
+        h[(i + 1) * restart] = cosine[i] * lower - conjf(rotation[i]) * upper;
+      }
+      // a new rotation eliminates H(j + 1, j)
+      complex float diagonal = h[j * restart];
+      float scale = hypotf(cabsf(diagonal), h_next);
+      if (cabsf(diagonal) == 0.0f) {
+        cosine[j] = 0.0f;
+        rotation[j] = new_complex(1.0f, 0.0f);
+        h[j * restart] = new_complex(h_next, 0.0f);
+      } else {
+        complex float phase = diagonal / cabsf(diagonal);
+        cosine[j] = cabsf(diagonal) / scale;
+        rotation[j] = phase * h_next / scale;
+        h[j * restart] = phase * scale;
+      }
+      h[(j + 1) * restart] = new_complex(0.0f, 0.0f);
+      g[j + 1] = -conjf(rotation[j]) * g[j];
+      g[j] = cosine[j] * g[j];
+      stat.iteration++;
+      j++;
+      stat.residual = cabsf(g[j]) / rhs_norm;
+      // converged, or the Krylov space is invariant
+      if (stat.residual <= checked.tolerance || h_next == 0.0f) {
+        break;
+      }
+    }
+    // x += M^-1 V y with H y = g
+    kernel_trsm(LEFT, UPPER, NO_TRANSPOSE, NON_UNIT, j, 1, hessenberg,
+                restart, g, 1);
+    for (size_t i = 0; i < n; ++i) {
+      w[i] = new_complex(0.0f, 0.0f);
+    }
+    for (size_t i = 0; i < j; ++i) {
+      kernel_axpy(n, g[i], basis + i * n, w);
+    }
+    apply_preconditioner(checked.preconditioner, n, w, z);
+    kernel_axpy(n, new_complex(1.0f, 0.0f), z, solution);
+  }
+  matrix_free(z);
+  matrix_free(w);
+  matrix_free(g);
+  matrix_free(cosine);
+  matrix_free(rotation);
+  matrix_free(hessenberg);
+  matrix_free(basis);
+  stat.converged = stat.residual <= checked.tolerance;
+  return stat;
+}
+
+IterativeStatT solve_iterative_bicgstab(const MatrixOperatorT *linear_operator,
+                                        const complex float *rhs,
+                                        complex float *solution,
+                                        const IterativeOptionT *option) {
+  PROFILE_FUNCTION();
+  IterativeOptionT checked =
+      check_system(linear_operator, rhs, solution, option, __func__);
+  size_t n = linear_operator->size;
+  IterativeStatT stat = {.iteration = 0, .residual = 0.0f, .converged = true};
+  float rhs_norm = get_rhs_norm(n, rhs, solution);
+  if (rhs_norm == 0.0f) {
+    return stat;
+  }
+  // init: r = b - A x, the shadow residual is r(0)
+  complex float *work = matrix_malloc(7 * n * sizeof(complex float));
+  complex float *r = work;
+  complex float *shadow = work + n;
+  complex float *p = work + 2 * n;
+  complex float *v = work + 3 * n;
+  complex float *s = work + 4 * n;
+  complex float *t = work + 5 * n;
+  complex float *z = work + 6 * n;
+  compute_residual(linear_operator, rhs, solution, r);
+  for (size_t i = 0; i < n; ++i) {
+    shadow[i] = r[i];
+    p[i] = new_complex(0.0f, 0.0f);
+    v[i] = new_complex(0.0f, 0.0f);
+  }
+  complex float rho = new_complex(1.0f, 0.0f);
+  complex float alpha = new_complex(1.0f, 0.0f);
+  complex float omega = new_complex(1.0f, 0.0f);
+  stat.residual = kernel_norm(n, r) / rhs_norm;
+  while (stat.residual > checked.tolerance &&
+         stat.iteration < checked.max_iter) {
+    complex float rho_next = kernel_dot(n, shadow, true, r);
+    // breakdown: the shadow residual is orthogonal to r
+    if (rho_next == 0.0f || omega == 0.0f) {
+      break;
+    }
+    // p = r + beta (p - omega v)
+    complex float beta = (rho_next / rho) * (alpha / omega);
+    kernel_axpy(n, -omega, v, p);
+    kernel_scal(n, beta, p);
+    kernel_axpy(n, new_complex(1.0f, 0.0f), r, p);
+    rho = rho_next;
+    // v = A M^-1 p, s = r - alpha v
+    apply_preconditioner(checked.preconditioner, n, p, z);
+    linear_operator->apply(z, v, linear_operator->context);
+    complex float shadow_v = kernel_dot(n, shadow, true, v);
+    if (shadow_v == 0.0f) {
+      break;
+    }
+    alpha = rho / shadow_v;
+    kernel_axpy(n, alpha, z, solution);
+    for (size_t i = 0; i < n; ++i) {
+      s[i] = r[i] - alpha * v[i];
+    }
+    stat.iteration++;
+    stat.residual = kernel_norm(n, s) / rhs_norm;
+    if (stat.residual <= checked.tolerance) {
+      break;
+    }
+    // t = A M^-1 s, omega = <t, s> / <t, t>
+    apply_preconditioner(checked.preconditioner, n, s, z);
+    linear_operator->apply(z, t, linear_operator->context);
+    float t_norm = kernel_norm(n, t);
+    if (t_norm == 0.0f) {
+      break;
+    }
+    omega = kernel_dot(n, t, true, s) / (t_norm * t_norm);
+    kernel_axpy(n, omega, z, solution);
+    for (size_t i = 0; i < n; ++i) {
+      r[i] = s[i] - omega * t[i];
+    }
+    stat.residual = kernel_norm(n, r) / rhs_norm;
+    // breakdown: the recurrence has lost all precision
+    if (!isfinite(stat.residual)) {
+      break;
+    }
+  }
+  matrix_free(work);
+  stat.converged = stat.residual <= checked.tolerance;
+  return stat;
+}
@@ -0,0 +1,1725 @@
+/**
+ * @file matrix/kernel_matrix.c
+ * @brief internal computing kernels of matrix library
+ */
+
+// include
+
+#include "alloc_matrix.h"
+#include "kernel_matrix.h"
+#include "matrix/matrix.h"
+#include "matrix/matrix_ext.h"
+#include "matrix/matrix_tune.h"
+#include "matrix/utils.h"
+#include "profile_matrix.h"
+#include <complex.h>
+#include <float.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+// constants: block sizes
+
+/**
+ * \def TRANSPOSE_TILE
+ *
+ * edge of the leaf tile of transposition, a row of the tile
+ * (8 complex float) fills exactly one 64 bytes cache line
+ */
+#define TRANSPOSE_TILE 8
+
+/**
+ * \def GEMM_STACK_PANEL
+ *
+ * the number of values of a panel of op(B) kept on the stack (64 KiB), the
+ * larger panels of tuned block sizes are allocated
+ */
+#define GEMM_STACK_PANEL 8192
+
+/**
+ * \def TRIANGLE_BLOCK
+ *
+ * size of the diagonal blocks of triangular kernels, the off-diagonal
+ * parts are handed to the multiplication kernel
+ */
+#define TRIANGLE_BLOCK 32
+
+/**
+ * \def JACOBI_MAX_SWEEP
+ *
+ * maximum sweeps of the one-sided Jacobi method, it converges
+ * quadratically and needs far fewer sweeps in practice
+ */
+#define JACOBI_MAX_SWEEP 64
+
+/**
+ * \def DOT_BLOCK
+ *
+ * length of the blocks of a long dot product which are summed in single
+ * precision
+ */
+#define DOT_BLOCK 256
+
+// functions: helpers
+
+/**
+ * @brief multiply two complex numbers without the infinity recovery of
+ *        Annex G, which would otherwise become a libcall
+ *
+ * @param[in] lhs the left hand side value
+ * @param[in] rhs the right hand side value
+ * @return the product of \p lhs and \p rhs
+ */
+static inline complex float complex_mul(complex float lhs, complex float rhs) {
+  float lr = crealf(lhs);
+  float li = cimagf(lhs);
+  float rr = crealf(rhs);
+  float ri = cimagf(rhs);
+  return __builtin_complex(lr * rr - li * ri, lr * ri + li * rr);
+}
+
+/**
+ * @brief get a value of an operand with an operation applied
+ *
+ * @param[in] op the operation applied to \p data
+ * @param[in] data the operand
+ * @param[in] ld the leading dimension of \p data
+ * @param[in] row the row of op( \p data )
+ * @param[in] col the column of op( \p data )
+ * @return the value at ( \p row, \p col ) of op( \p data )
+ */
+static inline complex float get_op_val(MatrixOperation op,
+                                       const complex float *data, size_t ld,
+                                       size_t row, size_t col) {
+  if (op == NO_TRANSPOSE) {
+    return data[row * ld + col];
+  }
+  if (op == TRANSPOSE) {
+    return data[col * ld + row];
+  }
+  return conjf(data[col * ld + row]);
+}
+
+/**
+ * @brief update a row with four scaled rows y += sum(alpha_i op(x_i)), the
+ *        values are handled as pairs of floats so that the loop vectorizes
+ *
+ * @param[in] n the length of the rows
+ * @param[in] alpha the four scalars
+ * @param[in] x the four rows to add
+ * @param[in] conjugate conjugate the rows \p x before adding
+ * @param[in,out] y the row to update
+ */
+static void row_axpy4(size_t n, const complex float alpha[4],
+                      const complex float *x[4], bool conjugate,
+                      complex float *y) {
+  // conj(x) = (xr, -xi), fold the sign into the coefficients
+  float sign = conjugate ? -1.0f : 1.0f;
+  float ar[4];
+  float ai[4];
+  float sr[4];
+  float si[4];
+  const float *xf[4];
+  for (size_t i = 0; i < 4; ++i) {
+    ar[i] = crealf(alpha[i]);
+    ai[i] = cimagf(alpha[i]);
+    sr[i] = sign * ar[i];
+    si[i] = sign * ai[i];
+    xf[i] = (const float *)x[i];
+  }
+  float *yf = (float *)y;
+  for (size_t j = 0; j < 2 * n; j += 2) {
+    float re = yf[j];
+    float im = yf[j + 1];
+    for (size_t i = 0; i < 4; ++i) {
+      re += ar[i] * xf[i][j] - si[i] * xf[i][j + 1];
+      im += sr[i] * xf[i][j + 1] + ai[i] * xf[i][j];
+    }
+    yf[j] = re;
+    yf[j + 1] = im;
+  }
+}
+
+/**
+ * @brief update a row with a scaled row y += alpha op(x)
+ *
+ * @param[in] n the length of the rows
+ * @param[in] alpha the scalar
+ * @param[in] x the row to add
+ * @param[in] conjugate conjugate the row \p x before adding
+ * @param[in,out] y the row to update
+ */
+static void row_axpy(size_t n, complex float alpha, const complex float *x,
+                     bool conjugate, complex float *y) {
+  float sign = conjugate ? -1.0f : 1.0f;
+  float ar = crealf(alpha);
+  float ai = cimagf(alpha);
+  float sr = sign * ar;
+  float si = sign * ai;
+  const float *xf = (const float *)x;
+  float *yf = (float *)y;
+  for (size_t j = 0; j < 2 * n; j += 2) {
+    yf[j] += ar * xf[j] - si * xf[j + 1];
+    yf[j + 1] += sr * xf[j + 1] + ai * xf[j];
+  }
+}
+
+/**
+ * @brief get the dot products of four rows with the same row
+ *        sum(op(x_i) y), \p y is loaded once for all rows
+ *
+ * @param[in] n the length of the rows
+ * @param[in] x the four rows
+ * @param[in] conjugate conjugate the rows \p x
+ * @param[in] y the shared row
+ * @param[out] dot the four dot products
+ */
+static void row_dot4(size_t n, const complex float *x[4], bool conjugate,
+                     const complex float *y, complex float dot[4]) {
+  float sign = conjugate ? -1.0f : 1.0f;
+  float re[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+  float im[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+  const float *xf[4];
+  for (size_t i = 0; i < 4; ++i) {
+    xf[i] = (const float *)x[i];
+  }
+  const float *yf = (const float *)y;
+  for (size_t j = 0; j < 2 * n; j += 2) {
+    for (size_t i = 0; i < 4; ++i) {
+      re[i] += xf[i][j] * yf[j] - sign * xf[i][j + 1] * yf[j + 1];
+      im[i] += xf[i][j] * yf[j + 1] + sign * xf[i][j + 1] * yf[j];
+    }
+  }
+  for (size_t i = 0; i < 4; ++i) {
+    dot[i] = __builtin_complex(re[i], im[i]);
+  }
+}
+
+/**
+ * @brief get the dot product of two rows sum(op(x) y)
+ *
+ * @param[in] n the length of the rows
+ * @param[in] x the left hand side row
+ * @param[in] conjugate conjugate the row \p x
+ * @param[in] y the right hand side row
+ * @return the dot product
+ */
+static complex float row_dot(size_t n, const complex float *x, bool conjugate,
+                             const complex float *y) {
+  float sign = conjugate ? -1.0f : 1.0f;
+  float re = 0.0f;
+  float im = 0.0f;
+  const float *xf = (const float *)x;
+  const float *yf = (const float *)y;
+  for (size_t j = 0; j < 2 * n; j += 2) {
+    re += xf[j] * yf[j] - sign * xf[j + 1] * yf[j + 1];
+    im += xf[j] * yf[j + 1] + sign * xf[j + 1] * yf[j];
+  }
+  return __builtin_complex(re, im);
+}
+
+/**
+ * @brief scale a block C = beta C, a zero \p beta clears the block
+ *
+ * @param[in] m the row size of \p c
+ * @param[in] n the column size of \p c
+ * @param[in] beta the scalar
+ * @param[in,out] c the block to scale
+ * @param[in] ldc the leading dimension of \p c
+ */
+static void scale_block(size_t m, size_t n, complex float beta,
+                        complex float *c, size_t ldc) {
+  if (beta == 1.0f) {
+    return;
+  }
+  for (size_t i = 0; i < m; ++i) {
+    for (size_t j = 0; j < n; ++j) {
+      c[i * ldc + j] =
+          beta == 0.0f ? 0.0f : complex_mul(beta, c[i * ldc + j]);
+    }
+  }
+}
+
+/**
+ * @brief split a dimension of a block at a multiple of the tile size
+ *
+ * @param[in] size the dimension to split (bigger than the tile size)
+ * @return the size of the first half
+ */
+static size_t split_at_tile(size_t size) {
+  return (size / 2 + TRANSPOSE_TILE - 1) / TRANSPOSE_TILE * TRANSPOSE_TILE;
+}
+
+/**
+ * @brief transpose a full tile, the fixed bounds let the compiler unroll
+ *        and vectorize the loops
+ *
+ * @param[in] src the source tile
+ * @param[in] lds the leading dimension of \p src
+ * @param[out] dst the destination tile
+ * @param[in] ldd the leading dimension of \p dst
+ * @param[in] conjugate conjugate the values while transposing
+ */
+static void transpose_full_tile(const complex float *src, size_t lds,
+                                complex float *dst, size_t ldd,
+                                bool conjugate) {
+  complex float tile[TRANSPOSE_TILE][TRANSPOSE_TILE];
+  // load: rows of source are contiguous
+  for (size_t i = 0; i < TRANSPOSE_TILE; ++i) {
+    for (size_t j = 0; j < TRANSPOSE_TILE; ++j) {
+      tile[j][i] = src[i * lds + j];
+    }
+  }
+  // store: rows of destination are contiguous
+  if (conjugate) {
+    for (size_t i = 0; i < TRANSPOSE_TILE; ++i) {
+      for (size_t j = 0; j < TRANSPOSE_TILE; ++j) {
+        dst[i * ldd + j] = conjf(tile[i][j]);
+      }
+    }
+  } else {
+    for (size_t i = 0; i < TRANSPOSE_TILE; ++i) {
+      for (size_t j = 0; j < TRANSPOSE_TILE; ++j) {
+        dst[i * ldd + j] = tile[i][j];
+      }
+    }
+  }
+}
+
+/**
+ * @brief transpose a block which is not bigger than a tile
+ *
+ * @param[in] row the row size of the source block
+ * @param[in] col the column size of the source block
+ * @param[in] src the source block
+ * @param[in] lds the leading dimension of \p src
+ * @param[out] dst the destination block
+ * @param[in] ldd the leading dimension of \p dst
+ * @param[in] conjugate conjugate the values while transposing
+ */
+static void transpose_leaf(size_t row, size_t col, const complex float *src,
+                           size_t lds, complex float *dst, size_t ldd,
+                           bool conjugate) {
+  if (row == TRANSPOSE_TILE && col == TRANSPOSE_TILE) {
+    transpose_full_tile(src, lds, dst, ldd, conjugate);
+    return;
+  }
+  for (size_t i = 0; i < row; ++i) {
+    for (size_t j = 0; j < col; ++j) {
+      complex float val = src[i * lds + j];
+      dst[j * ldd + i] = conjugate ? conjf(val) : val;
+    }
+  }
+}
+
+/**
+ * @brief transpose a block which is not bigger than a leaf tile by tile
+ *
+ * @param[in] row the row size of the source block
+ * @param[in] col the column size of the source block
+ * @param[in] src the source block
+ * @param[in] lds the leading dimension of \p src
+ * @param[out] dst the destination block
+ * @param[in] ldd the leading dimension of \p dst
+ * @param[in] conjugate conjugate the values while transposing
+ */
+static void transpose_tiles(size_t row, size_t col, const complex float *src,
+                            size_t lds, complex float *dst, size_t ldd,
+                            bool conjugate) {
+  for (size_t i = 0; i < row; i += TRANSPOSE_TILE) {
+    for (size_t j = 0; j < col; j += TRANSPOSE_TILE) {
+      transpose_leaf(MIN(TRANSPOSE_TILE, row - i),
+                     MIN(TRANSPOSE_TILE, col - j), src + i * lds + j, lds,
+                     dst + j * ldd + i, ldd, conjugate);
+    }
+  }
+}
+
+/**
+ * @brief get the leaf size of the transposition from the tuned block sizes
+ *
+ * @return the leaf size, a multiple of the tile
+ */
+static size_t get_transpose_leaf(void) {
+  size_t leaf = get_matrix_block().transpose_leaf;
+  return MAX(leaf / TRANSPOSE_TILE, 1) * TRANSPOSE_TILE;
+}
+
+/**
+ * @brief exchange a block with the transpose of its mirror block
+ *
+ * @param[in] leaf the size at which the recursion stops
+ * @param[in] row the row size of \p upper
+ * @param[in] col the column size of \p upper
+ * @param[in,out] upper the block with size ( \p row, \p col )
+ * @param[in,out] lower the block with size ( \p col, \p row )
+ * @param[in] ld the leading dimension of both blocks
+ * @param[in] conjugate conjugate the values while transposing
+ */
+static void swap_transpose(size_t leaf, size_t row, size_t col,
+                           complex float *upper, complex float *lower,
+                           size_t ld, bool conjugate) {
+  if (row > leaf && row >= col) {
+    size_t half = split_at_tile(row);
+    swap_transpose(leaf, half, col, upper, lower, ld, conjugate);
+    swap_transpose(leaf, row - half, col, upper + half * ld, lower + half, ld,
+                   conjugate);
+    return;
+  }
+  if (col > leaf) {
+    size_t half = split_at_tile(col);
+    swap_transpose(leaf, row, half, upper, lower, ld, conjugate);
+    swap_transpose(leaf, row, col - half, upper + half, lower + half * ld, ld,
+                   conjugate);
+    return;
+  }
+  for (size_t i = 0; i < row; ++i) {
+    for (size_t j = 0; j < col; ++j) {
+      complex float val = upper[i * ld + j];
+      upper[i * ld + j] =
+          conjugate ? conjf(lower[j * ld + i]) : lower[j * ld + i];
+      lower[j * ld + i] = conjugate ? conjf(val) : val;
+    }
+  }
+}
+
+// functions: transpose
+
+/**
+ * @brief transpose a block by halving the longer side until it fits a leaf
+ *
+ * @param[in] leaf the size at which the recursion stops
+ */
+static void transpose_recursive(size_t leaf, size_t row, size_t col,
+                                const complex float *src, size_t lds,
+                                complex float *dst, size_t ldd,
+                                bool conjugate) {
+  if (row > leaf && row >= col) {
+    size_t half = split_at_tile(row);
+    transpose_recursive(leaf, half, col, src, lds, dst, ldd, conjugate);
+    transpose_recursive(leaf, row - half, col, src + half * lds, lds,
+                        dst + half, ldd, conjugate);
+  } else if (col > leaf) {
+    size_t half = split_at_tile(col);
+    transpose_recursive(leaf, row, half, src, lds, dst, ldd, conjugate);
+    transpose_recursive(leaf, row, col - half, src + half, lds,
+                        dst + half * ldd, ldd, conjugate);
+  } else {
+    transpose_tiles(row, col, src, lds, dst, ldd, conjugate);
+  }
+}
+
+/**
+ * @brief transpose a square block in place by transposing the diagonal
+ *        blocks and exchanging the off-diagonal ones
+ *
+ * @param[in] leaf the size at which the recursion stops
+ */
+static void transpose_in_place_recursive(size_t leaf, size_t size,
+                                         complex float *data, size_t ld,
+                                         bool conjugate) {
+  if (size > leaf) {
+    size_t half = split_at_tile(size);
+    transpose_in_place_recursive(leaf, half, data, ld, conjugate);
+    transpose_in_place_recursive(leaf, size - half, data + half * ld + half,
+                                 ld, conjugate);
+    swap_transpose(leaf, half, size - half, data + half, data + half * ld, ld,
+                   conjugate);
+    return;
+  }
+  for (size_t i = 0; i < size; ++i) {
+    if (conjugate) {
+      data[i * ld + i] = conjf(data[i * ld + i]);
+    }
+    for (size_t j = i + 1; j < size; ++j) {
+      complex float val = data[i * ld + j];
+      data[i * ld + j] = conjugate ? conjf(data[j * ld + i]) : data[j * ld + i];
+      data[j * ld + i] = conjugate ? conjf(val) : val;
+    }
+  }
+}
+
+void kernel_transpose(size_t row, size_t col, const complex float *src,
+                      size_t lds, complex float *dst, size_t ldd,
+                      bool conjugate) {
+  // cache oblivious: halve the longer side until the block fits a leaf
+  transpose_recursive(get_transpose_leaf(), row, col, src, lds, dst, ldd,
+                      conjugate);
+}
+
+void kernel_transpose_in_place(size_t size, complex float *data, size_t ld,
+                               bool conjugate) {
+  transpose_in_place_recursive(get_transpose_leaf(), size, data, ld,
+                               conjugate);
+}
+
+// functions: multiplication
+
+/**
+ * @brief C = alpha op(A) op(B) + beta C by panels of op(B), the classical
+ *        product under the Strassen-Winograd layer
+ */
+static void gemm_blocked(MatrixOperation lop, MatrixOperation rop, size_t m,
+                         size_t n, size_t k, complex float alpha,
+                         const complex float *a, size_t lda,
+                         const complex float *b, size_t ldb,
+                         complex float beta, complex float *c, size_t ldc) {
+  scale_block(m, n, beta, c, ldc);
+  if (k == 0 || alpha == 0.0f) {
+    return;
+  }
+  PROFILE_FLOP(8 * m * n * k);
+  MatrixBlockT block = get_matrix_block();
+  size_t block_k = MAX(block.gemm_k, 1);
+  size_t block_n = MAX(block.gemm_n, 1);
+  // panel of op(B), only used when B is not read row by row
+  complex float stack_panel[GEMM_STACK_PANEL];
+  complex float *panel = stack_panel;
+  if (rop != NO_TRANSPOSE && block_k * block_n > GEMM_STACK_PANEL) {
+    panel = matrix_malloc(block_k * block_n * sizeof(complex float));
+  }
+  for (size_t jc = 0; jc < n; jc += block_n) {
+    size_t nc = MIN(block_n, n - jc);
+    for (size_t pc = 0; pc < k; pc += block_k) {
+      size_t kc = MIN(block_k, k - pc);
+      // locate rows of op(B) in the panel
+      const complex float *bp = b + pc * ldb + jc;
+      size_t ldp = ldb;
+      if (rop != NO_TRANSPOSE) {
+        kernel_transpose(nc, kc, b + jc * ldb + pc, ldb, panel, nc,
+                         rop == CONJUGATE_TRANSPOSE);
+        bp = panel;
+        ldp = nc;
+      }
+      // C(i, :) += alpha op(A)(i, p) op(B)(p, :)
+      for (size_t i = 0; i < m; ++i) {
+        complex float *crow = c + i * ldc + jc;
+        size_t p = 0;
+        for (; p + 4 <= kc; p += 4) {
+          complex float scalars[4];
+          const complex float *rows[4];
+          for (size_t q = 0; q < 4; ++q) {
+            scalars[q] =
+                complex_mul(alpha, get_op_val(lop, a, lda, i, pc + p + q));
+            rows[q] = bp + (p + q) * ldp;
+          }
+          row_axpy4(nc, scalars, rows, false, crow);
+        }
+        for (; p < kc; ++p) {
+          complex float scalar =
+              complex_mul(alpha, get_op_val(lop, a, lda, i, pc + p));
+          row_axpy(nc, scalar, bp + p * ldp, false, crow);
+        }
+      }
+    }
+  }
+  if (panel != stack_panel) {
+    matrix_free(panel);
+  }
+}
+
+/**
+ * @brief update a real row with four scaled rows y += sum(alpha_i x_i)
+ *
+ * @param[in] n the length of the rows
+ * @param[in] alpha the four scalars
+ * @param[in] x the four rows to add
+ * @param[in,out] y the row to update
+ */
+static void real_row_axpy4(size_t n, const float alpha[4], const float *x[4],
+                           float *y) {
+  for (size_t j = 0; j < n; ++j) {
+    y[j] += alpha[0] * x[0][j] + alpha[1] * x[1][j] + alpha[2] * x[2][j] +
+            alpha[3] * x[3][j];
+  }
+}
+
+/**
+ * @brief check whether a product is done by the 3M method
+ *
+ * @param[in] m the row size of C
+ * @param[in] n the column size of C
+ * @param[in] k the inner size
+ * @return true if 3M is enabled and all sizes are above its cutoff
+ */
+static bool is_3m_size(size_t m, size_t n, size_t k) {
+  MatrixGemm3mT option = get_matrix_gemm_3m();
+  return option.enable && MIN(MIN(m, n), k) > option.cutoff;
+}
+
+/**
+ * @brief split op(X) into its real and imaginary parts
+ *
+ * @param[in] op the operation applied to \p x
+ * @param[in] row the row size of op( \p x )
+ * @param[in] col the column size of op( \p x )
+ * @param[in] x the block
+ * @param[in] ldx the leading dimension of \p x
+ * @param[out] real the real part with size ( \p row, \p col )
+ * @param[out] imag the imaginary part with size ( \p row, \p col )
+ */
+static void split_block(MatrixOperation op, size_t row, size_t col,
+                        const complex float *x, size_t ldx, float *real,
+                        float *imag) {
+  for (size_t i = 0; i < row; ++i) {
+    for (size_t j = 0; j < col; ++j) {
+      complex float value = get_op_val(op, x, ldx, i, j);
+      real[i * col + j] = crealf(value);
+      imag[i * col + j] = cimagf(value);
+    }
+  }
+}
+
+/**
+ * @brief C = alpha op(A) op(B) + beta C by the 3M method of Gauss with three
+ *        real products T1 = Ar Br, T2 = Ai Bi and T3 = (Ar + Ai)(Br + Bi),
+ *        then Re(AB) = T1 - T2 and Im(AB) = T3 - T1 - T2
+ */
+static void gemm_3m(MatrixOperation lop, MatrixOperation rop, size_t m,
+                    size_t n, size_t k, complex float alpha,
+                    const complex float *a, size_t lda,
+                    const complex float *b, size_t ldb, complex float beta,
+                    complex float *c, size_t ldc) {
+  // init: the parts of op(A) and op(B), then the three products
+  float *ar = matrix_malloc((2 * m * k + 2 * k * n + 3 * m * n) *
+                            sizeof(float));
+  float *ai = ar + m * k;
+  float *br = ai + m * k;
+  float *bi = br + k * n;
+  float *t1 = bi + k * n;
+  float *t2 = t1 + m * n;
+  float *t3 = t2 + m * n;
+  split_block(lop, m, k, a, lda, ar, ai);
+  split_block(rop, k, n, b, ldb, br, bi);
+  kernel_real_gemm(m, n, k, 1.0f, ar, k, br, n, 0.0f, t1, n);
+  kernel_real_gemm(m, n, k, 1.0f, ai, k, bi, n, 0.0f, t2, n);
+  // the sums overwrite the real parts which are no longer used
+  for (size_t i = 0; i < m * k; ++i) {
+    ar[i] += ai[i];
+  }
+  for (size_t i = 0; i < k * n; ++i) {
+    br[i] += bi[i];
+  }
+  kernel_real_gemm(m, n, k, 1.0f, ar, k, br, n, 0.0f, t3, n);
+  for (size_t i = 0; i < m; ++i) {
+    for (size_t j = 0; j < n; ++j) {
+      size_t t = i * n + j;
+      complex float value = complex_mul(
+          alpha, __builtin_complex(t1[t] - t2[t], t3[t] - t1[t] - t2[t]));
+      complex float *entry = c + i * ldc + j;
+      *entry = beta == 0.0f ? value : value + complex_mul(beta, *entry);
+    }
+  }
+  matrix_free(ar);
+}
+
+/**
+ * @brief C = alpha op(A) op(B) + beta C by the classical product, either
+ *        directly or by the 3M method
+ */
+static void gemm_classical(MatrixOperation lop, MatrixOperation rop, size_t m,
+                           size_t n, size_t k, complex float alpha,
+                           const complex float *a, size_t lda,
+                           const complex float *b, size_t ldb,
+                           complex float beta, complex float *c, size_t ldc) {
+  if (alpha != 0.0f && is_3m_size(m, n, k)) {
+    gemm_3m(lop, rop, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+    return;
+  }
+  gemm_blocked(lop, rop, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+}
+
+/**
+ * @brief check whether a product is split by Strassen-Winograd
+ *
+ * @param[in] m the row size of C
+ * @param[in] n the column size of C
+ * @param[in] k the inner size
+ * @param[in] cutoff the size at which the recursion stops
+ * @return true if all sizes are above \p cutoff
+ */
+static bool is_strassen_size(size_t m, size_t n, size_t k, size_t cutoff) {
+  return MIN(MIN(m, n), k) > MAX(cutoff, 1);
+}
+
+/**
+ * @brief get the workspace of Strassen-Winograd, every level needs X with
+ *        (m/2, max(k/2, n/2)) and Y with (k/2, n/2), the seven products of
+ *        a level run one by one and share the workspace below
+ *
+ * @return the number of elements
+ */
+static size_t get_strassen_workspace(size_t m, size_t n, size_t k,
+                                     size_t cutoff) {
+  if (!is_strassen_size(m, n, k, cutoff)) {
+    return 0;
+  }
+  size_t m2 = m / 2;
+  size_t n2 = n / 2;
+  size_t k2 = k / 2;
+  return m2 * MAX(k2, n2) + k2 * n2 +
+         get_strassen_workspace(m2, n2, k2, cutoff);
+}
+
+/**
+ * @brief Z = X + Y or Z = X - Y of blocks, Z can be X or Y
+ */
+static void add_block(size_t m, size_t n, const complex float *x, size_t ldx,
+                      const complex float *y, size_t ldy, bool subtract,
+                      complex float *z, size_t ldz) {
+  for (size_t i = 0; i < m; ++i) {
+    const complex float *xrow = x + i * ldx;
+    const complex float *yrow = y + i * ldy;
+    complex float *zrow = z + i * ldz;
+    if (subtract) {
+      for (size_t j = 0; j < n; ++j) {
+        zrow[j] = xrow[j] - yrow[j];
+      }
+    } else {
+      for (size_t j = 0; j < n; ++j) {
+        zrow[j] = xrow[j] + yrow[j];
+      }
+    }
+  }
+}
+
+/**
+ * @brief C = A B by the Winograd variant of Strassen, the even part is
+ *        split into quadrants with 7 products and 15 additions by the
+ *        schedule of Boyer, Dumas, Pernet and Zhou (2009) which only needs
+ *        the two temporaries X and Y, an odd row, column or inner index is
+ *        peeled off and done by the classical product
+ *
+ * @param[in] work the workspace from get_strassen_workspace()
+ */
+static void strassen_gemm(size_t m, size_t n, size_t k,
+                          const complex float *a, size_t lda,
+                          const complex float *b, size_t ldb, complex float *c,
+                          size_t ldc, complex float *work, size_t cutoff) {
+  const complex float one = 1.0f;
+  const complex float zero = 0.0f;
+  if (!is_strassen_size(m, n, k, cutoff)) {
+    gemm_classical(NO_TRANSPOSE, NO_TRANSPOSE, m, n, k, one, a, lda, b, ldb,
+                   zero, c, ldc);
+    return;
+  }
+  size_t m2 = m / 2;
+  size_t n2 = n / 2;
+  size_t k2 = k / 2;
+  const complex float *a11 = a;
+  const complex float *a12 = a + k2;
+  const complex float *a21 = a + m2 * lda;
+  const complex float *a22 = a21 + k2;
+  const complex float *b11 = b;
+  const complex float *b12 = b + n2;
+  const complex float *b21 = b + k2 * ldb;
+  const complex float *b22 = b21 + n2;
+  complex float *c11 = c;
+  complex float *c12 = c + n2;
+  complex float *c21 = c + m2 * ldc;
+  complex float *c22 = c21 + n2;
+  // X holds S with (m2, k2) or P1 with (m2, n2), Y holds T with (k2, n2)
+  complex float *x = work;
+  complex float *y = x + m2 * MAX(k2, n2);
+  complex float *next = y + k2 * n2;
+  // S3 = A11 - A21, T3 = B22 - B12, P7 = S3 T3 in C21
+  add_block(m2, k2, a11, lda, a21, lda, true, x, k2);
+  add_block(k2, n2, b22, ldb, b12, ldb, true, y, n2);
+  strassen_gemm(m2, n2, k2, x, k2, y, n2, c21, ldc, next, cutoff);
+  // S1 = A21 + A22, T1 = B12 - B11, P5 = S1 T1 in C22
+  add_block(m2, k2, a21, lda, a22, lda, false, x, k2);
+  add_block(k2, n2, b12, ldb, b11, ldb, true, y, n2);
+  strassen_gemm(m2, n2, k2, x, k2, y, n2, c22, ldc, next, cutoff);
+  // S2 = S1 - A11, T2 = B22 - T1, P6 = S2 T2 in C12
+  add_block(m2, k2, x, k2, a11, lda, true, x, k2);
+  add_block(k2, n2, b22, ldb, y, n2, true, y, n2);
+  strassen_gemm(m2, n2, k2, x, k2, y, n2, c12, ldc, next, cutoff);
+  // S4 = A12 - S2, T4 = T2 - B21, P3 = S4 B22 in C11
+  add_block(m2, k2, a12, lda, x, k2, true, x, k2);
+  add_block(k2, n2, y, n2, b21, ldb, true, y, n2);
+  strassen_gemm(m2, n2, k2, x, k2, b22, ldb, c11, ldc, next, cutoff);
+  // P1 = A11 B11 in X
+  strassen_gemm(m2, n2, k2, a11, lda, b11, ldb, x, n2, next, cutoff);
+  // U2 = P1 + P6 in C12, U3 = U2 + P7 in C21, U4 = U2 + P5 in C12
+  add_block(m2, n2, x, n2, c12, ldc, false, c12, ldc);
+  add_block(m2, n2, c12, ldc, c21, ldc, false, c21, ldc);
+  add_block(m2, n2, c12, ldc, c22, ldc, false, c12, ldc);
+  // U7 = U3 + P5 in C22, U5 = U4 + P3 in C12
+  add_block(m2, n2, c21, ldc, c22, ldc, false, c22, ldc);
+  add_block(m2, n2, c12, ldc, c11, ldc, false, c12, ldc);
+  // P4 = A22 T4 in C11, U6 = U3 - P4 in C21
+  strassen_gemm(m2, n2, k2, a22, lda, y, n2, c11, ldc, next, cutoff);
+  add_block(m2, n2, c21, ldc, c11, ldc, true, c21, ldc);
+  // P2 = A12 B21 in C11, U1 = P1 + P2 in C11
+  strassen_gemm(m2, n2, k2, a12, lda, b21, ldb, c11, ldc, next, cutoff);
+  add_block(m2, n2, x, n2, c11, ldc, false, c11, ldc);
+  // peel: the last inner index, column and row
+  if (IS_ODD(k)) {
+    gemm_blocked(NO_TRANSPOSE, NO_TRANSPOSE, 2 * m2, 2 * n2, 1, one,
+                 a + k - 1, lda, b + (k - 1) * ldb, ldb, one, c, ldc);
+  }
+  if (IS_ODD(n)) {
+    gemm_blocked(NO_TRANSPOSE, NO_TRANSPOSE, 2 * m2, 1, k, one, a, lda,
+                 b + n - 1, ldb, zero, c + n - 1, ldc);
+  }
+  if (IS_ODD(m)) {
+    gemm_blocked(NO_TRANSPOSE, NO_TRANSPOSE, 1, n, k, one, a + (m - 1) * lda,
+                 lda, b, ldb, zero, c + (m - 1) * ldc, ldc);
+  }
+}
+
+void kernel_gemm(MatrixOperation lop, MatrixOperation rop, size_t m, size_t n,
+                 size_t k, complex float alpha, const complex float *a,
+                 size_t lda, const complex float *b, size_t ldb,
+                 complex float beta, complex float *c, size_t ldc) {
+  MatrixStrassenT strassen = get_matrix_strassen();
+  // Strassen-Winograd is only used for plain products C = A B
+  if (strassen.enable && lop == NO_TRANSPOSE && rop == NO_TRANSPOSE &&
+      alpha == 1.0f && beta == 0.0f &&
+      is_strassen_size(m, n, k, strassen.cutoff)) {
+    complex float *work = matrix_malloc(
+        get_strassen_workspace(m, n, k, strassen.cutoff) *
+        sizeof(complex float));
+    strassen_gemm(m, n, k, a, lda, b, ldb, c, ldc, work, strassen.cutoff);
+    matrix_free(work);
+    return;
+  }
+  gemm_classical(lop, rop, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+}
+
+void kernel_real_gemm(size_t m, size_t n, size_t k, float alpha,
+                      const float *a, size_t lda, const float *b, size_t ldb,
+                      float beta, float *c, size_t ldc) {
+  for (size_t i = 0; i < m && beta != 1.0f; ++i) {
+    for (size_t j = 0; j < n; ++j) {
+      c[i * ldc + j] = beta == 0.0f ? 0.0f : beta * c[i * ldc + j];
+    }
+  }
+  if (k == 0 || alpha == 0.0f) {
+    return;
+  }
+  PROFILE_FLOP(2 * m * n * k);
+  // the panels of B have the same bytes as the ones of gemm_blocked()
+  MatrixBlockT block = get_matrix_block();
+  size_t block_k = MAX(block.gemm_k, 1);
+  size_t block_n = 2 * MAX(block.gemm_n, 1);
+  for (size_t jc = 0; jc < n; jc += block_n) {
+    size_t nc = MIN(block_n, n - jc);
+    for (size_t pc = 0; pc < k; pc += block_k) {
+      size_t kc = MIN(block_k, k - pc);
+      for (size_t i = 0; i < m; ++i) {
+        float *crow = c + i * ldc + jc;
+        const float *arow = a + i * lda + pc;
+        const float *bp = b + pc * ldb + jc;
+        size_t p = 0;
+        for (; p + 4 <= kc; p += 4) {
+          float scalars[4] = {alpha * arow[p], alpha * arow[p + 1],
+                              alpha * arow[p + 2], alpha * arow[p + 3]};
+          const float *rows[4] = {bp + p * ldb, bp + (p + 1) * ldb,
+                                  bp + (p + 2) * ldb, bp + (p + 3) * ldb};
+          real_row_axpy4(nc, scalars, rows, crow);
+        }
+        for (; p < kc; ++p) {
+          float scalar = alpha * arow[p];
+          for (size_t j = 0; j < nc; ++j) {
+            crow[j] += scalar * bp[p * ldb + j];
+          }
+        }
+      }
+    }
+  }
+}
+
+void kernel_gemv(MatrixOperation op, size_t m, size_t n, complex float alpha,
+                 const complex float *a, size_t lda, const complex float *x,
+                 complex float beta, complex float *y) {
+  size_t y_len = op == NO_TRANSPOSE ? m : n;
+  scale_block(1, y_len, beta, y, y_len);
+  if (alpha == 0.0f) {
+    return;
+  }
+  PROFILE_FLOP(8 * m * n);
+  size_t i = 0;
+  if (op == NO_TRANSPOSE) {
+    // y(i) += alpha A(i, :) x, four rows share every load of x
+    for (; i + 4 <= m; i += 4) {
+      const complex float *rows[4] = {a + i * lda, a + (i + 1) * lda,
+                                      a + (i + 2) * lda, a + (i + 3) * lda};
+      complex float dots[4];
+      row_dot4(n, rows, false, x, dots);
+      for (size_t q = 0; q < 4; ++q) {
+        y[i + q] += complex_mul(alpha, dots[q]);
+      }
+    }
+    for (; i < m; ++i) {
+      y[i] += complex_mul(alpha, row_dot(n, a + i * lda, false, x));
+    }
+    return;
+  }
+  // y += alpha x(i) op(A(i, :)), A is streamed once row by row
+  bool conjugate = op == CONJUGATE_TRANSPOSE;
+  for (; i + 4 <= m; i += 4) {
+    const complex float *rows[4] = {a + i * lda, a + (i + 1) * lda,
+                                    a + (i + 2) * lda, a + (i + 3) * lda};
+    complex float scalars[4];
+    for (size_t q = 0; q < 4; ++q) {
+      scalars[q] = complex_mul(alpha, x[i + q]);
+    }
+    row_axpy4(n, scalars, rows, conjugate, y);
+  }
+  for (; i < m; ++i) {
+    row_axpy(n, complex_mul(alpha, x[i]), a + i * lda, conjugate, y);
+  }
+}
+
+void kernel_ger(size_t m, size_t n, complex float alpha,
+                const complex float *x, const complex float *y, bool conjugate,
+                complex float *a, size_t lda) {
+  if (alpha == 0.0f) {
+    return;
+  }
+  PROFILE_FLOP(8 * m * n);
+  // A(i, :) += (alpha x(i)) op(y)
+  for (size_t i = 0; i < m; ++i) {
+    complex float scalar = complex_mul(alpha, x[i]);
+    if (scalar != 0.0f) {
+      row_axpy(n, scalar, y, conjugate, a + i * lda);
+    }
+  }
+}
+
+// functions: vector
+
+complex float kernel_dot(size_t n, const complex float *x, bool conjugate,
+                         const complex float *y) {
+  // partial sums of short blocks are added in double, so the rounding
+  // error does not grow with the length of long vectors
+  PROFILE_FLOP(8 * n);
+  double re = 0.0;
+  double im = 0.0;
+  for (size_t j = 0; j < n; j += DOT_BLOCK) {
+    complex float partial = row_dot(MIN(DOT_BLOCK, n - j), x + j, conjugate,
+                                    y + j);
+    re += crealf(partial);
+    im += cimagf(partial);
+  }
+  return new_complex((float)re, (float)im);
+}
+
+float kernel_norm(size_t n, const complex float *x) {
+  return sqrtf(crealf(kernel_dot(n, x, true, x)));
+}
+
+void kernel_axpy(size_t n, complex float alpha, const complex float *x,
+                 complex float *y) {
+  PROFILE_FLOP(8 * n);
+  row_axpy(n, alpha, x, false, y);
+}
+
+void kernel_scal(size_t n, complex float alpha, complex float *x) {
+  PROFILE_FLOP(6 * n);
+  for (size_t j = 0; j < n; ++j) {
+    x[j] = complex_mul(alpha, x[j]);
+  }
+}
+
+// functions: sparse
+
+void kernel_csrmv(MatrixOperation op, size_t m, size_t n,
+                  const size_t *offset, const size_t *index,
+                  const complex float *data, complex float alpha,
+                  const complex float *x, complex float beta,
+                  complex float *y) {
+  size_t y_len = op == NO_TRANSPOSE ? m : n;
+  scale_block(1, y_len, beta, y, y_len);
+  if (alpha == 0.0f) {
+    return;
+  }
+  PROFILE_FLOP(8 * offset[m]);
+  if (op == NO_TRANSPOSE) {
+    // y(i) += alpha A(i, :) x, two partial sums hide the latency of the
+    // gathered loads of x
+    for (size_t i = 0; i < m; ++i) {
+      float re[2] = {0.0f, 0.0f};
+      float im[2] = {0.0f, 0.0f};
+      size_t k = offset[i];
+      for (; k + 2 <= offset[i + 1]; k += 2) {
+        for (size_t q = 0; q < 2; ++q) {
+          complex float value = data[k + q];
+          complex float other = x[index[k + q]];
+          re[q] += crealf(value) * crealf(other) -
+                   cimagf(value) * cimagf(other);
+          im[q] += crealf(value) * cimagf(other) +
+                   cimagf(value) * crealf(other);
+        }
+      }
+      complex float dot = __builtin_complex(re[0] + re[1], im[0] + im[1]);
+      if (k < offset[i + 1]) {
+        dot += complex_mul(data[k], x[index[k]]);
+      }
+      y[i] += complex_mul(alpha, dot);
+    }
+    return;
+  }
+  // y(index) += alpha op(A(i, :)) x(i), A is streamed once row by row
+  bool conjugate = op == CONJUGATE_TRANSPOSE;
+  for (size_t i = 0; i < m; ++i) {
+    complex float scalar = complex_mul(alpha, x[i]);
+    if (scalar == 0.0f) {
+      continue;
+    }
+    for (size_t k = offset[i]; k < offset[i + 1]; ++k) {
+      complex float value = conjugate ? conjf(data[k]) : data[k];
+      y[index[k]] += complex_mul(scalar, value);
+    }
+  }
+}
+
+void kernel_csrmm(MatrixOperation op, size_t m, size_t n, size_t k,
+                  const size_t *offset, const size_t *index,
+                  const complex float *data, complex float alpha,
+                  const complex float *b, size_t ldb, complex float beta,
+                  complex float *c, size_t ldc) {
+  scale_block(op == NO_TRANSPOSE ? m : n, k, beta, c, ldc);
+  if (alpha == 0.0f) {
+    return;
+  }
+  PROFILE_FLOP(8 * offset[m] * k);
+  bool conjugate = op == CONJUGATE_TRANSPOSE;
+  // every nonzero adds a whole row of B to a row of C
+  for (size_t i = 0; i < m; ++i) {
+    for (size_t p = offset[i]; p < offset[i + 1]; ++p) {
+      complex float value = conjugate ? conjf(data[p]) : data[p];
+      complex float scalar = complex_mul(alpha, value);
+      if (op == NO_TRANSPOSE) {
+        row_axpy(k, scalar, b + index[p] * ldb, false, c + i * ldc);
+      } else {
+        row_axpy(k, scalar, b + i * ldb, false, c + index[p] * ldc);
+      }
+    }
+  }
+}
+
+// functions: triangular helpers
+
+/**
+ * @brief get the address of a block of op(A)
+ *
+ * @param[in] op the operation applied to \p a
+ * @param[in] a the operand
+ * @param[in] lda the leading dimension of \p a
+ * @param[in] row the first row of the block in op( \p a )
+ * @param[in] col the first column of the block in op( \p a )
+ * @return the block, to be read with the same operation
+ */
+static const complex float *get_op_block(MatrixOperation op,
+                                         const complex float *a, size_t lda,
+                                         size_t row, size_t col) {
+  return op == NO_TRANSPOSE ? a + row * lda + col : a + col * lda + row;
+}
+
+/**
+ * @brief check whether op(A) is lower triangular
+ *
+ * @param[in] triangle the triangle of A which is referenced
+ * @param[in] op the operation applied to A
+ * @return true if op(A) is lower triangular, or false
+ */
+static bool is_op_lower(MatrixTriangle triangle, MatrixOperation op) {
+  return (triangle == LOWER) == (op == NO_TRANSPOSE);
+}
+
+/**
+ * @brief scale a row y = alpha y
+ *
+ * @param[in] n the length of the row
+ * @param[in] alpha the scalar
+ * @param[in,out] y the row to scale
+ */
+static void row_scale(size_t n, complex float alpha, complex float *y) {
+  for (size_t j = 0; j < n; ++j) {
+    y[j] = complex_mul(alpha, y[j]);
+  }
+}
+
+/**
+ * @brief solve a diagonal block of op(A) X = B row by row
+ *
+ * @param[in] lower whether op( \p a ) is lower triangular
+ * @param[in] op the operation applied to \p a
+ * @param[in] diagonal whether \p a has an unit diagonal
+ * @param[in] nb the size of the diagonal block
+ * @param[in] n the column size of \p b
+ * @param[in] a the diagonal block
+ * @param[in] lda the leading dimension of \p a
+ * @param[in,out] b the rows of the block, overwritten by X
+ * @param[in] ldb the leading dimension of \p b
+ */
+static void trsm_diagonal_block(bool lower, MatrixOperation op,
+                                MatrixDiagonal diagonal, size_t nb, size_t n,
+                                const complex float *a, size_t lda,
+                                complex float *b, size_t ldb) {
+  PROFILE_FLOP(4 * nb * nb * n);
+  for (size_t t = 0; t < nb; ++t) {
+    // forward substitution for lower, backward for upper
+    size_t i = lower ? t : nb - 1 - t;
+    size_t k_begin = lower ? 0 : i + 1;
+    size_t k_end = lower ? i : nb;
+    for (size_t k = k_begin; k < k_end; ++k) {
+      row_axpy(n, -get_op_val(op, a, lda, i, k), b + k * ldb, false,
+               b + i * ldb);
+    }
+    if (diagonal == NON_UNIT) {
+      row_scale(n, 1.0f / get_op_val(op, a, lda, i, i), b + i * ldb);
+    }
+  }
+}
+
+/**
+ * @brief multiply a diagonal block of op(A) B row by row in place
+ *
+ * @param[in] lower whether op( \p a ) is lower triangular
+ * @param[in] op the operation applied to \p a
+ * @param[in] diagonal whether \p a has an unit diagonal
+ * @param[in] nb the size of the diagonal block
+ * @param[in] n the column size of \p b
+ * @param[in] a the diagonal block
+ * @param[in] lda the leading dimension of \p a
+ * @param[in,out] b the rows of the block, overwritten by the product
+ * @param[in] ldb the leading dimension of \p b
+ */
+static void trmm_diagonal_block(bool lower, MatrixOperation op,
+                                MatrixDiagonal diagonal, size_t nb, size_t n,
+                                const complex float *a, size_t lda,
+                                complex float *b, size_t ldb) {
+  PROFILE_FLOP(4 * nb * nb * n);
+  for (size_t t = 0; t < nb; ++t) {
+    // rows still needed by later rows are overwritten last
+    size_t i = lower ? nb - 1 - t : t;
+    size_t k_begin = lower ? 0 : i + 1;
+    size_t k_end = lower ? i : nb;
+    if (diagonal == NON_UNIT) {
+      row_scale(n, get_op_val(op, a, lda, i, i), b + i * ldb);
+    }
+    for (size_t k = k_begin; k < k_end; ++k) {
+      row_axpy(n, get_op_val(op, a, lda, i, k), b + k * ldb, false,
+               b + i * ldb);
+    }
+  }
+}
+
+/**
+ * @brief solve op(A) X = B in place with blocks of rows
+ *
+ * @param[in] lower whether op( \p a ) is lower triangular
+ * @param[in] op the operation applied to \p a
+ * @param[in] diagonal whether \p a has an unit diagonal
+ * @param[in] m the size of \p a and the row size of \p b
+ * @param[in] n the column size of \p b
+ * @param[in] a the triangular block
+ * @param[in] lda the leading dimension of \p a
+ * @param[in,out] b the right hand sides, overwritten by X
+ * @param[in] ldb the leading dimension of \p b
+ */
+static void trsm_left(bool lower, MatrixOperation op, MatrixDiagonal diagonal,
+                      size_t m, size_t n, const complex float *a, size_t lda,
+                      complex float *b, size_t ldb) {
+  complex float minus_one = new_complex(-1.0f, 0.0f);
+  complex float one = new_complex(1.0f, 0.0f);
+  if (lower) {
+    for (size_t ib = 0; ib < m; ib += TRIANGLE_BLOCK) {
+      size_t nb = MIN(TRIANGLE_BLOCK, m - ib);
+      size_t ie = ib + nb;
+      trsm_diagonal_block(true, op, diagonal, nb, n,
+                          get_op_block(op, a, lda, ib, ib), lda, b + ib * ldb,
+                          ldb);
+      // B(ie:, :) -= op(A)(ie:, ib:ie) X(ib:ie, :)
+      if (ie < m) {
+        kernel_gemm(op, NO_TRANSPOSE, m - ie, n, nb, minus_one,
+                    get_op_block(op, a, lda, ie, ib), lda, b + ib * ldb, ldb,
+                    one, b + ie * ldb, ldb);
+      }
+    }
+    return;
+  }
+  for (size_t ie = m; ie > 0;) {
+    size_t nb = MIN(TRIANGLE_BLOCK, ie);
+    size_t ib = ie - nb;
+    trsm_diagonal_block(false, op, diagonal, nb, n,
+                        get_op_block(op, a, lda, ib, ib), lda, b + ib * ldb,
+                        ldb);
+    // B(:ib, :) -= op(A)(:ib, ib:ie) X(ib:ie, :)
+    if (ib > 0) {
+      kernel_gemm(op, NO_TRANSPOSE, ib, n, nb, minus_one,
+                  get_op_block(op, a, lda, 0, ib), lda, b + ib * ldb, ldb, one,
+                  b, ldb);
+    }
+    ie = ib;
+  }
+}
+
+/**
+ * @brief compute B = op(A) B in place with blocks of rows
+ *
+ * @param[in] lower whether op( \p a ) is lower triangular
+ * @param[in] op the operation applied to \p a
+ * @param[in] diagonal whether \p a has an unit diagonal
+ * @param[in] m the size of \p a and the row size of \p b
+ * @param[in] n the column size of \p b
+ * @param[in] a the triangular block
+ * @param[in] lda the leading dimension of \p a
+ * @param[in,out] b the matrix to multiply, overwritten by the product
+ * @param[in] ldb the leading dimension of \p b
+ */
+static void trmm_left(bool lower, MatrixOperation op, MatrixDiagonal diagonal,
+                      size_t m, size_t n, const complex float *a, size_t lda,
+                      complex float *b, size_t ldb) {
+  complex float one = new_complex(1.0f, 0.0f);
+  if (lower) {
+    // bottom up, the rows above are still untouched when they are read
+    for (size_t ie = m; ie > 0;) {
+      size_t nb = MIN(TRIANGLE_BLOCK, ie);
+      size_t ib = ie - nb;
+      trmm_diagonal_block(true, op, diagonal, nb, n,
+                          get_op_block(op, a, lda, ib, ib), lda, b + ib * ldb,
+                          ldb);
+      if (ib > 0) {
+        kernel_gemm(op, NO_TRANSPOSE, nb, n, ib, one,
+                    get_op_block(op, a, lda, ib, 0), lda, b, ldb, one,
+                    b + ib * ldb, ldb);
+      }
+      ie = ib;
+    }
+    return;
+  }
+  // top down, the rows below are still untouched when they are read
+  for (size_t ib = 0; ib < m; ib += TRIANGLE_BLOCK) {
+    size_t nb = MIN(TRIANGLE_BLOCK, m - ib);
+    size_t ie = ib + nb;
+    trmm_diagonal_block(false, op, diagonal, nb, n,
+                        get_op_block(op, a, lda, ib, ib), lda, b + ib * ldb,
+                        ldb);
+    if (ie < m) {
+      kernel_gemm(op, NO_TRANSPOSE, nb, n, m - ie, one,
+                  get_op_block(op, a, lda, ib, ie), lda, b + ie * ldb, ldb,
+                  one, b + ib * ldb, ldb);
+    }
+  }
+}
+
+/**
+ * @brief apply a left triangular kernel on the right hand side through
+ *        X op(A) = B <=> op(A)^T X^T = B^T, a conjugate transposed operand
+ *        uses the conjugate form A X^H = B^H instead
+ *
+ * @param[in] left_kernel the left triangular kernel to apply
+ * @param[in] triangle the triangle of \p a to reference
+ * @param[in] op the operation applied to \p a
+ * @param[in] diagonal whether \p a has an unit diagonal
+ * @param[in] m the row size of \p b
+ * @param[in] n the column size of \p b and the size of \p a
+ * @param[in] a the triangular block
+ * @param[in] lda the leading dimension of \p a
+ * @param[in,out] b the matrix to overwrite
+ * @param[in] ldb the leading dimension of \p b
+ */
+static void apply_on_right(void (*left_kernel)(bool, MatrixOperation,
+                                               MatrixDiagonal, size_t, size_t,
+                                               const complex float *, size_t,
+                                               complex float *, size_t),
+                           MatrixTriangle triangle, MatrixOperation op,
+                           MatrixDiagonal diagonal, size_t m, size_t n,
+                           const complex float *a, size_t lda,
+                           complex float *b, size_t ldb) {
+  bool conjugate = op == CONJUGATE_TRANSPOSE;
+  MatrixOperation left_op = op == NO_TRANSPOSE ? TRANSPOSE : NO_TRANSPOSE;
+  complex float *transposed_b = matrix_malloc(m * n * sizeof(complex float));
+  kernel_transpose(m, n, b, ldb, transposed_b, m, conjugate);
+  left_kernel(is_op_lower(triangle, left_op), left_op, diagonal, n, m, a, lda,
+              transposed_b, m);
+  kernel_transpose(n, m, transposed_b, m, b, ldb, conjugate);
+  matrix_free(transposed_b);
+}
+
+// functions: triangular
+
+void kernel_trsm(MatrixSide side, MatrixTriangle triangle, MatrixOperation op,
+                 MatrixDiagonal diagonal, size_t m, size_t n,
+                 const complex float *a, size_t lda, complex float *b,
+                 size_t ldb) {
+  if (m == 0 || n == 0) {
+    return;
+  }
+  if (side == LEFT) {
+    trsm_left(is_op_lower(triangle, op), op, diagonal, m, n, a, lda, b, ldb);
+  } else {
+    apply_on_right(trsm_left, triangle, op, diagonal, m, n, a, lda, b, ldb);
+  }
+}
+
+void kernel_trmm(MatrixSide side, MatrixTriangle triangle, MatrixOperation op,
+                 MatrixDiagonal diagonal, size_t m, size_t n,
+                 const complex float *a, size_t lda, complex float *b,
+                 size_t ldb) {
+  if (m == 0 || n == 0) {
+    return;
+  }
+  if (side == LEFT) {
+    trmm_left(is_op_lower(triangle, op), op, diagonal, m, n, a, lda, b, ldb);
+  } else {
+    apply_on_right(trmm_left, triangle, op, diagonal, m, n, a, lda, b, ldb);
+  }
+}
+
+// functions: factorization helpers
+
+/**
+ * @brief update the lower triangle of a block C -= A A^H
+ *
+ * @param[in] n the size of \p c and the row size of \p a
+ * @param[in] k the column size of \p a
+ * @param[in] a the block with size ( \p n, \p k )
+ * @param[in] lda the leading dimension of \p a
+ * @param[in,out] c the block to update, only its lower triangle is touched
+ * @param[in] ldc the leading dimension of \p c
+ */
+static void herk_lower(size_t n, size_t k, const complex float *a, size_t lda,
+                       complex float *c, size_t ldc) {
+  complex float minus_one = new_complex(-1.0f, 0.0f);
+  complex float one = new_complex(1.0f, 0.0f);
+  for (size_t ib = 0; ib < n; ib += TRIANGLE_BLOCK) {
+    size_t nb = MIN(TRIANGLE_BLOCK, n - ib);
+    // the part left of the diagonal block goes through the gemm kernel
+    if (ib > 0) {
+      kernel_gemm(NO_TRANSPOSE, CONJUGATE_TRANSPOSE, nb, ib, k, minus_one,
+                  a + ib * lda, lda, a, lda, one, c + ib * ldc, ldc);
+    }
+    // the diagonal block, C(i, j) -= A(i, :) A(j, :)^H for j <= i
+    PROFILE_FLOP(4 * nb * (nb + 1) * k);
+    for (size_t i = ib; i < ib + nb; ++i) {
+      for (size_t j = ib; j <= i; ++j) {
+        c[i * ldc + j] -= row_dot(k, a + j * lda, true, a + i * lda);
+      }
+    }
+  }
+}
+
+/**
+ * @brief unblocked Cholesky factorization of a diagonal block
+ *
+ * @param[in] n the size of \p a
+ * @param[in,out] a the block, its lower triangle is overwritten by L
+ * @param[in] lda the leading dimension of \p a
+ * @return the size of the leading positive-definite minor
+ */
+static size_t potrf_diagonal_block(size_t n, complex float *a, size_t lda) {
+  PROFILE_FLOP(4 * n * n * n / 3);
+  for (size_t j = 0; j < n; ++j) {
+    complex float *row_j = a + j * lda;
+    // L(j, j) = sqrt(A(j, j) - L(j, :j) L(j, :j)^H)
+    float pivot = crealf(row_j[j]) - crealf(row_dot(j, row_j, true, row_j));
+    if (!(pivot > 0.0f)) {
+      return j;
+    }
+    float diagonal = sqrtf(pivot);
+    row_j[j] = new_complex(diagonal, 0.0f);
+    // L(i, j) = (A(i, j) - L(i, :j) L(j, :j)^H) / L(j, j)
+    for (size_t i = j + 1; i < n; ++i) {
+      complex float *row_i = a + i * lda;
+      row_i[j] = (row_i[j] - row_dot(j, row_j, true, row_i)) / diagonal;
+    }
+  }
+  return n;
+}
+
+/**
+ * @brief generate an elementary reflector H such that
+ *        H^H (alpha, x) = (beta, 0) with a real beta
+ *
+ * @param[in] n the length of \p x
+ * @param[in,out] x the vector, overwritten by v with an implicit v(0) = 1
+ * @param[out] beta the value left in the first position
+ * @return the scalar tau of H = I - tau v v^H
+ */
+static complex float make_householder(size_t n, complex float *x,
+                                      complex float *beta) {
+  complex float alpha = x[0];
+  float x_norm = sqrtf(crealf(row_dot(n - 1, x + 1, true, x + 1)));
+  if (x_norm == 0.0f && cimagf(alpha) == 0.0f) {
+    *beta = alpha;
+    return new_complex(0.0f, 0.0f);
+  }
+  float norm = hypotf(cabsf(alpha), x_norm);
+  float real_beta = crealf(alpha) >= 0.0f ? -norm : norm;
+  complex float scale = 1.0f / (alpha - real_beta);
+  for (size_t i = 1; i < n; ++i) {
+    x[i] = complex_mul(scale, x[i]);
+  }
+  *beta = new_complex(real_beta, 0.0f);
+  return (real_beta - alpha) / real_beta;
+}
+
+/**
+ * @brief get the 2-norm of a column of a block
+ *
+ * @param[in] m the length of the column
+ * @param[in] x the first value of the column
+ * @param[in] ld the leading dimension of the block
+ * @return the norm of the column
+ */
+static float column_norm(size_t m, const complex float *x, size_t ld) {
+  float norm = 0.0f;
+  for (size_t i = 0; i < m; ++i) {
+    norm = hypotf(norm, cabsf(x[i * ld]));
+  }
+  return norm;
+}
+
+// functions: factorization
+
+size_t kernel_potrf(size_t n, complex float *a, size_t lda) {
+  for (size_t kb = 0; kb < n; kb += TRIANGLE_BLOCK) {
+    size_t nb = MIN(TRIANGLE_BLOCK, n - kb);
+    size_t ke = kb + nb;
+    complex float *a11 = a + kb * lda + kb;
+    // factorize the diagonal block
+    size_t minor = potrf_diagonal_block(nb, a11, lda);
+    if (minor < nb) {
+      return kb + minor;
+    }
+    if (ke == n) {
+      break;
+    }
+    // L21 = A21 L11^-H
+    complex float *a21 = a + ke * lda + kb;
+    kernel_trsm(RIGHT, LOWER, CONJUGATE_TRANSPOSE, NON_UNIT, n - ke, nb, a11,
+                lda, a21, lda);
+    // A22 -= L21 L21^H on the lower triangle
+    herk_lower(n - ke, nb, a21, lda, a + ke * lda + ke, lda);
+  }
+  return n;
+}
+
+void kernel_geqrf(size_t m, size_t n, complex float *a, size_t lda,
+                  complex float *tau) {
+  size_t k_max = MIN(m, n);
+  complex float *v = matrix_malloc(m * sizeof(complex float));
+  complex float *u = matrix_malloc(n * sizeof(complex float));
+  for (size_t k = 0; k < k_max; ++k) {
+    size_t len = m - k;
+    // gather column k from the diagonal down
+    for (size_t i = 0; i < len; ++i) {
+      v[i] = a[(k + i) * lda + k];
+    }
+    complex float beta;
+    tau[k] = make_householder(len, v, &beta);
+    v[0] = new_complex(1.0f, 0.0f);
+    // scatter R(k, k) and the reflector back
+    a[k * lda + k] = beta;
+    for (size_t i = 1; i < len; ++i) {
+      a[(k + i) * lda + k] = v[i];
+    }
+    // A(k:, k+1:) -= conj(tau) v (v^H A(k:, k+1:))
+    if (k + 1 < n && tau[k] != 0.0f) {
+      complex float *trailing = a + k * lda + k + 1;
+      kernel_gemv(CONJUGATE_TRANSPOSE, len, n - k - 1,
+                  new_complex(1.0f, 0.0f), trailing, lda, v,
+                  new_complex(0.0f, 0.0f), u);
+      kernel_ger(len, n - k - 1, -conjf(tau[k]), v, u, true, trailing, lda);
+    }
+  }
+  matrix_free(u);
+  matrix_free(v);
+}
+
+size_t kernel_geqp3(size_t m, size_t n, complex float *a, size_t lda,
+                    size_t *pivot, complex float *tau) {
+  size_t k_max = MIN(m, n);
+  complex float *v = matrix_malloc(m * sizeof(complex float));
+  complex float *u = matrix_malloc(n * sizeof(complex float));
+  // partial norms of the trailing columns, and the norms when they were
+  // last computed in full
+  float *partial = matrix_malloc(2 * n * sizeof(float));
+  float *reference = partial + n;
+  for (size_t j = 0; j < n; ++j) {
+    pivot[j] = j;
+    partial[j] = column_norm(m, a + j, lda);
+    reference[j] = partial[j];
+  }
+  const float tolerance = sqrtf(FLT_EPSILON);
+  for (size_t k = 0; k < k_max; ++k) {
+    // move the column with the largest remaining norm to k
+    size_t p = k;
+    for (size_t j = k + 1; j < n; ++j) {
+      if (partial[j] > partial[p]) {
+        p = j;
+      }
+    }
+    if (p != k) {
+      for (size_t i = 0; i < m; ++i) {
+        complex float temp = a[i * lda + k];
+        a[i * lda + k] = a[i * lda + p];
+        a[i * lda + p] = temp;
+      }
+      size_t index = pivot[k];
+      pivot[k] = pivot[p];
+      pivot[p] = index;
+      partial[p] = partial[k];
+      reference[p] = reference[k];
+    }
+    // the same reflection as kernel_geqrf
+    size_t len = m - k;
+    for (size_t i = 0; i < len; ++i) {
+      v[i] = a[(k + i) * lda + k];
+    }
+    complex float beta;
+    tau[k] = make_householder(len, v, &beta);
+    v[0] = new_complex(1.0f, 0.0f);
+    a[k * lda + k] = beta;
+    for (size_t i = 1; i < len; ++i) {
+      a[(k + i) * lda + k] = v[i];
+    }
+    if (k + 1 < n && tau[k] != 0.0f) {
+      complex float *trailing = a + k * lda + k + 1;
+      kernel_gemv(CONJUGATE_TRANSPOSE, len, n - k - 1,
+                  new_complex(1.0f, 0.0f), trailing, lda, v,
+                  new_complex(0.0f, 0.0f), u);
+      kernel_ger(len, n - k - 1, -conjf(tau[k]), v, u, true, trailing, lda);
+    }
+    // downdate the norms by the removed row k, and recompute them when
+    // cancellation has eaten up too many digits
+    for (size_t j = k + 1; j < n; ++j) {
+      if (partial[j] == 0.0f) {
+        continue;
+      }
+      float ratio = cabsf(a[k * lda + j]) / partial[j];
+      float remain = MAX(0.0f, (1.0f + ratio) * (1.0f - ratio));
+      float drift = partial[j] / reference[j];
+      if (remain * drift * drift <= tolerance) {
+        partial[j] = column_norm(m - k - 1, a + (k + 1) * lda + j, lda);
+        reference[j] = partial[j];
+      } else {
+        partial[j] *= sqrtf(remain);
+      }
+    }
+  }
+  matrix_free(partial);
+  matrix_free(u);
+  matrix_free(v);
+  // count the diagonal values above the noise level of the largest one
+  size_t rank = 0;
+  if (k_max > 0) {
+    float threshold = cabsf(a[0]) * (float)MAX(m, n) * FLT_EPSILON;
+    while (rank < k_max && cabsf(a[rank * lda + rank]) > threshold) {
+      rank++;
+    }
+  }
+  return rank;
+}
+
+void kernel_ungqr(size_t m, size_t q, size_t k, const complex float *a,
+                  size_t lda, const complex float *tau, complex float *out,
+                  size_t ldo) {
+  // start from the leading columns of the identity
+  for (size_t i = 0; i < m; ++i) {
+    for (size_t j = 0; j < q; ++j) {
+      out[i * ldo + j] = new_complex(i == j ? 1.0f : 0.0f, 0.0f);
+    }
+  }
+  complex float *v = matrix_malloc(m * sizeof(complex float));
+  complex float *u = matrix_malloc(q * sizeof(complex float));
+  // Q = H(0) (H(1) (... H(k - 1))), H(kk) only meets columns from kk on
+  for (size_t kk = k; kk > 0; --kk) {
+    size_t r = kk - 1;
+    size_t len = m - r;
+    if (tau[r] == 0.0f) {
+      continue;
+    }
+    v[0] = new_complex(1.0f, 0.0f);
+    for (size_t i = 1; i < len; ++i) {
+      v[i] = a[(r + i) * lda + r];
+    }
+    complex float *block = out + r * ldo + r;
+    kernel_gemv(CONJUGATE_TRANSPOSE, len, q - r, new_complex(1.0f, 0.0f),
+                block, ldo, v, new_complex(0.0f, 0.0f), u);
+    kernel_ger(len, q - r, -tau[r], v, u, true, block, ldo);
+  }
+  matrix_free(u);
+  matrix_free(v);
+}
+
+void kernel_unmqr(MatrixOperation op, size_t m, size_t n, size_t k,
+                  const complex float *a, size_t lda, const complex float *tau,
+                  complex float *b, size_t ldb) {
+  complex float *v = matrix_malloc(m * sizeof(complex float));
+  complex float *u = matrix_malloc(n * sizeof(complex float));
+  bool adjoint = op != NO_TRANSPOSE;
+  // Q^H B = H(k - 1)^H (... (H(0)^H B)), Q B = H(0) (... (H(k - 1) B))
+  for (size_t step = 0; step < k; ++step) {
+    size_t r = adjoint ? step : k - 1 - step;
+    size_t len = m - r;
+    if (tau[r] == 0.0f) {
+      continue;
+    }
+    v[0] = new_complex(1.0f, 0.0f);
+    for (size_t i = 1; i < len; ++i) {
+      v[i] = a[(r + i) * lda + r];
+    }
+    complex float *block = b + r * ldb;
+    kernel_gemv(CONJUGATE_TRANSPOSE, len, n, new_complex(1.0f, 0.0f), block,
+                ldb, v, new_complex(0.0f, 0.0f), u);
+    kernel_ger(len, n, adjoint ? -conjf(tau[r]) : -tau[r], v, u, true, block,
+               ldb);
+  }
+  matrix_free(u);
+  matrix_free(v);
+}
+
+// functions: elimination
+
+size_t kernel_rref(size_t m, size_t n, complex float *a, size_t lda,
+                   size_t *pivot) {
+  // values under max(m, n) FLT_EPSILON |A|_inf are rounding noise of the
+  // elimination and treated as zero
+  float norm = 0.0f;
+  for (size_t i = 0; i < m; ++i) {
+    float row_sum = 0.0f;
+    for (size_t j = 0; j < n; ++j) {
+      row_sum += cabsf(a[i * lda + j]);
+    }
+    norm = MAX(norm, row_sum);
+  }
+  float threshold = norm * (float)MAX(m, n) * FLT_EPSILON;
+  size_t rank = 0;
+  for (size_t col = 0; col < n && rank < m; ++col) {
+    // partial pivoting: the largest value of the column under row rank
+    size_t p = rank;
+    float p_abs = cabsf(a[rank * lda + col]);
+    for (size_t i = rank + 1; i < m; ++i) {
+      float value_abs = cabsf(a[i * lda + col]);
+      if (value_abs > p_abs) {
+        p = i;
+        p_abs = value_abs;
+      }
+    }
+    if (p_abs <= threshold) {
+      // no pivot, clear the noise left in the column
+      for (size_t i = rank; i < m; ++i) {
+        a[i * lda + col] = new_complex(0.0f, 0.0f);
+      }
+      continue;
+    }
+    complex float *pivot_row = a + rank * lda;
+    if (p != rank) {
+      complex float *other = a + p * lda;
+      for (size_t j = col; j < n; ++j) {
+        complex float temp = pivot_row[j];
+        pivot_row[j] = other[j];
+        other[j] = temp;
+      }
+    }
+    // make the pivot 1, columns before col are already zero in this row
+    PROFILE_FLOP(8 * m * (n - col - 1));
+    row_scale(n - col - 1, 1.0f / pivot_row[col], pivot_row + col + 1);
+    pivot_row[col] = new_complex(1.0f, 0.0f);
+    // eliminate the column from all the other rows
+    for (size_t i = 0; i < m; ++i) {
+      complex float *row = a + i * lda;
+      if (i == rank || row[col] == 0.0f) {
+        continue;
+      }
+      row_axpy(n - col - 1, -row[col], pivot_row + col + 1, false,
+               row + col + 1);
+      row[col] = new_complex(0.0f, 0.0f);
+    }
+    if (pivot != NULL) {
+      pivot[rank] = col;
+    }
+    rank++;
+  }
+  return rank;
+}
+
+// functions: singular value decomposition helpers
+
+/**
+ * @brief apply a complex plane rotation to two rows
+ *        p' = c p - s conj(phase) q, q' = s phase p + c q
+ *
+ * @param[in] n the length of the rows
+ * @param[in,out] p the first row
+ * @param[in,out] q the second row
+ * @param[in] c the cosine of the rotation
+ * @param[in] s the sine of the rotation
+ * @param[in] phase the unit phase of the rotation
+ */
+static void rotate_rows(size_t n, complex float *p, complex float *q, float c,
+                        float s, complex float phase) {
+  PROFILE_FLOP(20 * n);
+  complex float sp = s * phase;
+  complex float sq = s * conjf(phase);
+  for (size_t j = 0; j < n; ++j) {
+    complex float vp = p[j];
+    complex float vq = q[j];
+    p[j] = c * vp - complex_mul(sq, vq);
+    q[j] = complex_mul(sp, vp) + c * vq;
+  }
+}
+
+// functions: singular value decomposition
+
+size_t kernel_jacobi_svd(size_t n, size_t len, complex float *w, size_t ldw,
+                         size_t len_v, complex float *v, size_t ldv,
+                         float *sigma) {
+  float tolerance = FLT_EPSILON * (float)MAX(len, 1);
+  // round-robin ordering, pad to an even number of rows
+  size_t players = n + (n & 1);
+  size_t sweep = 0;
+  while (sweep < JACOBI_MAX_SWEEP && players > 1) {
+    bool rotated = false;
+    for (size_t round = 0; round + 1 < players; ++round) {
+      // the pairs of a round are disjoint, they can be rotated in any order
+      for (size_t k = 0; k < players / 2; ++k) {
+        size_t p = (round + k) % (players - 1);
+        size_t q = k == 0 ? players - 1
+                          : (round + players - 1 - k) % (players - 1);
+        if (p >= n || q >= n) {
+          continue;
+        }
+        complex float *row_p = w + p * ldw;
+        complex float *row_q = w + q * ldw;
+        PROFILE_FLOP(24 * len);
+        float alpha = crealf(row_dot(len, row_p, true, row_p));
+        float beta = crealf(row_dot(len, row_q, true, row_q));
+        complex float gamma = row_dot(len, row_p, true, row_q);
+        float abs_gamma = cabsf(gamma);
+        // skip pairs which are already orthogonal
+        if (abs_gamma == 0.0f ||
+            abs_gamma <= tolerance * sqrtf(alpha) * sqrtf(beta)) {
+          continue;
+        }
+        rotated = true;
+        // the rotation which diagonalizes [[alpha, gamma], [gamma*, beta]]
+        float zeta = (beta - alpha) / (2.0f * abs_gamma);
+        float t = copysignf(1.0f, zeta) /
+                  (fabsf(zeta) + sqrtf(1.0f + zeta * zeta));
+        float c = 1.0f / sqrtf(1.0f + t * t);
+        float s = c * t;
+        complex float phase = gamma / abs_gamma;
+        rotate_rows(len, row_p, row_q, c, s, phase);
+        rotate_rows(len_v, v + p * ldv, v + q * ldv, c, s, phase);
+      }
+    }
+    sweep++;
+    if (!rotated) {
+      break;
+    }
+  }
+  // singular values are the norms of the rotated rows
+  for (size_t i = 0; i < n; ++i) {
+    sigma[i] = sqrtf(crealf(row_dot(len, w + i * ldw, true, w + i * ldw)));
+  }
+  return sweep;
+}
@@ -0,0 +1,388 @@
+/**
+ * @file matrix/kernel_matrix.h
+ * @brief internal computing kernels of matrix library
+ *
+ * kernels work on raw row-major buffers with an explicit leading dimension
+ * (the distance between two rows), so they can run on a whole matrix or on
+ * a block inside of it without any copy
+ */
+
+#pragma once
+#ifndef __MATRIX_KERNEL_MATRIX_H__
+#define __MATRIX_KERNEL_MATRIX_H__
+
+// include
+
+#include "matrix/matrix.h"
+#include "matrix/matrix_ext.h"
+#include <complex.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// functions: transpose
+
+/**
+ * @brief transpose a block into another buffer
+ *
+ * @param[in] row the row size of the source block
+ * @param[in] col the column size of the source block
+ * @param[in] src the source block
+ * @param[in] lds the leading dimension of \p src
+ * @param[out] dst the destination block with size ( \p col, \p row )
+ * @param[in] ldd the leading dimension of \p dst
+ * @param[in] conjugate conjugate the values while transposing
+ */
+extern void kernel_transpose(size_t row, size_t col, const complex float *src,
+                             size_t lds, complex float *dst, size_t ldd,
+                             bool conjugate);
+
+/**
+ * @brief transpose a square block in place
+ *
+ * @param[in] size the row (and column) size of the block
+ * @param[in,out] data the block to transpose
+ * @param[in] ld the leading dimension of \p data
+ * @param[in] conjugate conjugate the values while transposing
+ */
+extern void kernel_transpose_in_place(size_t size, complex float *data,
+                                      size_t ld, bool conjugate);
+
+// functions: multiplication
+
+/**
+ * @brief general multiplication C = alpha op(A) op(B) + beta C
+ *
+ * @param[in] lop the operation applied to \p a
+ * @param[in] rop the operation applied to \p b
+ * @param[in] m the row size of op( \p a ) and \p c
+ * @param[in] n the column size of op( \p b ) and \p c
+ * @param[in] k the column size of op( \p a ) and row size of op( \p b )
+ * @param[in] alpha the scalar of the product
+ * @param[in] a the left hand side block
+ * @param[in] lda the leading dimension of \p a
+ * @param[in] b the right hand side block
+ * @param[in] ldb the leading dimension of \p b
+ * @param[in] beta the scalar of \p c , \p c is not read if it is zero
+ * @param[in,out] c the result block with size ( \p m, \p n )
+ * @param[in] ldc the leading dimension of \p c
+ */
+extern void kernel_gemm(MatrixOperation lop, MatrixOperation rop, size_t m,
+                        size_t n, size_t k, complex float alpha,
+                        const complex float *a, size_t lda,
+                        const complex float *b, size_t ldb, complex float beta,
+                        complex float *c, size_t ldc);
+
+/**
+ * @brief real multiplication C = alpha A B + beta C
+ *
+ * @param[in] m the row size of \p a and \p c
+ * @param[in] n the column size of \p b and \p c
+ * @param[in] k the column size of \p a and row size of \p b
+ * @param[in] alpha the scalar of the product
+ * @param[in] a the left hand side block
+ * @param[in] lda the leading dimension of \p a
+ * @param[in] b the right hand side block
+ * @param[in] ldb the leading dimension of \p b
+ * @param[in] beta the scalar of \p c , \p c is not read if it is zero
+ * @param[in,out] c the result block with size ( \p m, \p n )
+ * @param[in] ldc the leading dimension of \p c
+ */
+extern void kernel_real_gemm(size_t m, size_t n, size_t k, float alpha,
+                             const float *a, size_t lda, const float *b,
+                             size_t ldb, float beta, float *c, size_t ldc);
+
+/**
+ * @brief multiplication of a matrix and a vector y = alpha op(A) x + beta y
+ *
+ * @param[in] op the operation applied to \p a
+ * @param[in] m the row size of \p a
+ * @param[in] n the column size of \p a
+ * @param[in] alpha the scalar of the product
+ * @param[in] a the matrix block
+ * @param[in] lda the leading dimension of \p a
+ * @param[in] x the vector with the column size of op( \p a )
+ * @param[in] beta the scalar of \p y , \p y is not read if it is zero
+ * @param[in,out] y the vector with the row size of op( \p a )
+ */
+extern void kernel_gemv(MatrixOperation op, size_t m, size_t n,
+                        complex float alpha, const complex float *a,
+                        size_t lda, const complex float *x, complex float beta,
+                        complex float *y);
+
+/**
+ * @brief rank one update of a matrix A = alpha x op(y) + A
+ *
+ * @param[in] m the row size of \p a
+ * @param[in] n the column size of \p a
+ * @param[in] alpha the scalar of the update
+ * @param[in] x the vector with length \p m
+ * @param[in] y the vector with length \p n
+ * @param[in] conjugate conjugate \p y before the update
+ * @param[in,out] a the matrix block to update
+ * @param[in] lda the leading dimension of \p a
+ */
+extern void kernel_ger(size_t m, size_t n, complex float alpha,
+                       const complex float *x, const complex float *y,
+                       bool conjugate, complex float *a, size_t lda);
+
+// functions: vector
+
+/**
+ * @brief dot product of two vectors sum(op(x) y)
+ *
+ * @param[in] n the length of the vectors
+ * @param[in] x the left hand side vector
+ * @param[in] conjugate conjugate \p x , which gives the inner product
+ * @param[in] y the right hand side vector
+ * @return the dot product
+ */
+extern complex float kernel_dot(size_t n, const complex float *x,
+                                bool conjugate, const complex float *y);
+
+/**
+ * @brief 2-norm of a vector
+ *
+ * @param[in] n the length of the vector
+ * @param[in] x the vector
+ * @return the norm of \p x
+ */
+extern float kernel_norm(size_t n, const complex float *x);
+
+/**
+ * @brief update a vector y = alpha x + y
+ *
+ * @param[in] n the length of the vectors
+ * @param[in] alpha the scalar
+ * @param[in] x the vector to add
+ * @param[in,out] y the vector to update
+ */
+extern void kernel_axpy(size_t n, complex float alpha, const complex float *x,
+                        complex float *y);
+
+/**
+ * @brief scale a vector x = alpha x
+ *
+ * @param[in] n the length of the vector
+ * @param[in] alpha the scalar
+ * @param[in,out] x the vector to scale
+ */
+extern void kernel_scal(size_t n, complex float alpha, complex float *x);
+
+// functions: sparse
+
+/**
+ * @brief multiplication of a compressed sparse row matrix and a vector
+ *        y = alpha op(A) x + beta y
+ *
+ * a compressed sparse column matrix is the compressed sparse row form of
+ * its transpose, so it goes through this kernel with a transposed \p op
+ *
+ * @param[in] op the operation applied to A
+ * @param[in] m the row size of A
+ * @param[in] n the column size of A
+ * @param[in] offset the \p m + 1 row offsets into \p index and \p data
+ * @param[in] index the column index of every nonzero
+ * @param[in] data the value of every nonzero
+ * @param[in] alpha the scalar of the product
+ * @param[in] x the vector with the column size of op(A)
+ * @param[in] beta the scalar of \p y , \p y is not read if it is zero
+ * @param[in,out] y the vector with the row size of op(A)
+ */
+extern void kernel_csrmv(MatrixOperation op, size_t m, size_t n,
+                         const size_t *offset, const size_t *index,
+                         const complex float *data, complex float alpha,
+                         const complex float *x, complex float beta,
+                         complex float *y);
+
+/**
+ * @brief multiplication of a compressed sparse row matrix and a dense block
+ *        C = alpha op(A) B + beta C
+ *
+ * @param[in] op the operation applied to A
+ * @param[in] m the row size of A
+ * @param[in] n the column size of A
+ * @param[in] k the column size of \p b and \p c
+ * @param[in] offset the \p m + 1 row offsets into \p index and \p data
+ * @param[in] index the column index of every nonzero
+ * @param[in] data the value of every nonzero
+ * @param[in] alpha the scalar of the product
+ * @param[in] b the dense block with the column size of op(A) as row size
+ * @param[in] ldb the leading dimension of \p b
+ * @param[in] beta the scalar of \p c , \p c is not read if it is zero
+ * @param[in,out] c the result block with the row size of op(A)
+ * @param[in] ldc the leading dimension of \p c
+ */
+extern void kernel_csrmm(MatrixOperation op, size_t m, size_t n, size_t k,
+                         const size_t *offset, const size_t *index,
+                         const complex float *data, complex float alpha,
+                         const complex float *b, size_t ldb,
+                         complex float beta, complex float *c, size_t ldc);
+
+// functions: triangular
+
+/**
+ * @brief solve a triangular system in place, op(A) X = B if \p side is
+ *        LEFT, or X op(A) = B if \p side is RIGHT
+ *
+ * @param[in] side the side where \p a is applied
+ * @param[in] triangle the triangle of \p a to reference
+ * @param[in] op the operation applied to \p a
+ * @param[in] diagonal whether \p a has an unit diagonal
+ * @param[in] m the row size of \p b
+ * @param[in] n the column size of \p b
+ * @param[in] a the triangular block, its size is \p m on the LEFT and
+ *            \p n on the RIGHT
+ * @param[in] lda the leading dimension of \p a
+ * @param[in,out] b the right hand sides, overwritten by X
+ * @param[in] ldb the leading dimension of \p b
+ */
+extern void kernel_trsm(MatrixSide side, MatrixTriangle triangle,
+                        MatrixOperation op, MatrixDiagonal diagonal, size_t m,
+                        size_t n, const complex float *a, size_t lda,
+                        complex float *b, size_t ldb);
+
+/**
+ * @brief multiply a triangular matrix in place, B = op(A) B if \p side is
+ *        LEFT, or B = B op(A) if \p side is RIGHT
+ *
+ * @param[in] side the side where \p a is applied
+ * @param[in] triangle the triangle of \p a to reference
+ * @param[in] op the operation applied to \p a
+ * @param[in] diagonal whether \p a has an unit diagonal
+ * @param[in] m the row size of \p b
+ * @param[in] n the column size of \p b
+ * @param[in] a the triangular block, its size is \p m on the LEFT and
+ *            \p n on the RIGHT
+ * @param[in] lda the leading dimension of \p a
+ * @param[in,out] b the matrix to multiply, overwritten by the product
+ * @param[in] ldb the leading dimension of \p b
+ */
+extern void kernel_trmm(MatrixSide side, MatrixTriangle triangle,
+                        MatrixOperation op, MatrixDiagonal diagonal, size_t m,
+                        size_t n, const complex float *a, size_t lda,
+                        complex float *b, size_t ldb);
+
+// functions: factorization
+
+/**
+ * @brief Cholesky factorization A = L L^H of a Hermitian positive-definite
+ *        block in place, only the lower triangle is read and overwritten
+ *
+ * @param[in] n the size of \p a
+ * @param[in,out] a the block, its lower triangle is overwritten by L
+ * @param[in] lda the leading dimension of \p a
+ * @return the size of the leading positive-definite minor, \p n on success
+ */
+extern size_t kernel_potrf(size_t n, complex float *a, size_t lda);
+
+/**
+ * @brief Householder QR factorization A = Q R in place, Q is kept as
+ *        reflectors H(k) = I - tau(k) v(k) v(k)^H with v(k)(k) = 1 stored
+ *        below the diagonal
+ *
+ * @param[in] m the row size of \p a
+ * @param[in] n the column size of \p a
+ * @param[in,out] a the block, overwritten by R and the reflectors
+ * @param[in] lda the leading dimension of \p a
+ * @param[out] tau the min( \p m, \p n ) scalars of the reflectors
+ */
+extern void kernel_geqrf(size_t m, size_t n, complex float *a, size_t lda,
+                         complex float *tau);
+
+/**
+ * @brief Householder QR factorization with column pivoting A P = Q R in
+ *        place, the remaining column with the largest norm is chosen at
+ *        every step, so the diagonal of R is non-increasing in magnitude
+ *
+ * @param[in] m the row size of \p a
+ * @param[in] n the column size of \p a
+ * @param[in,out] a the block, overwritten by R and the reflectors as
+ *                kernel_geqrf
+ * @param[in] lda the leading dimension of \p a
+ * @param[out] pivot the \p n source columns, column j of A P is column
+ *             \p pivot [j] of A
+ * @param[out] tau the min( \p m, \p n ) scalars of the reflectors
+ * @return the numerical rank, the number of diagonal values of R above
+ *         |R(0, 0)| max( \p m, \p n ) FLT_EPSILON
+ */
+extern size_t kernel_geqp3(size_t m, size_t n, complex float *a, size_t lda,
+                           size_t *pivot, complex float *tau);
+
+/**
+ * @brief generate the leading columns of Q = H(0) H(1) ... H(k - 1) from
+ *        the reflectors of kernel_geqrf
+ *
+ * @param[in] m the row size of Q
+ * @param[in] q the number of columns to generate ( \p k <= \p q <= \p m )
+ * @param[in] k the number of reflectors
+ * @param[in] a the reflectors
+ * @param[in] lda the leading dimension of \p a
+ * @param[in] tau the scalars of the reflectors
+ * @param[out] out the block with size ( \p m, \p q )
+ * @param[in] ldo the leading dimension of \p out
+ */
+extern void kernel_ungqr(size_t m, size_t q, size_t k, const complex float *a,
+                         size_t lda, const complex float *tau,
+                         complex float *out, size_t ldo);
+
+/**
+ * @brief multiply a block by Q or Q^H from the reflectors of kernel_geqrf
+ *        in place, B = op(Q) B
+ *
+ * @param[in] op NO_TRANSPOSE for Q, TRANSPOSE or CONJUGATE_TRANSPOSE for
+ *            Q^H
+ * @param[in] m the row size of \p b and Q
+ * @param[in] n the column size of \p b
+ * @param[in] k the number of reflectors
+ * @param[in] a the reflectors
+ * @param[in] lda the leading dimension of \p a
+ * @param[in] tau the scalars of the reflectors
+ * @param[in,out] b the block to multiply
+ * @param[in] ldb the leading dimension of \p b
+ */
+extern void kernel_unmqr(MatrixOperation op, size_t m, size_t n, size_t k,
+                         const complex float *a, size_t lda,
+                         const complex float *tau, complex float *b,
+                         size_t ldb);
+
+// functions: elimination
+
+/**
+ * @brief reduce a block to its reduced row echelon form in place by
+ *        Gauss-Jordan elimination with partial pivoting, a column has no
+ *        pivot if its candidates are under max( \p m, \p n ) FLT_EPSILON
+ *        |A|_inf
+ *
+ * @param[in] m the row size of \p a
+ * @param[in] n the column size of \p a
+ * @param[in,out] a the block, overwritten by its reduced row echelon form
+ * @param[in] lda the leading dimension of \p a
+ * @param[out] pivot the pivot column of each non-zero row, ignored if NULL,
+ *             it needs min( \p m, \p n ) entries
+ * @return the number of pivots
+ */
+extern size_t kernel_rref(size_t m, size_t n, complex float *a, size_t lda,
+                          size_t *pivot);
+
+// functions: singular value decomposition
+
+/**
+ * @brief one-sided Jacobi orthogonalization, the rows of W are rotated
+ *        in pairs until they are mutually orthogonal, and the same
+ *        rotations are applied to the rows of V
+ *
+ * @param[in] n the number of rows of \p w and \p v
+ * @param[in] len the length of the rows of \p w
+ * @param[in,out] w the rows to orthogonalize
+ * @param[in] ldw the leading dimension of \p w
+ * @param[in] len_v the length of the rows of \p v
+ * @param[in,out] v the rows which accumulate the rotations
+ * @param[in] ldv the leading dimension of \p v
+ * @param[out] sigma the norms of the rows of \p w after rotation
+ * @return the number of sweeps done
+ */
+extern size_t kernel_jacobi_svd(size_t n, size_t len, complex float *w,
+                                size_t ldw, size_t len_v, complex float *v,
+                                size_t ldv, float *sigma);
+
+#endif
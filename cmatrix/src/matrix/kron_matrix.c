@@ -0,0 +1,243 @@
+/**
+ * @file matrix/kron_matrix.c
+ * @brief Kronecker product operators of matrix library
+ */
+
+// include
+
+#include "alloc_matrix.h"
+#include "kernel_matrix.h"
+#include "matrix/matrix.h"
+#include "matrix/matrix_iter.h"
+#include "matrix/matrix_kron.h"
+#include "matrix/utils.h"
+#include "profile_matrix.h"
+#include <complex.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// functions: helpers
+
+/**
+ * @brief the product y = op(K) x, the factors are applied one by one on x
+ *        reshaped as a tensor, applying factor k is a multiplication of
+ *        op(Ak) with every (n_k, right) block of the tensor
+ *
+ * @param[in] operation the operation applied to the Kronecker matrix
+ * @param[in] kronecker_matrix the Kronecker matrix K
+ * @param[in] x the vector to apply on
+ * @param[out] y the result, it never overlaps \p x
+ */
+static void kronecker_mul(MatrixOperation operation,
+                          const KroneckerMatrixT *kronecker_matrix,
+                          const complex float *x, complex float *y) {
+  size_t number = kronecker_matrix->factor_number;
+  size_t row_index = operation == NO_TRANSPOSE ? 0 : 1;
+  MatrixT **factors = kronecker_matrix->factors;
+  // init: the current size of every tensor axis
+  size_t *dims = matrix_malloc(number * sizeof(size_t));
+  size_t *order = matrix_malloc(number * sizeof(size_t));
+  for (size_t k = 0; k < number; ++k) {
+    dims[k] = factors[k]->size[1 - row_index];
+    order[k] = k;
+  }
+  // the factors commute, applying one costs the vector length times its row
+  // size, so the cheapest order sorts them by 1 / n - 1 / m
+  for (size_t k = 1; k < number; ++k) {
+    size_t current = order[k];
+    double key = 1.0 / dims[current] -
+                 1.0 / factors[current]->size[row_index];
+    size_t position = k;
+    for (; position > 0; --position) {
+      size_t other = order[position - 1];
+      if (1.0 / dims[other] - 1.0 / factors[other]->size[row_index] <= key) {
+        break;
+      }
+      order[position] = other;
+    }
+    order[position] = current;
+  }
+  // init: ping-pong buffers for the intermediate vectors
+  size_t length = kronecker_matrix->size[1 - row_index];
+  size_t longest = 0;
+  for (size_t step = 0; step + 1 < number; ++step) {
+    size_t k = order[step];
+    length = length / dims[k] * factors[k]->size[row_index];
+    longest = MAX(longest, length);
+  }
+  complex float *work =
+      matrix_malloc(2 * MAX(longest, 1) * sizeof(complex float));
+  const complex float *src = x;
+  for (size_t step = 0; step < number; ++step) {
+    size_t k = order[step];
+    size_t m = factors[k]->size[row_index];
+    size_t n = dims[k];
+    size_t left = 1;
+    size_t right = 1;
+    for (size_t i = 0; i < k; ++i) {
+      left *= dims[i];
+    }
+    for (size_t i = k + 1; i < number; ++i) {
+      right *= dims[i];
+    }
+    complex float *dst =
+        step + 1 == number ? y : work + (step % 2) * longest;
+    if (right == 1 && operation != CONJUGATE_TRANSPOSE) {
+      // the blocks of the last axis are rows, Y = X op(Ak)^T in one product
+      kernel_gemm(NO_TRANSPOSE,
+                  operation == NO_TRANSPOSE ? TRANSPOSE : NO_TRANSPOSE, left,
+                  m, n, new_complex(1.0f, 0.0f), src, n, factors[k]->data,
+                  factors[k]->size[1], new_complex(0.0f, 0.0f), dst, m);
+    } else {
+      for (size_t l = 0; l < left; ++l) {
+        kernel_gemm(operation, NO_TRANSPOSE, m, right, n,
+                    new_complex(1.0f, 0.0f), factors[k]->data,
+                    factors[k]->size[1], src + l * n * right, right,
+                    new_complex(0.0f, 0.0f), dst + l * m * right, right);
+      }
+    }
+    dims[k] = m;
+    src = dst;
+  }
+  matrix_free(work);
+  matrix_free(order);
+  matrix_free(dims);
+}
+
+/**
+ * @brief the product of an operator backed by a Kronecker matrix
+ *
+ * @param[in] x the vector to apply on
+ * @param[out] y the result
+ * @param[in] context the Kronecker matrix
+ */
+static void apply_kronecker_matrix(const complex float *x, complex float *y,
+                                   void *context) {
+  kronecker_mul(NO_TRANSPOSE, context, x, y);
+}
+
+// functions: init
+
+KroneckerMatrixT *new_kronecker_matrix(MatrixT **factors,
+                                       size_t factor_number) {
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (factors == NULL || factor_number == 0) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  KroneckerMatrixT *kronecker_matrix = matrix_malloc(sizeof(KroneckerMatrixT));
+  kronecker_matrix->size[0] = 1;
+  kronecker_matrix->size[1] = 1;
+  kronecker_matrix->factor_number = factor_number;
+  kronecker_matrix->factors = matrix_calloc(factor_number, sizeof(MatrixT *));
+  for (size_t k = 0; k < factor_number; ++k) {
+    // boundary test: null pointer
+    if (factors[k] == NULL) {
+      log_error("panic: null pointer error at %s", __func__);
+      exit(EXIT_FAILURE);
+    }
+    // boundary test: size
+    for (size_t i = 0; i < 2; ++i) {
+      if (factors[k]->size[i] == 0 ||
+          kronecker_matrix->size[i] > SIZE_MAX / factors[k]->size[i]) {
+        log_error("panic: Kronecker product size is illegal with factor %zu "
+                  "of size (%u, %u)",
+                  k + 1, factors[k]->size[0], factors[k]->size[1]);
+        exit(EXIT_FAILURE);
+      }
+      kronecker_matrix->size[i] *= factors[k]->size[i];
+    }
+    kronecker_matrix->factors[k] = copy_matrix(factors[k]);
+  }
+  return kronecker_matrix;
+}
+
+MatrixT *
+new_matrix_from_kronecker_matrix(const KroneckerMatrixT *kronecker_matrix) {
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (kronecker_matrix == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  // boundary test: size
+  if (kronecker_matrix->size[0] > UINT8_MAX ||
+      kronecker_matrix->size[1] > UINT8_MAX) {
+    log_error("panic: Kronecker product size (%zu, %zu) is over the size of "
+              "a matrix",
+              kronecker_matrix->size[0], kronecker_matrix->size[1]);
+    exit(EXIT_FAILURE);
+  }
+  MatrixT *matrix = copy_matrix(kronecker_matrix->factors[0]);
+  for (size_t k = 1; k < kronecker_matrix->factor_number; ++k) {
+    MatrixT *product =
+        tensor_product_matrix(matrix, kronecker_matrix->factors[k]);
+    drop_matrix(matrix);
+    matrix = product;
+  }
+  return matrix;
+}
+
+void drop_kronecker_matrix(KroneckerMatrixT *kronecker_matrix) {
+  PROFILE_FUNCTION();
+  // if matrix is null, it's fine
+  if (kronecker_matrix == NULL) {
+    return;
+  }
+  drop_matrices(kronecker_matrix->factors, kronecker_matrix->factor_number);
+  matrix_free(kronecker_matrix);
+}
+
+// functions: manipulate
+
+void mul_kronecker_matrix_vector(MatrixOperation operation,
+                                 const KroneckerMatrixT *kronecker_matrix,
+                                 complex float alpha,
+                                 const complex float *vector,
+                                 complex float beta, complex float *result) {
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (kronecker_matrix == NULL || vector == NULL || result == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  if (alpha == 1.0f && beta == 0.0f) {
+    kronecker_mul(operation, kronecker_matrix, vector, result);
+    return;
+  }
+  size_t op_row = kronecker_matrix->size[operation == NO_TRANSPOSE ? 0 : 1];
+  complex float *product = matrix_malloc(op_row * sizeof(complex float));
+  kronecker_mul(operation, kronecker_matrix, vector, product);
+  if (beta == 0.0f) {
+    for (size_t i = 0; i < op_row; ++i) {
+      result[i] = alpha * product[i];
+    }
+  } else {
+    kernel_scal(op_row, beta, result);
+    kernel_axpy(op_row, alpha, product, result);
+  }
+  matrix_free(product);
+}
+
+MatrixOperatorT
+new_kronecker_matrix_operator(const KroneckerMatrixT *kronecker_matrix) {
+  // boundary test: null pointer
+  if (kronecker_matrix == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  // boundary tes: square matrix
+  if (kronecker_matrix->size[0] != kronecker_matrix->size[1]) {
+    log_error("panic: matrix must be squared at %s with size (%zu, %zu)",
+              __func__, kronecker_matrix->size[0], kronecker_matrix->size[1]);
+    exit(EXIT_FAILURE);
+  }
+  MatrixOperatorT kronecker_operator = {
+      .size = kronecker_matrix->size[0],
+      .apply = apply_kronecker_matrix,
+      .context = (void *)kronecker_matrix,
+  };
+  return kronecker_operator;
+}
@@ -5,22 +5,104 @@
 
 // include
 
+#include "alloc_matrix.h"
+#include "kernel_matrix.h"
 #include "matrix/matrix.h"
 #include "matrix/utils.h"
+#include "profile_matrix.h"
 #include <complex.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 
+// functions: helpers
+
+/**
+ * @brief the scratch buffers of a chain product, sub-products are done
+ *        depth first so the buffers are taken and given back as a stack
+ */
+typedef struct ChainPoolT {
+  size_t length;          ///< the capacity of every buffer
+  size_t top;             ///< the number of buffers in use
+  complex float **buffer; ///< the buffers, allocated when first taken
+} ChainPoolT;
+
+/**
+ * @brief C = A B for a step of a chain product, vectors go through the
+ *        matrix-vector kernel
+ *
+ * @param[in] m the row size of \p a and \p c
+ * @param[in] n the column size of \p b and \p c
+ * @param[in] k the column size of \p a and row size of \p b
+ * @param[in] a the left hand side block
+ * @param[in] b the right hand side block
+ * @param[out] c the product
+ */
+static void chain_gemm(size_t m, size_t n, size_t k, const complex float *a,
+                       const complex float *b, complex float *c) {
+  complex float one = new_complex(1.0f, 0.0f);
+  complex float zero = new_complex(0.0f, 0.0f);
+  if (n == 1) {
+    kernel_gemv(NO_TRANSPOSE, m, k, one, a, k, b, zero, c);
+  } else if (m == 1) {
+    kernel_gemv(TRANSPOSE, k, n, one, b, n, a, zero, c);
+  } else {
+    kernel_gemm(NO_TRANSPOSE, NO_TRANSPOSE, m, n, k, one, a, k, b, n, zero, c,
+                n);
+  }
+}
+
+/**
+ * @brief multiply matrices[first..last] by the split table into a buffer
+ *
+ * @param[in] matrices the chain
+ * @param[in] split the split table, the product of [i, j] is split after
+ *            split[i * count + j]
+ * @param[in] count the length of the chain
+ * @param[in] first the first matrix of the sub-chain
+ * @param[in] last the last matrix of the sub-chain
+ * @param[in,out] pool the scratch buffers
+ * @param[out] result the product of the sub-chain
+ */
+static void chain_mul(MatrixT **matrices, const size_t *split, size_t count,
+                      size_t first, size_t last, ChainPoolT *pool,
+                      complex float *result) {
+  size_t middle = split[first * count + last];
+  const complex float *operand[2];
+  size_t bounds[2][2] = {{first, middle}, {middle + 1, last}};
+  size_t taken = 0;
+  for (size_t side = 0; side < 2; ++side) {
+    if (bounds[side][0] == bounds[side][1]) {
+      operand[side] = matrices[bounds[side][0]]->data;
+      continue;
+    }
+    if (pool->buffer[pool->top] == NULL) {
+      pool->buffer[pool->top] =
+          matrix_malloc(pool->length * sizeof(complex float));
+    }
+    complex float *buffer = pool->buffer[pool->top++];
+    chain_mul(matrices, split, count, bounds[side][0], bounds[side][1], pool,
+              buffer);
+    operand[side] = buffer;
+    taken++;
+  }
+  chain_gemm(matrices[first]->size[0], matrices[last]->size[1],
+             matrices[middle]->size[1], operand[0], operand[1], result);
+  pool->top -= taken;
+}
+
 // functions: manipulate
 
 void show_matrix(const MatrixT *matrix) {
+  PROFILE_FUNCTION();
   // default precision: 4
   show_matrix_with_precision(matrix, 4);
 }
 
 void show_matrix_with_precision(const MatrixT *matrix, uint8_t precision) {
+  PROFILE_FUNCTION();
   // boundary test: null pointer
   if (matrix == NULL) {
     log_error("panic: null pointer error at %s", __func__);
@@ -45,6 +127,7 @@ void show_matrix_with_precision(const MatrixT *matrix, uint8_t precision) {
 }
 
 MatrixT *transpose_matrix(const MatrixT *matrix) {
+  PROFILE_FUNCTION();
   // boundary test: null pointer
   if (matrix == NULL) {
     log_error("panic: null pointer error at %s", __func__);
@@ -52,16 +135,65 @@ MatrixT *transpose_matrix(const MatrixT *matrix) {
   }
   // init: transposed matrix
   MatrixT *transposed_matrix = new_matrix(matrix->size[1], matrix->size[0]);
-  for (size_t i = 1; i <= matrix->size[0]; ++i) {
-    for (size_t j = 1; j <= matrix->size[1]; ++j) {
-      set_matrix_val(transposed_matrix, j, i, get_matrix_val(matrix, i, j));
-    }
-  }
+  kernel_transpose(matrix->size[0], matrix->size[1], matrix->data,
+                   matrix->size[1], transposed_matrix->data,
+                   transposed_matrix->size[1], false);
   // return: transposed matrix
   return transposed_matrix;
 }
 
+MatrixT *conjugate_transpose_matrix(const MatrixT *matrix) {
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (matrix == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  // init: conjugate transposed matrix
+  MatrixT *transposed_matrix = new_matrix(matrix->size[1], matrix->size[0]);
+  kernel_transpose(matrix->size[0], matrix->size[1], matrix->data,
+                   matrix->size[1], transposed_matrix->data,
+                   transposed_matrix->size[1], true);
+  // return: conjugate transposed matrix
+  return transposed_matrix;
+}
+
+void transpose_matrix_in_place(MatrixT *matrix) {
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (matrix == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  // boundary tes: square matrix
+  if (matrix->size[0] != matrix->size[1]) {
+    log_error("panic: matrix must be squared at %s with size (%u, %u)",
+              __func__, matrix->size[0], matrix->size[1]);
+    exit(EXIT_FAILURE);
+  }
+  kernel_transpose_in_place(matrix->size[0], matrix->data, matrix->size[1],
+                            false);
+}
+
+void conjugate_transpose_matrix_in_place(MatrixT *matrix) {
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (matrix == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  // boundary tes: square matrix
+  if (matrix->size[0] != matrix->size[1]) {
+    log_error("panic: matrix must be squared at %s with size (%u, %u)",
+              __func__, matrix->size[0], matrix->size[1]);
+    exit(EXIT_FAILURE);
+  }
+  kernel_transpose_in_place(matrix->size[0], matrix->data, matrix->size[1],
+                            true);
+}
+
 MatrixT *scalar_mul_matrix(complex float scalar, const MatrixT *matrix) {
+  PROFILE_FUNCTION();
   // boundary test: null pointer
   if (matrix == NULL) {
     log_error("panic: null pointer error at %s", __func__);
@@ -77,6 +209,7 @@ MatrixT *scalar_mul_matrix(complex float scalar, const MatrixT *matrix) {
 }
 
 MatrixT *add_matrix(const MatrixT *lsm, const MatrixT *rsm) {
+  PROFILE_FUNCTION();
   // boundary test: null pointer
   if (lsm == NULL || rsm == NULL) {
     log_error("panic: null pointer error at %s", __func__);
@@ -100,6 +233,7 @@ MatrixT *add_matrix(const MatrixT *lsm, const MatrixT *rsm) {
 }
 
 complex float vector_inner_product(const MatrixT *lhv, const MatrixT *rhv) {
+  PROFILE_FUNCTION();
   // boundary test: null pointer
   if (lhv == NULL || rhv == NULL) {
     log_error("panic: null pointer error at %s", __func__);
@@ -124,6 +258,7 @@ complex float vector_inner_product(const MatrixT *lhv, const MatrixT *rhv) {
 }
 
 MatrixT *vector_col_row_product(const MatrixT *lhv, const MatrixT *rhv) {
+  PROFILE_FUNCTION();
   // boundary test: null pointer
   if (lhv == NULL || rhv == NULL) {
     log_error("panic: null pointer error at %s", __func__);
@@ -139,16 +274,13 @@ MatrixT *vector_col_row_product(const MatrixT *lhv, const MatrixT *rhv) {
   // init: inner product
   MatrixT *inner_prod = new_matrix(lhv->size[0], rhv->size[1]);
   // do inner product
-  for (size_t i = 1; i <= lhv->size[0]; ++i) {
-    for (size_t j = 1; j <= rhv->size[1]; ++j) {
-      set_matrix_val(inner_prod, i, j,
-                     get_matrix_val(lhv, i, 1) * get_matrix_val(rhv, 1, j));
-    }
-  }
+  kernel_ger(lhv->size[0], rhv->size[1], new_complex(1.0f, 0.0f), lhv->data,
+             rhv->data, false, inner_prod->data, inner_prod->size[1]);
   return inner_prod;
 }
 
 MatrixT *vector_cross_product_3d(const MatrixT *lhv, const MatrixT *rhv) {
+  PROFILE_FUNCTION();
   // boundary test: null pointer
   if (lhv == NULL || rhv == NULL) {
     log_error("panic: null pointer error at %s", __func__);
@@ -180,51 +312,218 @@ MatrixT *vector_cross_product_3d(const MatrixT *lhv, const MatrixT *rhv) {
 }
 
 MatrixT *mul_matrix(const MatrixT *lhm, const MatrixT *rhm) {
+  PROFILE_FUNCTION();
+  return mul_matrix_with_operation(NO_TRANSPOSE, lhm, NO_TRANSPOSE, rhm);
+}
+
+MatrixT *mul_matrix_with_operation(MatrixOperation lhm_operation,
+                                   const MatrixT *lhm,
+                                   MatrixOperation rhm_operation,
+                                   const MatrixT *rhm) {
+  PROFILE_FUNCTION();
   // boundary test: null pointer
   if (lhm == NULL || rhm == NULL) {
     log_error("panic: null pointer error at %s", __func__);
     exit(EXIT_FAILURE);
   }
+  // get the size of op(lhm) and op(rhm)
+  bool lhm_trans = lhm_operation != NO_TRANSPOSE;
+  bool rhm_trans = rhm_operation != NO_TRANSPOSE;
+  uint8_t lhm_row = lhm->size[lhm_trans];
+  uint8_t lhm_col = lhm->size[!lhm_trans];
+  uint8_t rhm_row = rhm->size[rhm_trans];
+  uint8_t rhm_col = rhm->size[!rhm_trans];
   // boundary test: compitable size
-  if (lhm->size[1] != rhm->size[0]) {
+  if (lhm_col != rhm_row) {
     log_error(
         "panic: lhm size (%u, %u) is not compatible with rhm size (%u, %u)",
-        lhm->size[0], lhm->size[1], rhm->size[0], rhm->size[1]);
+        lhm_row, lhm_col, rhm_row, rhm_col);
     exit(EXIT_FAILURE);
   }
   // init: product matrix
-  MatrixT *prod_matrix = new_matrix(lhm->size[0], rhm->size[1]);
+  MatrixT *prod_matrix = new_matrix(lhm_row, rhm_col);
+  // vectors are contiguous in either orientation, as long as they are not
+  // conjugated they can go through the matrix-vector kernel
+  if (rhm_col == 1 && rhm_operation != CONJUGATE_TRANSPOSE) {
+    // op(lhm) x
+    kernel_gemv(lhm_operation, lhm->size[0], lhm->size[1],
+                new_complex(1.0f, 0.0f), lhm->data, lhm->size[1], rhm->data,
+                new_complex(0.0f, 0.0f), prod_matrix->data);
+    return prod_matrix;
+  }
+  if (lhm_row == 1 && lhm_operation != CONJUGATE_TRANSPOSE &&
+      rhm_operation != CONJUGATE_TRANSPOSE) {
+    // x^T op(rhm) = (op(rhm)^T x)^T
+    kernel_gemv(rhm_operation == NO_TRANSPOSE ? TRANSPOSE : NO_TRANSPOSE,
+                rhm->size[0], rhm->size[1], new_complex(1.0f, 0.0f),
+                rhm->data, rhm->size[1], lhm->data, new_complex(0.0f, 0.0f),
+                prod_matrix->data);
+    return prod_matrix;
+  }
   // do product
-  for (size_t i = 1; i <= lhm->size[1]; ++i) {
-    MatrixT *col_vector = get_matrix_col(lhm, i);
-    MatrixT *row_vector = get_matrix_row(rhm, i);
-    MatrixT *temp_matrix = vector_col_row_product(col_vector, row_vector);
-    drop_matrix(row_vector);
-    drop_matrix(col_vector);
-    MatrixT *new_prod_matrix = add_matrix(temp_matrix, prod_matrix);
-    drop_matrix(temp_matrix);
-    drop_matrix(prod_matrix);
-    prod_matrix = new_prod_matrix;
+  kernel_gemm(lhm_operation, rhm_operation, lhm_row, rhm_col, lhm_col,
+              new_complex(1.0f, 0.0f), lhm->data, lhm->size[1], rhm->data,
+              rhm->size[1], new_complex(0.0f, 0.0f), prod_matrix->data,
+              prod_matrix->size[1]);
+  // return: product matrix
+  return prod_matrix;
+}
+
+MatrixT *mul_matrix_chain(MatrixT **matrices, size_t matrices_number) {
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (matrices == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  // boundary test: empty chain
+  if (matrices_number == 0) {
+    log_error("panic: empty matrix chain at %s", __func__);
+    exit(EXIT_FAILURE);
   }
+  for (size_t i = 0; i < matrices_number; ++i) {
+    // boundary test: null pointer
+    if (matrices[i] == NULL) {
+      log_error("panic: null pointer error at %s", __func__);
+      exit(EXIT_FAILURE);
+    }
+    // boundary test: compitable size
+    if (i > 0 && matrices[i - 1]->size[1] != matrices[i]->size[0]) {
+      log_error("panic: lhm size (%u, %u) is not compatible with rhm size "
+                "(%u, %u) at %zu",
+                matrices[i - 1]->size[0], matrices[i - 1]->size[1],
+                matrices[i]->size[0], matrices[i]->size[1], i + 1);
+      exit(EXIT_FAILURE);
+    }
+  }
+  if (matrices_number == 1) {
+    return copy_matrix(matrices[0]);
+  }
+  size_t count = matrices_number;
+  // init: the cheapest cost and its split of every sub-chain [i, j]
+  uint64_t *cost = matrix_calloc(count * count, sizeof(uint64_t));
+  size_t *split = matrix_calloc(count * count, sizeof(size_t));
+  size_t longest = 0;
+  for (size_t length = 2; length <= count; ++length) {
+    for (size_t i = 0; i + length <= count; ++i) {
+      size_t j = i + length - 1;
+      uint64_t outer = (uint64_t)matrices[i]->size[0] * matrices[j]->size[1];
+      cost[i * count + j] = UINT64_MAX;
+      for (size_t k = i; k < j; ++k) {
+        uint64_t current = cost[i * count + k] + cost[(k + 1) * count + j] +
+                           outer * matrices[k]->size[1];
+        if (current < cost[i * count + j]) {
+          cost[i * count + j] = current;
+          split[i * count + j] = k;
+        }
+      }
+      longest = MAX(longest, outer);
+    }
+  }
+  // do product, intermediates never outlive their parent so at most one
+  // buffer per level is in use
+  ChainPoolT pool = {
+      .length = longest,
+      .top = 0,
+      .buffer = matrix_calloc(count, sizeof(complex float *)),
+  };
+  MatrixT *prod_matrix =
+      new_matrix(matrices[0]->size[0], matrices[count - 1]->size[1]);
+  chain_mul(matrices, split, count, 0, count - 1, &pool, prod_matrix->data);
+  for (size_t i = 0; i < count; ++i) {
+    matrix_free(pool.buffer[i]);
+  }
+  matrix_free(pool.buffer);
+  matrix_free(split);
+  matrix_free(cost);
+  // return: product matrix
   return prod_matrix;
 }
 
+MatrixT *mul_matrix_vector(MatrixOperation operation, const MatrixT *matrix,
+                           const MatrixT *vector) {
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (matrix == NULL || vector == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  // get the size of op(matrix)
+  bool matrix_trans = operation != NO_TRANSPOSE;
+  uint8_t matrix_row = matrix->size[matrix_trans];
+  uint8_t matrix_col = matrix->size[!matrix_trans];
+  // boundary test: vector
+  if (!((vector->size[0] == 1 || vector->size[1] == 1) &&
+        vector->size[0] * vector->size[1] == matrix_col)) {
+    log_error("panic: matrix size (%u, %u) is not compatible with vector "
+              "size (%u, %u)",
+              matrix_row, matrix_col, vector->size[0], vector->size[1]);
+    exit(EXIT_FAILURE);
+  }
+  // init: product vector
+  MatrixT *prod_vector = new_matrix(matrix_row, 1);
+  // do product
+  kernel_gemv(operation, matrix->size[0], matrix->size[1],
+              new_complex(1.0f, 0.0f), matrix->data, matrix->size[1],
+              vector->data, new_complex(0.0f, 0.0f), prod_vector->data);
+  // return: product vector
+  return prod_vector;
+}
+
+void rank_one_update_matrix(MatrixT *matrix, complex float alpha,
+                            const MatrixT *lhv, const MatrixT *rhv) {
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (matrix == NULL || lhv == NULL || rhv == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  // boundary test: vectors
+  if (!((lhv->size[0] == 1 || lhv->size[1] == 1) &&
+        (rhv->size[0] == 1 || rhv->size[1] == 1) &&
+        lhv->size[0] * lhv->size[1] == matrix->size[0] &&
+        rhv->size[0] * rhv->size[1] == matrix->size[1])) {
+    log_error("panic: matrix size (%u, %u) is not compatible with lhv size "
+              "(%u, %u) and rhv size (%u, %u)",
+              matrix->size[0], matrix->size[1], lhv->size[0], lhv->size[1],
+              rhv->size[0], rhv->size[1]);
+    exit(EXIT_FAILURE);
+  }
+  // do update
+  kernel_ger(matrix->size[0], matrix->size[1], alpha, lhv->data, rhv->data,
+             false, matrix->data, matrix->size[1]);
+}
+
 MatrixT *tensor_product_matrix(const MatrixT *lhm, const MatrixT *rhm) {
+  PROFILE_FUNCTION();
   // boundary test: null pointer
   if (lhm == NULL || rhm == NULL) {
     log_error("panic: null pointer error at %s", __func__);
     exit(EXIT_FAILURE);
   }
+  // boundary test: size
+  size_t product_row = (size_t)lhm->size[0] * rhm->size[0];
+  size_t product_col = (size_t)lhm->size[1] * rhm->size[1];
+  if (product_row > UINT8_MAX || product_col > UINT8_MAX) {
+    log_error("panic: Kronecker product size (%zu, %zu) is over the size of "
+              "a matrix",
+              product_row, product_col);
+    exit(EXIT_FAILURE);
+  }
   // init: Kronecker Product
-  MatrixT *kronecker_product_matrix =
-      new_matrix(lhm->size[0] * rhm->size[0], lhm->size[1] * rhm->size[1]);
-  for (uint8_t i = 1; i <= lhm->size[0]; ++i) {
-    for (uint8_t j = 1; j <= lhm->size[1]; ++j) {
-      for (uint8_t x = 1; x <= rhm->size[0]; ++x) {
-        for (uint8_t y = 1; y <= rhm->size[1]; ++y) {
-          set_matrix_val(kronecker_product_matrix, rhm->size[0] * (i - 1) + x,
-                         rhm->size[1] * (j - 1) + y,
-                         get_matrix_val(lhm, i, j) * get_matrix_val(rhm, x, y));
+  MatrixT *kronecker_product_matrix = new_matrix(product_row, product_col);
+  // a row of the product is a row of rhm scaled by every value of a row of
+  // lhm, so it is written in order
+  size_t rhm_col = rhm->size[1];
+  for (size_t i = 0; i < lhm->size[0]; ++i) {
+    const complex float *lhm_row = lhm->data + i * lhm->size[1];
+    for (size_t x = 0; x < rhm->size[0]; ++x) {
+      const complex float *rhm_row = rhm->data + x * rhm_col;
+      complex float *product_data = kronecker_product_matrix->data +
+                                    (i * rhm->size[0] + x) * product_col;
+      for (size_t j = 0; j < lhm->size[1]; ++j) {
+        for (size_t y = 0; y < rhm_col; ++y) {
+          product_data[j * rhm_col + y] = lhm_row[j] * rhm_row[y];
         }
       }
     }
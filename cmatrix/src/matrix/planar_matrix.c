@@ -0,0 +1,311 @@
+/**
+ * @file matrix/planar_matrix.c
+ * @brief planar matrices of matrix library
+ */
+
+// include
+
+#include "alloc_matrix.h"
+#include "kernel_matrix.h"
+#include "matrix/matrix.h"
+#include "matrix/matrix_planar.h"
+#include "matrix/utils.h"
+#include "profile_matrix.h"
+#include <complex.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// functions: helpers
+
+/**
+ * @brief check that two planar matrices have the same size
+ *
+ * @param[in] lhs the left hand side planar matrix
+ * @param[in] rhs the right hand side planar matrix
+ */
+static void check_same_size(const PlanarMatrixT *lhs,
+                            const PlanarMatrixT *rhs) {
+  // boundary test: null pointer
+  if (lhs == NULL || rhs == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  // boundary test: equal size
+  if (lhs->size[0] != rhs->size[0] || lhs->size[1] != rhs->size[1]) {
+    log_error(
+        "panic: lhs size (%u, %u) is not compatible with rhs size (%u, %u)",
+        lhs->size[0], lhs->size[1], rhs->size[0], rhs->size[1]);
+    exit(EXIT_FAILURE);
+  }
+}
+
+/**
+ * @brief check that a matrix and a planar matrix have the same size
+ *
+ * @param[in] matrix the matrix
+ * @param[in] planar_matrix the planar matrix
+ */
+static void check_matrix_size(const MatrixT *matrix,
+                              const PlanarMatrixT *planar_matrix) {
+  // boundary test: null pointer
+  if (matrix == NULL || planar_matrix == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  // boundary test: equal size
+  if (matrix->size[0] != planar_matrix->size[0] ||
+      matrix->size[1] != planar_matrix->size[1]) {
+    log_error("panic: matrix size (%u, %u) is not compatible with planar "
+              "matrix size (%u, %u)",
+              matrix->size[0], matrix->size[1], planar_matrix->size[0],
+              planar_matrix->size[1]);
+    exit(EXIT_FAILURE);
+  }
+}
+
+// functions: init
+
+PlanarMatrixT *new_planar_matrix(uint8_t row, uint8_t col) {
+  PROFILE_FUNCTION();
+  // boundary test: size
+  if (row == 0 || col == 0) {
+    log_error("panic: size must bigger than 0");
+    exit(EXIT_FAILURE);
+  }
+  PlanarMatrixT *planar_matrix = matrix_malloc(sizeof(PlanarMatrixT));
+  planar_matrix->size[0] = row;
+  planar_matrix->size[1] = col;
+  // the two parts share one allocation
+  planar_matrix->real = matrix_calloc(2 * (size_t)row * col, sizeof(float));
+  planar_matrix->imag = planar_matrix->real + (size_t)row * col;
+  return planar_matrix;
+}
+
+PlanarMatrixT *new_planar_matrix_from_matrix(const MatrixT *matrix) {
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (matrix == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  PlanarMatrixT *planar_matrix =
+      new_planar_matrix(matrix->size[0], matrix->size[1]);
+  load_planar_matrix(matrix, planar_matrix);
+  return planar_matrix;
+}
+
+MatrixT *new_matrix_from_planar_matrix(const PlanarMatrixT *planar_matrix) {
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (planar_matrix == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  MatrixT *matrix = new_matrix(planar_matrix->size[0], planar_matrix->size[1]);
+  store_planar_matrix(planar_matrix, matrix);
+  return matrix;
+}
+
+void load_planar_matrix(const MatrixT *matrix, PlanarMatrixT *planar_matrix) {
+  PROFILE_FUNCTION();
+  check_matrix_size(matrix, planar_matrix);
+  size_t size = (size_t)matrix->size[0] * matrix->size[1];
+  // the values are read as pairs of floats so that the loop vectorizes
+  const float *values = (const float *)matrix->data;
+  float *real = planar_matrix->real;
+  float *imag = planar_matrix->imag;
+  for (size_t i = 0; i < size; ++i) {
+    real[i] = values[2 * i];
+    imag[i] = values[2 * i + 1];
+  }
+}
+
+void store_planar_matrix(const PlanarMatrixT *planar_matrix, MatrixT *matrix) {
+  PROFILE_FUNCTION();
+  check_matrix_size(matrix, planar_matrix);
+  size_t size = (size_t)matrix->size[0] * matrix->size[1];
+  float *values = (float *)matrix->data;
+  const float *real = planar_matrix->real;
+  const float *imag = planar_matrix->imag;
+  for (size_t i = 0; i < size; ++i) {
+    values[2 * i] = real[i];
+    values[2 * i + 1] = imag[i];
+  }
+}
+
+PlanarMatrixT *copy_planar_matrix(const PlanarMatrixT *planar_matrix) {
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (planar_matrix == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  PlanarMatrixT *copied_matrix =
+      new_planar_matrix(planar_matrix->size[0], planar_matrix->size[1]);
+  size_t size = (size_t)planar_matrix->size[0] * planar_matrix->size[1];
+  memcpy(copied_matrix->real, planar_matrix->real, size * sizeof(float));
+  memcpy(copied_matrix->imag, planar_matrix->imag, size * sizeof(float));
+  return copied_matrix;
+}
+
+void drop_planar_matrix(PlanarMatrixT *planar_matrix) {
+  PROFILE_FUNCTION();
+  // if matrix is null, it's fine
+  if (planar_matrix == NULL) {
+    return;
+  }
+  // imag is in the allocation of real
+  matrix_free(planar_matrix->real);
+  matrix_free(planar_matrix);
+}
+
+// functions: attribute
+
+complex float get_planar_matrix_trace(const PlanarMatrixT *planar_matrix) {
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (planar_matrix == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  // boundary tes: square matrix
+  if (planar_matrix->size[0] != planar_matrix->size[1]) {
+    log_error("panic: matrix must be squared at %s with size (%u, %u)",
+              __func__, planar_matrix->size[0], planar_matrix->size[1]);
+    exit(EXIT_FAILURE);
+  }
+  size_t n = planar_matrix->size[0];
+  float real = 0.0f;
+  float imag = 0.0f;
+  for (size_t i = 0; i < n; ++i) {
+    real += planar_matrix->real[i * n + i];
+    imag += planar_matrix->imag[i * n + i];
+  }
+  return new_complex(real, imag);
+}
+
+complex float get_planar_matrix_sum(const PlanarMatrixT *planar_matrix) {
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (planar_matrix == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  size_t size = (size_t)planar_matrix->size[0] * planar_matrix->size[1];
+  float real = 0.0f;
+  float imag = 0.0f;
+  for (size_t i = 0; i < size; ++i) {
+    real += planar_matrix->real[i];
+    imag += planar_matrix->imag[i];
+  }
+  return new_complex(real, imag);
+}
+
+float get_planar_matrix_frobenius_norm(const PlanarMatrixT *planar_matrix) {
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (planar_matrix == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  size_t size = (size_t)planar_matrix->size[0] * planar_matrix->size[1];
+  float square = 0.0f;
+  for (size_t i = 0; i < size; ++i) {
+    square += planar_matrix->real[i] * planar_matrix->real[i];
+  }
+  for (size_t i = 0; i < size; ++i) {
+    square += planar_matrix->imag[i] * planar_matrix->imag[i];
+  }
+  return sqrtf(square);
+}
+
+// functions: manipulate
+
+PlanarMatrixT *scalar_mul_planar_matrix(complex float scalar,
+                                        const PlanarMatrixT *planar_matrix) {
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (planar_matrix == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  PlanarMatrixT *product =
+      new_planar_matrix(planar_matrix->size[0], planar_matrix->size[1]);
+  size_t size = (size_t)planar_matrix->size[0] * planar_matrix->size[1];
+  float sr = crealf(scalar);
+  float si = cimagf(scalar);
+  for (size_t i = 0; i < size; ++i) {
+    float real = planar_matrix->real[i];
+    float imag = planar_matrix->imag[i];
+    product->real[i] = sr * real - si * imag;
+    product->imag[i] = sr * imag + si * real;
+  }
+  return product;
+}
+
+PlanarMatrixT *add_planar_matrix(const PlanarMatrixT *lhs,
+                                 const PlanarMatrixT *rhs) {
+  PROFILE_FUNCTION();
+  check_same_size(lhs, rhs);
+  PlanarMatrixT *sum = new_planar_matrix(lhs->size[0], lhs->size[1]);
+  size_t size = (size_t)lhs->size[0] * lhs->size[1];
+  for (size_t i = 0; i < size; ++i) {
+    sum->real[i] = lhs->real[i] + rhs->real[i];
+  }
+  for (size_t i = 0; i < size; ++i) {
+    sum->imag[i] = lhs->imag[i] + rhs->imag[i];
+  }
+  return sum;
+}
+
+PlanarMatrixT *hadamard_planar_matrix(const PlanarMatrixT *lhs,
+                                      const PlanarMatrixT *rhs) {
+  PROFILE_FUNCTION();
+  check_same_size(lhs, rhs);
+  PlanarMatrixT *product = new_planar_matrix(lhs->size[0], lhs->size[1]);
+  size_t size = (size_t)lhs->size[0] * lhs->size[1];
+  // no shuffle is needed, every part is a plain array
+  for (size_t i = 0; i < size; ++i) {
+    float lr = lhs->real[i];
+    float li = lhs->imag[i];
+    float rr = rhs->real[i];
+    float ri = rhs->imag[i];
+    product->real[i] = lr * rr - li * ri;
+    product->imag[i] = lr * ri + li * rr;
+  }
+  return product;
+}
+
+PlanarMatrixT *mul_planar_matrix(const PlanarMatrixT *lhs,
+                                 const PlanarMatrixT *rhs) {
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (lhs == NULL || rhs == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  // boundary test: compitable size
+  if (lhs->size[1] != rhs->size[0]) {
+    log_error(
+        "panic: lhs size (%u, %u) is not compatible with rhs size (%u, %u)",
+        lhs->size[0], lhs->size[1], rhs->size[0], rhs->size[1]);
+    exit(EXIT_FAILURE);
+  }
+  size_t m = lhs->size[0];
+  size_t k = lhs->size[1];
+  size_t n = rhs->size[1];
+  PlanarMatrixT *product = new_planar_matrix(m, n);
+  // Re(AB) = Ar Br - Ai Bi, Im(AB) = Ar Bi + Ai Br
+  kernel_real_gemm(m, n, k, 1.0f, lhs->real, k, rhs->real, n, 0.0f,
+                   product->real, n);
+  kernel_real_gemm(m, n, k, -1.0f, lhs->imag, k, rhs->imag, n, 1.0f,
+                   product->real, n);
+  kernel_real_gemm(m, n, k, 1.0f, lhs->real, k, rhs->imag, n, 0.0f,
+                   product->imag, n);
+  kernel_real_gemm(m, n, k, 1.0f, lhs->imag, k, rhs->real, n, 1.0f,
+                   product->imag, n);
+  return product;
+}
@@ -0,0 +1,441 @@
+/**
+ * @file matrix/profile_matrix.c
+ * @brief profiling of matrix library
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+// include
+
+#include "profile_matrix.h"
+#include "matrix/matrix_profile.h"
+#include "matrix/utils.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// types
+
+/**
+ * @brief the counters of a function in a thread, they are only written by
+ *        the owner thread and read by any thread
+ */
+typedef struct ProfileCounterT {
+  _Atomic uint64_t calls;    ///< the number of calls
+  _Atomic uint64_t total_ns; ///< the cumulative time of the calls
+  _Atomic uint64_t max_ns;   ///< the time of the longest call
+  _Atomic uint64_t byte;     ///< the allocated bytes of the calls
+  _Atomic uint64_t flop;     ///< the flops of the calls
+} ProfileCounterT;
+
+/**
+ * @brief a finished call kept for the trace
+ */
+typedef struct ProfileEventT {
+  size_t site;       ///< the index of the site
+  uint64_t start;    ///< the start time in nanoseconds
+  uint64_t duration; ///< the duration in nanoseconds
+  uint64_t byte;     ///< the allocated bytes of the call
+  uint64_t flop;     ///< the flops of the call
+} ProfileEventT;
+
+/**
+ * @brief the records of a thread
+ */
+typedef struct ProfileBufferT {
+  struct ProfileBufferT *next;               ///< the buffer of another thread
+  size_t thread_index;                       ///< the index of the thread
+  uint64_t byte;                             ///< the bytes allocated so far
+  uint64_t flop;                             ///< the flops done so far
+  ProfileCounterT counter[PROFILE_MAX_SITE]; ///< the counters of the sites
+  atomic_flag event_lock;                    ///< guards the events
+  ProfileEventT *event;                      ///< the events of the trace
+  size_t event_number;                       ///< the number of events
+  size_t event_capacity;                     ///< the capacity of the events
+} ProfileBufferT;
+
+// variables
+
+/**
+ * @brief whether calls are recorded
+ */
+static atomic_bool profile_recording = false;
+
+/**
+ * @brief whether calls are kept for the trace
+ */
+static atomic_bool profile_tracing = false;
+
+/**
+ * @brief guards the sites, the buffers and the time origin
+ */
+static atomic_flag profile_lock = ATOMIC_FLAG_INIT;
+
+/**
+ * @brief the names of the registered sites
+ */
+static const char *profile_names[PROFILE_MAX_SITE];
+
+/**
+ * @brief the number of the registered sites
+ */
+static size_t profile_site_number = 0;
+
+/**
+ * @brief the buffers of all threads which have recorded
+ */
+static ProfileBufferT *profile_buffers = NULL;
+
+/**
+ * @brief the number of the buffers
+ */
+static size_t profile_thread_number = 0;
+
+/**
+ * @brief the time origin of the trace
+ */
+static uint64_t profile_origin = 0;
+
+/**
+ * @brief the buffer of this thread
+ */
+static _Thread_local ProfileBufferT *profile_buffer = NULL;
+
+_Thread_local ProfileSiteT *profile_entry = NULL;
+
+// functions: helpers
+
+/**
+ * @brief get the monotonic time
+ *
+ * @return the time in nanoseconds
+ */
+static uint64_t get_time_ns(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+/**
+ * @brief spin until a lock is taken, the locks are only contended while
+ *        threads register or the records are read
+ *
+ * @param[in] lock the lock to take
+ */
+static void lock_profile(atomic_flag *lock) {
+  while (atomic_flag_test_and_set_explicit(lock, memory_order_acquire)) {
+  }
+}
+
+/**
+ * @brief release a lock
+ *
+ * @param[in] lock the lock to release
+ */
+static void unlock_profile(atomic_flag *lock) {
+  atomic_flag_clear_explicit(lock, memory_order_release);
+}
+
+/**
+ * @brief add to a counter owned by this thread, a plain load and store is
+ *        enough as no other thread writes it
+ *
+ * @param[in,out] counter the counter
+ * @param[in] value the value to add
+ */
+static void add_counter(_Atomic uint64_t *counter, uint64_t value) {
+  atomic_store_explicit(
+      counter, atomic_load_explicit(counter, memory_order_relaxed) + value,
+      memory_order_relaxed);
+}
+
+/**
+ * @brief get the buffer of this thread, it is registered on first use
+ *
+ * @return the buffer
+ */
+static ProfileBufferT *get_buffer(void) {
+  if (profile_buffer == NULL) {
+    ProfileBufferT *buffer = calloc(1, sizeof(ProfileBufferT));
+    atomic_flag_clear(&buffer->event_lock);
+    lock_profile(&profile_lock);
+    buffer->thread_index = ++profile_thread_number;
+    buffer->next = profile_buffers;
+    profile_buffers = buffer;
+    unlock_profile(&profile_lock);
+    profile_buffer = buffer;
+  }
+  return profile_buffer;
+}
+
+/**
+ * @brief get the index of a site, it is registered on first use
+ *
+ * @param[in] site the site
+ * @return the index, or PROFILE_MAX_SITE if there is no free site
+ */
+static size_t get_site(ProfileSiteT *site) {
+  size_t id = atomic_load_explicit(&site->id, memory_order_acquire);
+  if (id == 0) {
+    lock_profile(&profile_lock);
+    id = atomic_load_explicit(&site->id, memory_order_relaxed);
+    if (id == 0 && profile_site_number < PROFILE_MAX_SITE) {
+      profile_names[profile_site_number] = site->name;
+      id = ++profile_site_number;
+      atomic_store_explicit(&site->id, id, memory_order_release);
+    }
+    unlock_profile(&profile_lock);
+  }
+  return id == 0 ? PROFILE_MAX_SITE : id - 1;
+}
+
+/**
+ * @brief compare records by cumulative time for qsort, longest first
+ */
+static int compare_record(const void *lhs, const void *rhs) {
+  uint64_t l = ((const ProfileRecordT *)lhs)->total_ns;
+  uint64_t r = ((const ProfileRecordT *)rhs)->total_ns;
+  return (l < r) - (l > r);
+}
+
+// functions: hooks
+
+ProfileFrameT profile_enter(ProfileSiteT *site) {
+  ProfileFrameT frame = {NULL, profile_enter_entry(site), 0, 0, 0};
+#ifdef MATRIX_PROFILE
+  if (!atomic_load_explicit(&profile_recording, memory_order_relaxed)) {
+    return frame;
+  }
+  ProfileBufferT *buffer = get_buffer();
+  frame.site = site;
+  frame.byte = buffer->byte;
+  frame.flop = buffer->flop;
+  frame.start = get_time_ns();
+#endif
+  return frame;
+}
+
+void profile_leave(ProfileFrameT *frame) {
+  profile_leave_entry(&frame->outermost);
+  if (frame->site == NULL) {
+    return;
+  }
+  uint64_t duration = get_time_ns() - frame->start;
+  size_t id = get_site(frame->site);
+  if (id == PROFILE_MAX_SITE) {
+    return;
+  }
+  ProfileBufferT *buffer = profile_buffer;
+  uint64_t byte = buffer->byte - frame->byte;
+  uint64_t flop = buffer->flop - frame->flop;
+  ProfileCounterT *counter = &buffer->counter[id];
+  add_counter(&counter->calls, 1);
+  add_counter(&counter->total_ns, duration);
+  add_counter(&counter->byte, byte);
+  add_counter(&counter->flop, flop);
+  if (duration > atomic_load_explicit(&counter->max_ns, memory_order_relaxed)) {
+    atomic_store_explicit(&counter->max_ns, duration, memory_order_relaxed);
+  }
+  if (!atomic_load_explicit(&profile_tracing, memory_order_relaxed)) {
+    return;
+  }
+  lock_profile(&buffer->event_lock);
+  // grow the events by doubling
+  if (buffer->event_number == buffer->event_capacity) {
+    buffer->event_capacity = MAX(buffer->event_capacity * 2, 1024);
+    buffer->event =
+        realloc(buffer->event, buffer->event_capacity * sizeof(ProfileEventT));
+  }
+  buffer->event[buffer->event_number++] = (ProfileEventT){
+      .site = id,
+      .start = frame->start,
+      .duration = duration,
+      .byte = byte,
+      .flop = flop,
+  };
+  unlock_profile(&buffer->event_lock);
+}
+
+void profile_add_byte(uint64_t byte) {
+  if (atomic_load_explicit(&profile_recording, memory_order_relaxed)) {
+    get_buffer()->byte += byte;
+  }
+}
+
+void profile_add_flop(uint64_t flop) {
+  if (atomic_load_explicit(&profile_recording, memory_order_relaxed)) {
+    get_buffer()->flop += flop;
+  }
+}
+
+// functions: sites
+
+size_t profile_entry_site(void) {
+  return profile_entry == NULL ? PROFILE_MAX_SITE : get_site(profile_entry);
+}
+
+const char *profile_site_name(size_t id) {
+  if (id >= PROFILE_MAX_SITE) {
+    return "(outside)";
+  }
+  lock_profile(&profile_lock);
+  const char *name = profile_names[id];
+  unlock_profile(&profile_lock);
+  return name;
+}
+
+// functions: control
+
+bool is_matrix_profile_available(void) {
+#ifdef MATRIX_PROFILE
+  return true;
+#else
+  return false;
+#endif
+}
+
+void start_matrix_profile(bool trace) {
+  if (!is_matrix_profile_available()) {
+    log_warn("warn: profile is not compiled in, configure with "
+             "-Dprofile=true");
+  }
+  lock_profile(&profile_lock);
+  if (profile_origin == 0) {
+    profile_origin = get_time_ns();
+  }
+  unlock_profile(&profile_lock);
+  atomic_store(&profile_tracing, trace);
+  atomic_store(&profile_recording, true);
+}
+
+void stop_matrix_profile(void) {
+  atomic_store(&profile_recording, false);
+  atomic_store(&profile_tracing, false);
+}
+
+void reset_matrix_profile(void) {
+  lock_profile(&profile_lock);
+  for (ProfileBufferT *buffer = profile_buffers; buffer != NULL;
+       buffer = buffer->next) {
+    for (size_t i = 0; i < profile_site_number; ++i) {
+      ProfileCounterT *counter = &buffer->counter[i];
+      atomic_store(&counter->calls, 0);
+      atomic_store(&counter->total_ns, 0);
+      atomic_store(&counter->max_ns, 0);
+      atomic_store(&counter->byte, 0);
+      atomic_store(&counter->flop, 0);
+    }
+    lock_profile(&buffer->event_lock);
+    buffer->event_number = 0;
+    unlock_profile(&buffer->event_lock);
+  }
+  profile_origin = get_time_ns();
+  unlock_profile(&profile_lock);
+}
+
+// functions: report
+
+ProfileRecordT *get_matrix_profile(size_t *record_number) {
+  // boundary test: null pointer
+  if (record_number == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  lock_profile(&profile_lock);
+  size_t site_number = profile_site_number;
+  // the array is given to the user, so it stays out of the accounting
+  ProfileRecordT *records = calloc(MAX(site_number, 1), sizeof(ProfileRecordT));
+  if (records == NULL) {
+    unlock_profile(&profile_lock);
+    log_error("panic: failed to allocate %zu profile records", site_number);
+    exit(EXIT_FAILURE);
+  }
+  for (size_t i = 0; i < site_number; ++i) {
+    records[i].name = profile_names[i];
+  }
+  // merge the counters of all threads
+  for (ProfileBufferT *buffer = profile_buffers; buffer != NULL;
+       buffer = buffer->next) {
+    for (size_t i = 0; i < site_number; ++i) {
+      ProfileCounterT *counter = &buffer->counter[i];
+      records[i].calls += atomic_load(&counter->calls);
+      records[i].total_ns += atomic_load(&counter->total_ns);
+      records[i].max_ns =
+          MAX(records[i].max_ns, atomic_load(&counter->max_ns));
+      records[i].byte += atomic_load(&counter->byte);
+      records[i].flop += atomic_load(&counter->flop);
+    }
+  }
+  unlock_profile(&profile_lock);
+  // keep the functions which are called
+  size_t number = 0;
+  for (size_t i = 0; i < site_number; ++i) {
+    if (records[i].calls > 0) {
+      records[number++] = records[i];
+    }
+  }
+  *record_number = number;
+  if (number == 0) {
+    free(records);
+    return NULL;
+  }
+  qsort(records, number, sizeof(ProfileRecordT), compare_record);
+  return records;
+}
+
+void show_matrix_profile(void) {
+  size_t record_number = 0;
+  ProfileRecordT *records = get_matrix_profile(&record_number);
+  printf("%-36s %10s %12s %12s %12s %14s %10s\n", "function", "calls",
+         "total (ms)", "mean (us)", "max (us)", "bytes", "GFLOP/s");
+  for (size_t i = 0; i < record_number; ++i) {
+    ProfileRecordT *record = &records[i];
+    printf("%-36s %10llu %12.3f %12.3f %12.3f %14llu %10.3f\n", record->name,
+           (unsigned long long)record->calls, record->total_ns / 1e6,
+           record->total_ns / 1e3 / record->calls, record->max_ns / 1e3,
+           (unsigned long long)record->byte,
+           record->total_ns > 0 ? (double)record->flop / record->total_ns
+                                : 0.0);
+  }
+  free(records);
+}
+
+void save_matrix_profile_trace(const char *file_path) {
+  // test: open file
+  FILE *file_handle = fopen(file_path, "w");
+  if (file_handle == NULL) {
+    log_error("panic: failed to open file (%.64s)", file_path);
+    exit(EXIT_FAILURE);
+  }
+  fputs("{\"displayTimeUnit\": \"ns\", \"traceEvents\": [", file_handle);
+  bool first = true;
+  lock_profile(&profile_lock);
+  for (ProfileBufferT *buffer = profile_buffers; buffer != NULL;
+       buffer = buffer->next) {
+    lock_profile(&buffer->event_lock);
+    for (size_t i = 0; i < buffer->event_number; ++i) {
+      ProfileEventT *event = &buffer->event[i];
+      // a complete event, the time is in microseconds
+      fprintf(file_handle,
+              "%s\n{\"name\": \"%s\", \"cat\": \"matrix\", \"ph\": \"X\", "
+              "\"ts\": %.3f, \"dur\": %.3f, \"pid\": 1, \"tid\": %zu, "
+              "\"args\": {\"bytes\": %llu, \"flops\": %llu}}",
+              first ? "" : ",", profile_names[event->site],
+              event->start > profile_origin
+                  ? (event->start - profile_origin) / 1e3
+                  : 0.0,
+              event->duration / 1e3, buffer->thread_index,
+              (unsigned long long)event->byte,
+              (unsigned long long)event->flop);
+      first = false;
+    }
+    unlock_profile(&buffer->event_lock);
+  }
+  unlock_profile(&profile_lock);
+  fputs("\n]}\n", file_handle);
+  fclose(file_handle);
+}
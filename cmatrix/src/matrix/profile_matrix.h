@@ -0,0 +1,179 @@
+/**
+ * @file matrix/profile_matrix.h
+ * @brief internal profiling hooks of matrix library
+ *
+ * a public function starts with PROFILE_FUNCTION(), the outermost one of a
+ * thread is the entry which allocations are attributed to, and with
+ * MATRIX_PROFILE (set by the profile option of meson) the call is also timed,
+ * kernels report their flops with PROFILE_FLOP() and allocations report their
+ * bytes with PROFILE_BYTE(), both are empty without MATRIX_PROFILE
+ *
+ * without MATRIX_PROFILE only the entry is kept, by an inline check of a
+ * thread-local pointer, so no function of this file is called
+ */
+
+#pragma once
+#ifndef __MATRIX_PROFILE_MATRIX_H__
+#define __MATRIX_PROFILE_MATRIX_H__
+
+// include
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// constants
+
+/**
+ * \def PROFILE_MAX_SITE
+ *
+ * the maximum number of profiled functions, it is also the index of the site
+ * of everything outside them
+ */
+#define PROFILE_MAX_SITE 256
+
+// types
+
+/**
+ * @brief a profiled function, one static site per function
+ */
+typedef struct ProfileSiteT {
+  const char *name; ///< the name of the function
+  atomic_size_t id; ///< the index of the site from 1, 0 before registration
+} ProfileSiteT;
+
+/**
+ * @brief a call in progress of a profiled function
+ */
+typedef struct ProfileFrameT {
+  ProfileSiteT *site; ///< the site of the call, NULL if it is not recorded
+  bool outermost;     ///< whether the call is the entry of the thread
+  uint64_t start;     ///< the start time in nanoseconds
+  uint64_t byte;      ///< the allocated bytes of the thread at the start
+  uint64_t flop;      ///< the flops of the thread at the start
+} ProfileFrameT;
+
+// variables
+
+/**
+ * @brief the site of the outermost profiled call of this thread
+ */
+extern _Thread_local ProfileSiteT *profile_entry;
+
+// functions: entry
+
+/**
+ * @brief mark a site as the entry of this thread if no call is in progress
+ *
+ * @param[in] site the site of the function
+ * @return whether the call is the entry
+ */
+static inline bool profile_enter_entry(ProfileSiteT *site) {
+  if (profile_entry != NULL) {
+    return false;
+  }
+  profile_entry = site;
+  return true;
+}
+
+/**
+ * @brief clear the entry of this thread when the entry call returns
+ *
+ * @param[in] outermost whether the call is the entry
+ */
+static inline void profile_leave_entry(bool *outermost) {
+  if (*outermost) {
+    profile_entry = NULL;
+  }
+}
+
+// functions: hooks
+
+/**
+ * @brief start a call of a profiled function
+ *
+ * @param[in] site the site of the function
+ * @return the frame of the call
+ */
+extern ProfileFrameT profile_enter(ProfileSiteT *site);
+
+/**
+ * @brief finish a call of a profiled function and record it
+ *
+ * @param[in] frame the frame of the call
+ */
+extern void profile_leave(ProfileFrameT *frame);
+
+/**
+ * @brief add allocated bytes to the calls in progress of this thread
+ *
+ * @param[in] byte the allocated bytes
+ */
+extern void profile_add_byte(uint64_t byte);
+
+/**
+ * @brief add flops to the calls in progress of this thread
+ *
+ * @param[in] flop the number of real floating-point operations
+ */
+extern void profile_add_flop(uint64_t flop);
+
+// functions: sites
+
+/**
+ * @brief get the site of the outermost profiled call of this thread
+ *
+ * @return the index of the site, or PROFILE_MAX_SITE outside of the calls
+ */
+extern size_t profile_entry_site(void);
+
+/**
+ * @brief get the name of a site
+ *
+ * @param[in] id the index of the site
+ * @return the name of the function
+ */
+extern const char *profile_site_name(size_t id);
+
+// macros
+
+#ifdef MATRIX_PROFILE
+
+/**
+ * \def PROFILE_FUNCTION ()
+ *
+ * record the enclosing function until it returns, the frame is closed by
+ * the cleanup attribute of GCC and Clang
+ */
+#define PROFILE_FUNCTION()                                                     \
+  static ProfileSiteT profile_site = {__func__, 0};                            \
+  ProfileFrameT profile_frame __attribute__((cleanup(profile_leave))) =        \
+      profile_enter(&profile_site)
+
+/**
+ * \def PROFILE_BYTE (byte)
+ *
+ * count \p byte allocated bytes
+ */
+#define PROFILE_BYTE(byte) profile_add_byte(byte)
+
+/**
+ * \def PROFILE_FLOP (flop)
+ *
+ * count \p flop real floating-point operations
+ */
+#define PROFILE_FLOP(flop) profile_add_flop(flop)
+
+#else
+
+#define PROFILE_FUNCTION()                                                     \
+  static ProfileSiteT profile_site = {__func__, 0};                            \
+  bool profile_outermost __attribute__((cleanup(profile_leave_entry))) =       \
+      profile_enter_entry(&profile_site)
+#define PROFILE_BYTE(byte) ((void)0)
+#define PROFILE_FLOP(flop) ((void)0)
+
+#endif
+
+#endif
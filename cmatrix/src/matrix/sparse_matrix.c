@@ -0,0 +1,668 @@
+/**
+ * @file matrix/sparse_matrix.c
+ * @brief sparse matrices of matrix library
+ */
+
+// include
+
+#include "alloc_matrix.h"
+#include "kernel_matrix.h"
+#include "matrix/matrix.h"
+#include "matrix/matrix_iter.h"
+#include "matrix/matrix_sparse.h"
+#include "matrix/utils.h"
+#include "profile_matrix.h"
+#include <complex.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+// functions: helpers
+
+/**
+ * @brief allocate a sparse matrix with all arrays of a format
+ *
+ * @param[in] format the storage format
+ * @param[in] row the row size of matrix
+ * @param[in] col the column size of matrix
+ * @param[in] capacity the number of values to reserve
+ * @return the sparse matrix without value
+ */
+static SparseMatrixT *alloc_sparse_matrix(SparseFormat format, size_t row,
+                                          size_t col, size_t capacity) {
+  // boundary test: size
+  if (row == 0 || col == 0) {
+    log_error("panic: sparse matrix size (%zu, %zu) is illegal", row, col);
+    exit(EXIT_FAILURE);
+  }
+  capacity = MAX(capacity, 1);
+  SparseMatrixT *sparse_matrix = matrix_malloc(sizeof(SparseMatrixT));
+  sparse_matrix->format = format;
+  sparse_matrix->size[0] = row;
+  sparse_matrix->size[1] = col;
+  sparse_matrix->nnz = 0;
+  sparse_matrix->capacity = capacity;
+  sparse_matrix->offset = NULL;
+  sparse_matrix->row_index = NULL;
+  sparse_matrix->col_index = NULL;
+  if (format == CSR) {
+    sparse_matrix->offset = matrix_calloc(row + 1, sizeof(size_t));
+  } else if (format == CSC) {
+    sparse_matrix->offset = matrix_calloc(col + 1, sizeof(size_t));
+  }
+  if (format != CSC) {
+    sparse_matrix->col_index = matrix_malloc(capacity * sizeof(size_t));
+  }
+  if (format != CSR) {
+    sparse_matrix->row_index = matrix_malloc(capacity * sizeof(size_t));
+  }
+  sparse_matrix->data = matrix_malloc(capacity * sizeof(complex float));
+  return sparse_matrix;
+}
+
+/**
+ * @brief expand a sparse matrix to the COO format
+ *
+ * @param[in] sparse_matrix the sparse matrix to expand
+ * @return the sparse matrix in COO format
+ */
+static SparseMatrixT *expand_sparse_matrix(const SparseMatrixT *sparse_matrix) {
+  SparseMatrixT *coo = alloc_sparse_matrix(COO, sparse_matrix->size[0],
+                                           sparse_matrix->size[1],
+                                           sparse_matrix->nnz);
+  coo->nnz = sparse_matrix->nnz;
+  for (size_t k = 0; k < sparse_matrix->nnz; ++k) {
+    coo->data[k] = sparse_matrix->data[k];
+  }
+  if (sparse_matrix->format == COO) {
+    for (size_t k = 0; k < sparse_matrix->nnz; ++k) {
+      coo->row_index[k] = sparse_matrix->row_index[k];
+      coo->col_index[k] = sparse_matrix->col_index[k];
+    }
+    return coo;
+  }
+  // the compressed index is repeated over its range of values
+  bool is_csr = sparse_matrix->format == CSR;
+  size_t *major = is_csr ? coo->row_index : coo->col_index;
+  size_t *minor = is_csr ? coo->col_index : coo->row_index;
+  const size_t *stored = is_csr ? sparse_matrix->col_index
+                                : sparse_matrix->row_index;
+  size_t major_size = sparse_matrix->size[is_csr ? 0 : 1];
+  for (size_t i = 0; i < major_size; ++i) {
+    for (size_t k = sparse_matrix->offset[i]; k < sparse_matrix->offset[i + 1];
+         ++k) {
+      major[k] = i;
+      minor[k] = stored[k];
+    }
+  }
+  return coo;
+}
+
+/**
+ * @brief stable bucket sort of values by a key, it gives the offsets of the
+ *        buckets like a compressed format
+ *
+ * @param[in] key_size the number of buckets
+ * @param[in] nnz the number of values
+ * @param[in] key the bucket of every value
+ * @param[in] other the other index of every value
+ * @param[in] data the values
+ * @param[out] offset the \p key_size + 1 offsets of the buckets
+ * @param[out] sorted_key \p key in sorted order, ignored if NULL
+ * @param[out] sorted_other \p other in sorted order
+ * @param[out] sorted_data \p data in sorted order
+ */
+static void bucket_sort(size_t key_size, size_t nnz, const size_t *key,
+                        const size_t *other, const complex float *data,
+                        size_t *offset, size_t *sorted_key,
+                        size_t *sorted_other, complex float *sorted_data) {
+  for (size_t i = 0; i <= key_size; ++i) {
+    offset[i] = 0;
+  }
+  for (size_t k = 0; k < nnz; ++k) {
+    offset[key[k] + 1]++;
+  }
+  for (size_t i = 0; i < key_size; ++i) {
+    offset[i + 1] += offset[i];
+  }
+  size_t *next = matrix_malloc(key_size * sizeof(size_t));
+  for (size_t i = 0; i < key_size; ++i) {
+    next[i] = offset[i];
+  }
+  for (size_t k = 0; k < nnz; ++k) {
+    size_t position = next[key[k]]++;
+    if (sorted_key != NULL) {
+      sorted_key[position] = key[k];
+    }
+    sorted_other[position] = other[k];
+    sorted_data[position] = data[k];
+  }
+  matrix_free(next);
+}
+
+/**
+ * @brief compress a sparse matrix in COO format, the minor indexes are
+ *        sorted by a first pass over them, and duplicates are summed
+ *
+ * @param[in] coo the sparse matrix in COO format
+ * @param[in] format CSR or CSC
+ * @return the compressed sparse matrix
+ */
+static SparseMatrixT *compress_sparse_matrix(const SparseMatrixT *coo,
+                                             SparseFormat format) {
+  bool is_csr = format == CSR;
+  size_t major_size = coo->size[is_csr ? 0 : 1];
+  size_t minor_size = coo->size[is_csr ? 1 : 0];
+  const size_t *major = is_csr ? coo->row_index : coo->col_index;
+  const size_t *minor = is_csr ? coo->col_index : coo->row_index;
+  size_t nnz = coo->nnz;
+  SparseMatrixT *compressed =
+      alloc_sparse_matrix(format, coo->size[0], coo->size[1], nnz);
+  size_t *compressed_minor =
+      is_csr ? compressed->col_index : compressed->row_index;
+  // first by the minor index, then stably by the major index, so the
+  // minor indexes of a bucket come out in order
+  size_t *minor_offset = matrix_malloc((minor_size + 1) * sizeof(size_t));
+  size_t *by_minor = matrix_malloc(MAX(nnz, 1) * 2 * sizeof(size_t));
+  complex float *by_minor_data =
+      matrix_malloc(MAX(nnz, 1) * sizeof(complex float));
+  bucket_sort(minor_size, nnz, minor, major, coo->data, minor_offset,
+              by_minor, by_minor + nnz, by_minor_data);
+  bucket_sort(major_size, nnz, by_minor + nnz, by_minor, by_minor_data,
+              compressed->offset, NULL, compressed_minor, compressed->data);
+  matrix_free(by_minor_data);
+  matrix_free(by_minor);
+  matrix_free(minor_offset);
+  // sum up the duplicates of every bucket
+  size_t count = 0;
+  for (size_t i = 0; i < major_size; ++i) {
+    size_t begin = compressed->offset[i];
+    size_t end = compressed->offset[i + 1];
+    compressed->offset[i] = count;
+    for (size_t k = begin; k < end; ++k) {
+      if (count > compressed->offset[i] &&
+          compressed_minor[count - 1] == compressed_minor[k]) {
+        compressed->data[count - 1] += compressed->data[k];
+        continue;
+      }
+      compressed_minor[count] = compressed_minor[k];
+      compressed->data[count] = compressed->data[k];
+      count++;
+    }
+  }
+  compressed->offset[major_size] = count;
+  compressed->nnz = count;
+  return compressed;
+}
+
+/**
+ * @brief multiplication of a COO sparse matrix and a dense block
+ *        C = alpha op(A) B + beta C, every value is scattered directly
+ *
+ * @param[in] op the operation applied to the sparse matrix
+ * @param[in] coo the sparse matrix in COO format
+ * @param[in] k the column size of \p b and \p c
+ * @param[in] alpha the scalar of the product
+ * @param[in] b the dense block
+ * @param[in] ldb the leading dimension of \p b
+ * @param[in] beta the scalar of \p c , \p c is not read if it is zero
+ * @param[in,out] c the result block
+ * @param[in] ldc the leading dimension of \p c
+ */
+static void coo_mul(MatrixOperation op, const SparseMatrixT *coo, size_t k,
+                    complex float alpha, const complex float *b, size_t ldb,
+                    complex float beta, complex float *c, size_t ldc) {
+  size_t c_row = coo->size[op == NO_TRANSPOSE ? 0 : 1];
+  for (size_t i = 0; i < c_row; ++i) {
+    for (size_t j = 0; j < k; ++j) {
+      c[i * ldc + j] = beta == 0.0f ? 0.0f : beta * c[i * ldc + j];
+    }
+  }
+  for (size_t p = 0; p < coo->nnz; ++p) {
+    complex float value = op == CONJUGATE_TRANSPOSE ? conjf(coo->data[p])
+                                                    : coo->data[p];
+    size_t row = coo->row_index[p];
+    size_t col = coo->col_index[p];
+    size_t from = op == NO_TRANSPOSE ? col : row;
+    size_t to = op == NO_TRANSPOSE ? row : col;
+    for (size_t j = 0; j < k; ++j) {
+      c[to * ldc + j] += alpha * value * b[from * ldb + j];
+    }
+  }
+}
+
+/**
+ * @brief multiplication of a sparse matrix and a dense block in any format
+ *        C = alpha op(A) B + beta C
+ *
+ * @param[in] op the operation applied to the sparse matrix
+ * @param[in] sparse_matrix the sparse matrix
+ * @param[in] k the column size of \p b and \p c
+ * @param[in] alpha the scalar of the product
+ * @param[in] b the dense block
+ * @param[in] ldb the leading dimension of \p b
+ * @param[in] beta the scalar of \p c , \p c is not read if it is zero
+ * @param[in,out] c the result block
+ * @param[in] ldc the leading dimension of \p c
+ */
+static void sparse_mul(MatrixOperation op, const SparseMatrixT *sparse_matrix,
+                       size_t k, complex float alpha, const complex float *b,
+                       size_t ldb, complex float beta, complex float *c,
+                       size_t ldc) {
+  size_t row = sparse_matrix->size[0];
+  size_t col = sparse_matrix->size[1];
+  if (sparse_matrix->format == COO) {
+    coo_mul(op, sparse_matrix, k, alpha, b, ldb, beta, c, ldc);
+    return;
+  }
+  if (sparse_matrix->format == CSR) {
+    if (k == 1 && ldb == 1 && ldc == 1) {
+      kernel_csrmv(op, row, col, sparse_matrix->offset,
+                   sparse_matrix->col_index, sparse_matrix->data, alpha, b,
+                   beta, c);
+    } else {
+      kernel_csrmm(op, row, col, k, sparse_matrix->offset,
+                   sparse_matrix->col_index, sparse_matrix->data, alpha, b,
+                   ldb, beta, c, ldc);
+    }
+    return;
+  }
+  // CSC of A is CSR of A^T, and conj(A) B = conj(A^T^T conj(B))
+  size_t c_row = op == NO_TRANSPOSE ? row : col;
+  size_t b_row = op == NO_TRANSPOSE ? col : row;
+  bool conjugate = op == CONJUGATE_TRANSPOSE;
+  MatrixOperation csr_op = op == NO_TRANSPOSE ? TRANSPOSE : NO_TRANSPOSE;
+  const complex float *operand = b;
+  complex float *conjugated = NULL;
+  if (conjugate) {
+    conjugated = matrix_malloc(b_row * k * sizeof(complex float));
+    for (size_t i = 0; i < b_row; ++i) {
+      for (size_t j = 0; j < k; ++j) {
+        conjugated[i * k + j] = conjf(b[i * ldb + j]);
+      }
+    }
+    for (size_t i = 0; i < c_row; ++i) {
+      for (size_t j = 0; j < k; ++j) {
+        c[i * ldc + j] = conjf(c[i * ldc + j]);
+      }
+    }
+    operand = conjugated;
+    ldb = k;
+    alpha = conjf(alpha);
+    beta = conjf(beta);
+  }
+  kernel_csrmm(csr_op, col, row, k, sparse_matrix->offset,
+               sparse_matrix->row_index, sparse_matrix->data, alpha, operand,
+               ldb, beta, c, ldc);
+  if (conjugate) {
+    for (size_t i = 0; i < c_row; ++i) {
+      for (size_t j = 0; j < k; ++j) {
+        c[i * ldc + j] = conjf(c[i * ldc + j]);
+      }
+    }
+    matrix_free(conjugated);
+  }
+}
+
+/**
+ * @brief the product of an operator backed by a sparse matrix
+ *
+ * @param[in] x the vector to apply on
+ * @param[out] y the result
+ * @param[in] context the sparse matrix
+ */
+static void apply_sparse_matrix(const complex float *x, complex float *y,
+                                void *context) {
+  sparse_mul(NO_TRANSPOSE, context, 1, new_complex(1.0f, 0.0f), x, 1,
+             new_complex(0.0f, 0.0f), y, 1);
+}
+
+// functions: init
+
+SparseMatrixT *new_sparse_matrix(size_t row, size_t col, size_t capacity) {
+  PROFILE_FUNCTION();
+  // return: empty sparse matrix
+  return alloc_sparse_matrix(COO, row, col, capacity);
+}
+
+SparseMatrixT *new_sparse_matrix_from_matrix(const MatrixT *matrix,
+                                             SparseFormat format) {
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (matrix == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  size_t matrix_row = matrix->size[0];
+  size_t matrix_col = matrix->size[1];
+  size_t nnz = 0;
+  for (size_t i = 0; i < matrix_row * matrix_col; ++i) {
+    nnz += matrix->data[i] != 0.0f;
+  }
+  // the nonzeros are met row by row, which is already sorted
+  SparseMatrixT *coo = alloc_sparse_matrix(COO, matrix_row, matrix_col, nnz);
+  for (size_t i = 0; i < matrix_row; ++i) {
+    for (size_t j = 0; j < matrix_col; ++j) {
+      complex float value = matrix->data[i * matrix_col + j];
+      if (value != 0.0f) {
+        coo->row_index[coo->nnz] = i;
+        coo->col_index[coo->nnz] = j;
+        coo->data[coo->nnz++] = value;
+      }
+    }
+  }
+  if (format == COO) {
+    return coo;
+  }
+  SparseMatrixT *sparse_matrix = compress_sparse_matrix(coo, format);
+  drop_sparse_matrix(coo);
+  return sparse_matrix;
+}
+
+MatrixT *new_matrix_from_sparse_matrix(const SparseMatrixT *sparse_matrix) {
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (sparse_matrix == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  // boundary test: size
+  if (sparse_matrix->size[0] > UINT8_MAX ||
+      sparse_matrix->size[1] > UINT8_MAX) {
+    log_error("panic: sparse matrix size (%zu, %zu) is too large for matrix",
+              sparse_matrix->size[0], sparse_matrix->size[1]);
+    exit(EXIT_FAILURE);
+  }
+  MatrixT *matrix = new_matrix(sparse_matrix->size[0], sparse_matrix->size[1]);
+  SparseMatrixT *coo = expand_sparse_matrix(sparse_matrix);
+  for (size_t k = 0; k < coo->nnz; ++k) {
+    matrix->data[coo->row_index[k] * matrix->size[1] + coo->col_index[k]] +=
+        coo->data[k];
+  }
+  drop_sparse_matrix(coo);
+  return matrix;
+}
+
+SparseMatrixT **new_sparse_matrix_from_file(const char *file_path,
+                                            size_t *matrix_number) {
+  PROFILE_FUNCTION();
+  // test: open file
+  FILE *file_handle = fopen(file_path, "r");
+  if (file_handle == NULL) {
+    log_error("panic: failed to open file (%.64s)", file_path);
+    exit(EXIT_FAILURE);
+  }
+  // test: get file infomation
+  struct stat file_stat;
+  if (stat(file_path, &file_stat) == -1) {
+    log_error("panic: failed to get file stat (%.64s)", file_path);
+    exit(EXIT_FAILURE);
+  }
+  // init: capacity of matrices
+  size_t matrices_capacity = 16;
+  size_t matrix_cnt = 0;
+  size_t matrix_size[2] = {0, 0};
+  size_t matrix_nnz = 0;
+  bool is_read_matrix = false;
+  SparseMatrixT **matrices =
+      matrix_calloc(matrices_capacity, sizeof(SparseMatrixT *));
+  // init: read buffer
+  char *read_buffer = matrix_malloc(file_stat.st_size + 1);
+  // start to read file
+  while (fscanf(file_handle, "%[^\n] ", read_buffer) != EOF) {
+    // boundary test: matrices capacity
+    if (matrix_cnt + 2 > matrices_capacity) {
+      matrices_capacity *= 2;
+      matrices =
+          matrix_realloc(matrices, matrices_capacity * sizeof(SparseMatrixT *));
+    }
+    if (strcmp("[sparse]", read_buffer) == 0) {
+      is_read_matrix = true;
+    } else if (strncmp("size =", read_buffer, strlen("size =")) == 0 &&
+               is_read_matrix) {
+      sscanf(read_buffer, "size = %zu %zu", &matrix_size[0], &matrix_size[1]);
+    } else if (strncmp("nnz =", read_buffer, strlen("nnz =")) == 0 &&
+               is_read_matrix) {
+      sscanf(read_buffer, "nnz = %zu", &matrix_nnz);
+    } else if (strncmp("data =", read_buffer, strlen("data =")) == 0 &&
+               is_read_matrix) {
+      // read triplets of row, column and value
+      SparseMatrixT *coo =
+          new_sparse_matrix(matrix_size[0], matrix_size[1], matrix_nnz);
+      char *value_buffer = strtok(read_buffer + strlen("data ="), " ");
+      while (value_buffer != NULL && coo->nnz < matrix_nnz) {
+        size_t row = 0;
+        size_t col = 0;
+        float real = 0.0f;
+        float imag = 0.0f;
+        sscanf(value_buffer, "%zu", &row);
+        value_buffer = strtok(NULL, " ");
+        if (value_buffer == NULL) {
+          break;
+        }
+        sscanf(value_buffer, "%zu", &col);
+        value_buffer = strtok(NULL, " ");
+        if (value_buffer == NULL) {
+          break;
+        }
+        sscanf(value_buffer, "%f%f", &real, &imag);
+        add_sparse_matrix_val(coo, row, col, new_complex(real, imag));
+        value_buffer = strtok(NULL, " ");
+      }
+      matrices[matrix_cnt++] = compress_sparse_matrix(coo, CSR);
+      drop_sparse_matrix(coo);
+      is_read_matrix = false;
+    } else {
+      log_error("panic: parser error (%.64s)", read_buffer);
+      exit(EXIT_FAILURE);
+    }
+  }
+  // free read buffer
+  matrix_free(read_buffer);
+  // close file
+  fclose(file_handle);
+  // return: matrices
+  *matrix_number = matrix_cnt;
+  return matrices;
+}
+
+void save_sparse_matrix_to_file(const char *file_path,
+                                SparseMatrixT **matrices,
+                                size_t matrix_number) {
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (matrices == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  // test: open file
+  FILE *file_handle = fopen(file_path, "w");
+  if (file_handle == NULL) {
+    log_error("panic: failed to open file (%.64s)", file_path);
+    exit(EXIT_FAILURE);
+  }
+  for (size_t i = 0; i < matrix_number; ++i) {
+    SparseMatrixT *coo = expand_sparse_matrix(matrices[i]);
+    fputs("[sparse]\n", file_handle);
+    fprintf(file_handle, "size = %zu %zu\n", coo->size[0], coo->size[1]);
+    fprintf(file_handle, "nnz = %zu\n", coo->nnz);
+    // indexes are saved from 1 like the other accessors
+    fprintf(file_handle, "data =");
+    for (size_t k = 0; k < coo->nnz; ++k) {
+      fprintf(file_handle, " %zu %zu %f%+f", coo->row_index[k] + 1,
+              coo->col_index[k] + 1, crealf(coo->data[k]),
+              cimagf(coo->data[k]));
+    }
+    fputc('\n', file_handle);
+    drop_sparse_matrix(coo);
+  }
+  // close file
+  fclose(file_handle);
+}
+
+SparseMatrixT *convert_sparse_matrix(const SparseMatrixT *sparse_matrix,
+                                     SparseFormat format) {
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (sparse_matrix == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  SparseMatrixT *coo = expand_sparse_matrix(sparse_matrix);
+  if (format == COO) {
+    return coo;
+  }
+  SparseMatrixT *converted = compress_sparse_matrix(coo, format);
+  drop_sparse_matrix(coo);
+  return converted;
+}
+
+SparseMatrixT *copy_sparse_matrix(const SparseMatrixT *sparse_matrix) {
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (sparse_matrix == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  SparseMatrixT *copied_matrix = alloc_sparse_matrix(
+      sparse_matrix->format, sparse_matrix->size[0], sparse_matrix->size[1],
+      sparse_matrix->nnz);
+  copied_matrix->nnz = sparse_matrix->nnz;
+  if (sparse_matrix->offset != NULL) {
+    size_t major_size = sparse_matrix->size[sparse_matrix->format == CSR ? 0
+                                                                         : 1];
+    memcpy(copied_matrix->offset, sparse_matrix->offset,
+           (major_size + 1) * sizeof(size_t));
+  }
+  if (sparse_matrix->row_index != NULL) {
+    memcpy(copied_matrix->row_index, sparse_matrix->row_index,
+           sparse_matrix->nnz * sizeof(size_t));
+  }
+  if (sparse_matrix->col_index != NULL) {
+    memcpy(copied_matrix->col_index, sparse_matrix->col_index,
+           sparse_matrix->nnz * sizeof(size_t));
+  }
+  memcpy(copied_matrix->data, sparse_matrix->data,
+         sparse_matrix->nnz * sizeof(complex float));
+  return copied_matrix;
+}
+
+void drop_sparse_matrix(SparseMatrixT *sparse_matrix) {
+  PROFILE_FUNCTION();
+  // if matrix is null, it's fine
+  if (sparse_matrix == NULL) {
+    return;
+  }
+  matrix_free(sparse_matrix->offset);
+  matrix_free(sparse_matrix->row_index);
+  matrix_free(sparse_matrix->col_index);
+  matrix_free(sparse_matrix->data);
+  matrix_free(sparse_matrix);
+}
+
+void drop_sparse_matrices(SparseMatrixT **matrices, size_t matrices_number) {
+  PROFILE_FUNCTION();
+  for (size_t i = 0; i < matrices_number; ++i) {
+    drop_sparse_matrix(matrices[i]);
+  }
+  matrix_free(matrices);
+}
+
+// functions: manipulate
+
+void add_sparse_matrix_val(SparseMatrixT *sparse_matrix, size_t row,
+                           size_t col, complex float value) {
+  // boundary test: null pointer
+  if (sparse_matrix == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  // boundary test: format
+  if (sparse_matrix->format != COO) {
+    log_error("panic: only sparse matrix in COO format can be assembled");
+    exit(EXIT_FAILURE);
+  }
+  // boundary test: position
+  if (row == 0 || col == 0 || row > sparse_matrix->size[0] ||
+      col > sparse_matrix->size[1]) {
+    log_error("panic: %s out of boundary (%zu, %zu)", __func__, row, col);
+    exit(EXIT_FAILURE);
+  }
+  // grow the arrays by doubling
+  if (sparse_matrix->nnz == sparse_matrix->capacity) {
+    sparse_matrix->capacity *= 2;
+    sparse_matrix->row_index = matrix_realloc(
+        sparse_matrix->row_index, sparse_matrix->capacity * sizeof(size_t));
+    sparse_matrix->col_index = matrix_realloc(
+        sparse_matrix->col_index, sparse_matrix->capacity * sizeof(size_t));
+    sparse_matrix->data = matrix_realloc(
+        sparse_matrix->data, sparse_matrix->capacity * sizeof(complex float));
+  }
+  sparse_matrix->row_index[sparse_matrix->nnz] = row - 1;
+  sparse_matrix->col_index[sparse_matrix->nnz] = col - 1;
+  sparse_matrix->data[sparse_matrix->nnz++] = value;
+}
+
+void mul_sparse_matrix_vector(MatrixOperation operation,
+                              const SparseMatrixT *sparse_matrix,
+                              complex float alpha, const complex float *vector,
+                              complex float beta, complex float *result) {
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (sparse_matrix == NULL || vector == NULL || result == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  sparse_mul(operation, sparse_matrix, 1, alpha, vector, 1, beta, result, 1);
+}
+
+MatrixT *mul_sparse_matrix(MatrixOperation operation,
+                           const SparseMatrixT *sparse_matrix,
+                           const MatrixT *matrix) {
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (sparse_matrix == NULL || matrix == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  size_t op_row = sparse_matrix->size[operation == NO_TRANSPOSE ? 0 : 1];
+  size_t op_col = sparse_matrix->size[operation == NO_TRANSPOSE ? 1 : 0];
+  // boundary test: compitable size
+  if (op_col != matrix->size[0] || op_row > UINT8_MAX) {
+    log_error("panic: sparse matrix size (%zu, %zu) is not compatible with "
+              "matrix size (%u, %u)",
+              sparse_matrix->size[0], sparse_matrix->size[1], matrix->size[0],
+              matrix->size[1]);
+    exit(EXIT_FAILURE);
+  }
+  MatrixT *product = new_matrix(op_row, matrix->size[1]);
+  sparse_mul(operation, sparse_matrix, matrix->size[1],
+             new_complex(1.0f, 0.0f), matrix->data, matrix->size[1],
+             new_complex(0.0f, 0.0f), product->data, product->size[1]);
+  return product;
+}
+
+MatrixOperatorT
+new_sparse_matrix_operator(const SparseMatrixT *sparse_matrix) {
+  // boundary test: null pointer
+  if (sparse_matrix == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  // boundary tes: square matrix
+  if (sparse_matrix->size[0] != sparse_matrix->size[1]) {
+    log_error("panic: matrix must be squared at %s with size (%zu, %zu)",
+              __func__, sparse_matrix->size[0], sparse_matrix->size[1]);
+    exit(EXIT_FAILURE);
+  }
+  MatrixOperatorT sparse_operator = {
+      .size = sparse_matrix->size[0],
+      .apply = apply_sparse_matrix,
+      .context = (void *)sparse_matrix,
+  };
+  return sparse_operator;
+}
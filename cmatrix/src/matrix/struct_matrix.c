@@ -0,0 +1,588 @@
+/**
+ * @file matrix/struct_matrix.c
+ * @brief structured matrices of matrix library
+ */
+
+// include
+
+#include "alloc_matrix.h"
+#include "kernel_matrix.h"
+#include "matrix/matrix.h"
+#include "matrix/matrix_ext.h"
+#include "matrix/matrix_struct.h"
+#include "matrix/utils.h"
+#include "profile_matrix.h"
+#include <complex.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// functions: helpers
+
+/**
+ * @brief allocate a structured matrix filled with zero
+ *
+ * @param[in] structure the structure of matrix
+ * @param[in] row the row size of matrix
+ * @param[in] col the column size of matrix
+ * @param[in] triangle the stored triangle of TRIANGULAR and HERMITIAN
+ * @param[in] lower the lower bandwidth of BANDED
+ * @param[in] upper the upper bandwidth of BANDED
+ * @return the structured matrix
+ */
+static StructuredMatrixT *
+alloc_structured_matrix(MatrixStructure structure, uint8_t row, uint8_t col,
+                        MatrixTriangle triangle, uint8_t lower,
+                        uint8_t upper) {
+  // boundary test: size
+  if (row == 0 || col == 0) {
+    log_error("panic: matrix size (%u, %u) is illegal", row, col);
+    exit(EXIT_FAILURE);
+  }
+  // boundary tes: square matrix
+  if ((structure == TRIANGULAR || structure == HERMITIAN) && row != col) {
+    log_error("panic: matrix must be squared with size (%u, %u)", row, col);
+    exit(EXIT_FAILURE);
+  }
+  size_t length = 0;
+  if (structure == DIAGONAL) {
+    length = MIN(row, col);
+  } else if (structure == BANDED) {
+    length = (size_t)row * (lower + upper + 1);
+  } else {
+    length = (size_t)row * (row + 1) / 2;
+  }
+  StructuredMatrixT *structured_matrix =
+      matrix_malloc(sizeof(StructuredMatrixT));
+  structured_matrix->structure = structure;
+  structured_matrix->size[0] = row;
+  structured_matrix->size[1] = col;
+  structured_matrix->triangle = triangle;
+  structured_matrix->band[0] = structure == BANDED ? lower : 0;
+  structured_matrix->band[1] = structure == BANDED ? upper : 0;
+  structured_matrix->data = matrix_calloc(length, sizeof(complex float));
+  return structured_matrix;
+}
+
+/**
+ * @brief get the stored segment of a row
+ *
+ * @param[in] structured_matrix the structured matrix
+ * @param[in] row the row index (from 0)
+ * @param[out] begin the first column of the segment
+ * @param[out] length the length of the segment
+ * @return the first stored value of the segment
+ */
+static complex float *get_stored_row(const StructuredMatrixT *structured_matrix,
+                                     size_t row, size_t *begin,
+                                     size_t *length) {
+  size_t n = structured_matrix->size[1];
+  complex float *data = structured_matrix->data;
+  switch (structured_matrix->structure) {
+  case DIAGONAL:
+    *begin = row;
+    *length = row < MIN(structured_matrix->size[0], n) ? 1 : 0;
+    return data + row;
+  case BANDED: {
+    size_t lower = structured_matrix->band[0];
+    size_t upper = structured_matrix->band[1];
+    size_t end = MIN(n, row + upper + 1);
+    *begin = row > lower ? row - lower : 0;
+    *length = end > *begin ? end - *begin : 0;
+    return data + row * (lower + upper + 1) + *begin + lower - row;
+  }
+  default:
+    // row i of the upper triangle starts after i rows of n, n - 1, ...
+    if (structured_matrix->triangle == UPPER) {
+      *begin = row;
+      *length = n - row;
+      return data + row * (2 * n - row + 1) / 2;
+    }
+    *begin = 0;
+    *length = row + 1;
+    return data + row * (row + 1) / 2;
+  }
+}
+
+/**
+ * @brief get a value of a structured matrix
+ *
+ * @param[in] structured_matrix the structured matrix
+ * @param[in] row the row index (from 0)
+ * @param[in] col the column index (from 0)
+ * @return the value
+ */
+static complex float get_value(const StructuredMatrixT *structured_matrix,
+                               size_t row, size_t col) {
+  size_t begin;
+  size_t length;
+  const complex float *segment =
+      get_stored_row(structured_matrix, row, &begin, &length);
+  if (col >= begin && col < begin + length) {
+    return segment[col - begin];
+  }
+  // the other triangle of a Hermitian matrix
+  if (structured_matrix->structure == HERMITIAN) {
+    segment = get_stored_row(structured_matrix, col, &begin, &length);
+    return conjf(segment[row - begin]);
+  }
+  return new_complex(0.0f, 0.0f);
+}
+
+/**
+ * @brief construct a structured matrix from the values of a matrix
+ *
+ * @param[in] matrix the matrix to use
+ * @param[in] structure the structure of matrix
+ * @param[in] triangle the stored triangle of TRIANGULAR and HERMITIAN
+ * @param[in] lower the lower bandwidth of BANDED
+ * @param[in] upper the upper bandwidth of BANDED
+ * @return the structured matrix
+ */
+static StructuredMatrixT *pack_matrix(const MatrixT *matrix,
+                                      MatrixStructure structure,
+                                      MatrixTriangle triangle, uint8_t lower,
+                                      uint8_t upper) {
+  // boundary test: null pointer
+  if (matrix == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  StructuredMatrixT *structured_matrix = alloc_structured_matrix(
+      structure, matrix->size[0], matrix->size[1], triangle, lower, upper);
+  for (size_t i = 0; i < matrix->size[0]; ++i) {
+    size_t begin;
+    size_t length;
+    complex float *segment =
+        get_stored_row(structured_matrix, i, &begin, &length);
+    for (size_t j = 0; j < length; ++j) {
+      segment[j] = matrix->data[i * matrix->size[1] + begin + j];
+    }
+  }
+  return structured_matrix;
+}
+
+/**
+ * @brief check a square structured system and copy its right hand sides
+ *
+ * @param[in] structured_matrix the structured matrix S
+ * @param[in] rhs the right hand sides B
+ * @return the copy of \p rhs
+ */
+static MatrixT *check_system(const StructuredMatrixT *structured_matrix,
+                             const MatrixT *rhs) {
+  // boundary test: null pointer
+  if (structured_matrix == NULL || rhs == NULL) {
+    log_error("panic: null pointer error at %s",
+              "solve_structured_matrix");
+    exit(EXIT_FAILURE);
+  }
+  // boundary tes: square matrix
+  if (structured_matrix->size[0] != structured_matrix->size[1]) {
+    log_error("panic: matrix must be squared with size (%u, %u)",
+              structured_matrix->size[0], structured_matrix->size[1]);
+    exit(EXIT_FAILURE);
+  }
+  // boundary test: compitable size
+  if (structured_matrix->size[0] != rhs->size[0]) {
+    log_error(
+        "panic: matrix size (%u, %u) is not compatible with rhs size (%u, %u)",
+        structured_matrix->size[0], structured_matrix->size[1], rhs->size[0],
+        rhs->size[1]);
+    exit(EXIT_FAILURE);
+  }
+  return copy_matrix(rhs);
+}
+
+/**
+ * @brief panic on a singular structured system
+ */
+static void panic_singular(void) {
+  log_error("panic: the structured matrix isn't inversable");
+  exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief solve a triangular system in place by substitution on the packed
+ *        rows, rows of X are updated by whole rows of the right hand sides
+ *
+ * @param[in] structured_matrix the triangular matrix
+ * @param[in,out] solution the right hand sides, overwritten by X
+ */
+static void solve_triangular(const StructuredMatrixT *structured_matrix,
+                             MatrixT *solution) {
+  size_t n = structured_matrix->size[0];
+  size_t r = solution->size[1];
+  bool upper = structured_matrix->triangle == UPPER;
+  for (size_t step = 0; step < n; ++step) {
+    size_t i = upper ? n - 1 - step : step;
+    size_t begin;
+    size_t length;
+    const complex float *segment =
+        get_stored_row(structured_matrix, i, &begin, &length);
+    complex float *x_row = solution->data + i * r;
+    // X(i, :) -= A(i, j) X(j, :) over the solved rows j
+    for (size_t j = begin; j < begin + length; ++j) {
+      if (j != i) {
+        kernel_axpy(r, -segment[j - begin], solution->data + j * r, x_row);
+      }
+    }
+    complex float pivot = segment[i - begin];
+    if (pivot == 0.0f) {
+      panic_singular();
+    }
+    kernel_scal(r, 1.0f / pivot, x_row);
+  }
+}
+
+/**
+ * @brief solve a banded system in place by LU with partial pivoting, the
+ *        row swaps widen the upper band by the lower bandwidth
+ *
+ * @param[in] structured_matrix the banded matrix
+ * @param[in,out] solution the right hand sides, overwritten by X
+ */
+static void solve_banded(const StructuredMatrixT *structured_matrix,
+                         MatrixT *solution) {
+  size_t n = structured_matrix->size[0];
+  size_t r = solution->size[1];
+  size_t lower = structured_matrix->band[0];
+  size_t upper = structured_matrix->band[1] + lower;
+  size_t width = lower + upper + 1;
+  // work(i, j) is at i width + j - i + lower, as a band of (lower, upper)
+  complex float *work = matrix_calloc(n * width, sizeof(complex float));
+  for (size_t i = 0; i < n; ++i) {
+    size_t begin;
+    size_t length;
+    const complex float *segment =
+        get_stored_row(structured_matrix, i, &begin, &length);
+    for (size_t j = 0; j < length; ++j) {
+      work[i * width + begin + j + lower - i] = segment[j];
+    }
+  }
+  complex float *x = solution->data;
+  for (size_t k = 0; k < n; ++k) {
+    size_t last = MIN(n - 1, k + lower);
+    size_t end = MIN(n, k + upper + 1);
+    // pivot: the largest value of column k in the band
+    size_t p = k;
+    for (size_t i = k + 1; i <= last; ++i) {
+      if (cabsf(work[i * width + k + lower - i]) >
+          cabsf(work[p * width + k + lower - p])) {
+        p = i;
+      }
+    }
+    complex float *pivot_row = work + k * width + lower;
+    if (p != k) {
+      complex float *other = work + p * width + k + lower - p;
+      for (size_t j = 0; j < end - k; ++j) {
+        complex float temp = pivot_row[j];
+        pivot_row[j] = other[j];
+        other[j] = temp;
+      }
+      for (size_t j = 0; j < r; ++j) {
+        complex float temp = x[k * r + j];
+        x[k * r + j] = x[p * r + j];
+        x[p * r + j] = temp;
+      }
+    }
+    if (pivot_row[0] == 0.0f) {
+      matrix_free(work);
+      panic_singular();
+    }
+    // eliminate column k from the rows under it
+    for (size_t i = k + 1; i <= last; ++i) {
+      complex float *row = work + i * width + k + lower - i;
+      complex float factor = row[0] / pivot_row[0];
+      if (factor == 0.0f) {
+        continue;
+      }
+      kernel_axpy(end - k - 1, -factor, pivot_row + 1, row + 1);
+      row[0] = new_complex(0.0f, 0.0f);
+      kernel_axpy(r, -factor, x + k * r, x + i * r);
+    }
+  }
+  // back substitution with the upper band
+  for (size_t step = 0; step < n; ++step) {
+    size_t i = n - 1 - step;
+    const complex float *row = work + i * width + lower;
+    size_t end = MIN(n, i + upper + 1);
+    for (size_t j = i + 1; j < end; ++j) {
+      kernel_axpy(r, -row[j - i], x + j * r, x + i * r);
+    }
+    kernel_scal(r, 1.0f / row[0], x + i * r);
+  }
+  matrix_free(work);
+}
+
+/**
+ * @brief solve a Hermitian positive-definite system in place by Cholesky
+ *        factorization on packed lower rows
+ *
+ * @param[in] structured_matrix the Hermitian matrix
+ * @param[in,out] solution the right hand sides, overwritten by X
+ */
+static void solve_hermitian(const StructuredMatrixT *structured_matrix,
+                            MatrixT *solution) {
+  size_t n = structured_matrix->size[0];
+  size_t r = solution->size[1];
+  // L(i, :) starts at i (i + 1) / 2
+  complex float *factor =
+      matrix_malloc(n * (n + 1) / 2 * sizeof(complex float));
+  for (size_t i = 0; i < n; ++i) {
+    complex float *l_row = factor + i * (i + 1) / 2;
+    for (size_t j = 0; j <= i; ++j) {
+      // A(i, j) - sum(L(i, k) conj(L(j, k)))
+      const complex float *l_other = factor + j * (j + 1) / 2;
+      complex float value = get_value(structured_matrix, i, j) -
+                            kernel_dot(j, l_other, true, l_row);
+      if (j < i) {
+        l_row[j] = value / l_other[j];
+        continue;
+      }
+      if (crealf(value) <= 0.0f) {
+        matrix_free(factor);
+        log_error("panic: the matrix isn't positive definite, the leading "
+                  "minor of order %zu is not positive",
+                  i + 1);
+        exit(EXIT_FAILURE);
+      }
+      l_row[i] = new_complex(sqrtf(crealf(value)), 0.0f);
+    }
+  }
+  complex float *x = solution->data;
+  // L Y = B
+  for (size_t i = 0; i < n; ++i) {
+    const complex float *l_row = factor + i * (i + 1) / 2;
+    for (size_t k = 0; k < i; ++k) {
+      kernel_axpy(r, -l_row[k], x + k * r, x + i * r);
+    }
+    kernel_scal(r, 1.0f / l_row[i], x + i * r);
+  }
+  // L^H X = Y, L^H(i, k) = conj(L(k, i))
+  for (size_t step = 0; step < n; ++step) {
+    size_t i = n - 1 - step;
+    for (size_t k = i + 1; k < n; ++k) {
+      kernel_axpy(r, -conjf(factor[k * (k + 1) / 2 + i]), x + k * r,
+                  x + i * r);
+    }
+    kernel_scal(r, 1.0f / factor[i * (i + 1) / 2 + i], x + i * r);
+  }
+  matrix_free(factor);
+}
+
+// functions: init
+
+StructuredMatrixT *new_diagonal_identity_matrix(uint8_t row, uint8_t col) {
+  PROFILE_FUNCTION();
+  StructuredMatrixT *identity_matrix =
+      alloc_structured_matrix(DIAGONAL, row, col, UPPER, 0, 0);
+  for (size_t i = 0; i < MIN(row, col); ++i) {
+    identity_matrix->data[i] = new_complex(1.0f, 0.0f);
+  }
+  return identity_matrix;
+}
+
+StructuredMatrixT *new_diagonal_matrix_from_matrix(const MatrixT *matrix) {
+  PROFILE_FUNCTION();
+  return pack_matrix(matrix, DIAGONAL, UPPER, 0, 0);
+}
+
+StructuredMatrixT *new_triangular_matrix_from_matrix(const MatrixT *matrix,
+                                                     MatrixTriangle triangle) {
+  PROFILE_FUNCTION();
+  return pack_matrix(matrix, TRIANGULAR, triangle, 0, 0);
+}
+
+StructuredMatrixT *new_banded_matrix_from_matrix(const MatrixT *matrix,
+                                                 uint8_t lower,
+                                                 uint8_t upper) {
+  PROFILE_FUNCTION();
+  return pack_matrix(matrix, BANDED, UPPER, lower, upper);
+}
+
+StructuredMatrixT *new_hermitian_matrix_from_matrix(const MatrixT *matrix,
+                                                    MatrixTriangle triangle) {
+  PROFILE_FUNCTION();
+  StructuredMatrixT *hermitian_matrix =
+      pack_matrix(matrix, HERMITIAN, triangle, 0, 0);
+  // the diagonal of a Hermitian matrix is real
+  for (size_t i = 0; i < hermitian_matrix->size[0]; ++i) {
+    size_t begin;
+    size_t length;
+    complex float *segment =
+        get_stored_row(hermitian_matrix, i, &begin, &length);
+    segment[i - begin] = new_complex(crealf(segment[i - begin]), 0.0f);
+  }
+  return hermitian_matrix;
+}
+
+MatrixT *
+new_matrix_from_structured_matrix(const StructuredMatrixT *structured_matrix) {
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (structured_matrix == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  uint8_t matrix_row = structured_matrix->size[0];
+  uint8_t matrix_col = structured_matrix->size[1];
+  MatrixT *matrix = new_matrix(matrix_row, matrix_col);
+  for (size_t i = 0; i < matrix_row; ++i) {
+    for (size_t j = 0; j < matrix_col; ++j) {
+      matrix->data[i * matrix_col + j] = get_value(structured_matrix, i, j);
+    }
+  }
+  return matrix;
+}
+
+void drop_structured_matrix(StructuredMatrixT *structured_matrix) {
+  PROFILE_FUNCTION();
+  // if matrix is null, it's fine
+  if (structured_matrix == NULL) {
+    return;
+  }
+  matrix_free(structured_matrix->data);
+  matrix_free(structured_matrix);
+}
+
+// functions: attribute
+
+complex float
+get_structured_matrix_val(const StructuredMatrixT *structured_matrix,
+                          uint8_t row, uint8_t col) {
+  // boundary test: null pointer
+  if (structured_matrix == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  // boundary test: position
+  if (row == 0 || col == 0 || row > structured_matrix->size[0] ||
+      col > structured_matrix->size[1]) {
+    log_error("panic: %s out of boundary (%u, %u)", __func__, row, col);
+    exit(EXIT_FAILURE);
+  }
+  return get_value(structured_matrix, row - 1, col - 1);
+}
+
+// functions: manipulate
+
+StructuredMatrixT *add_structured_matrix(const StructuredMatrixT *lhs,
+                                         const StructuredMatrixT *rhs) {
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (lhs == NULL || rhs == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  // boundary test: compitable structure
+  if (lhs->structure != rhs->structure || lhs->size[0] != rhs->size[0] ||
+      lhs->size[1] != rhs->size[1] ||
+      (lhs->structure != BANDED && lhs->structure != DIAGONAL &&
+       lhs->triangle != rhs->triangle)) {
+    log_error("panic: structured matrices of size (%u, %u) and (%u, %u) are "
+              "not compatible",
+              lhs->size[0], lhs->size[1], rhs->size[0], rhs->size[1]);
+    exit(EXIT_FAILURE);
+  }
+  StructuredMatrixT *sum = alloc_structured_matrix(
+      lhs->structure, lhs->size[0], lhs->size[1], lhs->triangle,
+      MAX(lhs->band[0], rhs->band[0]), MAX(lhs->band[1], rhs->band[1]));
+  for (size_t i = 0; i < sum->size[0]; ++i) {
+    size_t begin;
+    size_t length;
+    complex float *segment = get_stored_row(sum, i, &begin, &length);
+    for (size_t j = 0; j < length; ++j) {
+      segment[j] =
+          get_value(lhs, i, begin + j) + get_value(rhs, i, begin + j);
+    }
+  }
+  return sum;
+}
+
+MatrixT *mul_structured_matrix(MatrixSide side,
+                               const StructuredMatrixT *structured_matrix,
+                               const MatrixT *matrix) {
+  PROFILE_FUNCTION();
+  // boundary test: null pointer
+  if (structured_matrix == NULL || matrix == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  size_t s_row = structured_matrix->size[0];
+  size_t s_col = structured_matrix->size[1];
+  size_t m_row = matrix->size[0];
+  size_t m_col = matrix->size[1];
+  // boundary test: compitable size
+  if ((side == LEFT && s_col != m_row) || (side == RIGHT && m_col != s_row)) {
+    log_error("panic: structured matrix size (%zu, %zu) is not compatible "
+              "with matrix size (%zu, %zu)",
+              s_row, s_col, m_row, m_col);
+    exit(EXIT_FAILURE);
+  }
+  bool hermitian = structured_matrix->structure == HERMITIAN;
+  MatrixT *product = side == LEFT ? new_matrix(s_row, m_col)
+                                  : new_matrix(m_row, s_col);
+  size_t p_col = product->size[1];
+  for (size_t i = 0; i < s_row; ++i) {
+    size_t begin;
+    size_t length;
+    const complex float *segment =
+        get_stored_row(structured_matrix, i, &begin, &length);
+    if (side == LEFT) {
+      // P(i, :) += S(i, j) M(j, :), and P(j, :) += conj(S(i, j)) M(i, :)
+      // for the mirrored triangle
+      for (size_t j = begin; j < begin + length; ++j) {
+        kernel_axpy(m_col, segment[j - begin], matrix->data + j * m_col,
+                    product->data + i * p_col);
+        if (hermitian && j != i) {
+          kernel_axpy(m_col, conjf(segment[j - begin]),
+                      matrix->data + i * m_col, product->data + j * p_col);
+        }
+      }
+      continue;
+    }
+    // P(t, :) += M(t, i) S(i, :), and P(t, i) += M(t, j) conj(S(i, j)) for
+    // the mirrored triangle
+    size_t mirror_begin = structured_matrix->triangle == UPPER ? 1 : 0;
+    for (size_t t = 0; t < m_row; ++t) {
+      const complex float *m_row_data = matrix->data + t * m_col;
+      complex float *p_row_data = product->data + t * p_col;
+      kernel_axpy(length, m_row_data[i], segment, p_row_data + begin);
+      if (hermitian && length > 1) {
+        p_row_data[i] += kernel_dot(length - 1, segment + mirror_begin, true,
+                                    m_row_data + begin + mirror_begin);
+      }
+    }
+  }
+  return product;
+}
+
+MatrixT *solve_structured_matrix(const StructuredMatrixT *structured_matrix,
+                                 const MatrixT *rhs) {
+  PROFILE_FUNCTION();
+  MatrixT *solution = check_system(structured_matrix, rhs);
+  switch (structured_matrix->structure) {
+  case DIAGONAL:
+    for (size_t i = 0; i < solution->size[0]; ++i) {
+      if (structured_matrix->data[i] == 0.0f) {
+        panic_singular();
+      }
+      kernel_scal(solution->size[1], 1.0f / structured_matrix->data[i],
+                  solution->data + i * solution->size[1]);
+    }
+    break;
+  case TRIANGULAR:
+    solve_triangular(structured_matrix, solution);
+    break;
+  case BANDED:
+    solve_banded(structured_matrix, solution);
+    break;
+  case HERMITIAN:
+    solve_hermitian(structured_matrix, solution);
+    break;
+  }
+  return solution;
+}
@@ -0,0 +1,315 @@
+/**
+ * @file matrix/tune_matrix.c
+ * @brief tuning of matrix library
+ */
+
+// include
+
+#include "matrix/matrix_tune.h"
+#include "matrix/utils.h"
+#include <ctype.h>
+#include <float.h>
+#include <math.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// constants
+
+/**
+ * \def TUNE_ENVIRONMENT
+ *
+ * the environment variable which names the config file loaded at startup
+ */
+#define TUNE_ENVIRONMENT "CMATRIX_TUNE"
+
+/**
+ * \def TUNE_MAX_LINE
+ *
+ * the maximum length of a line of the config file
+ */
+#define TUNE_MAX_LINE 256
+
+// types
+
+/**
+ * @brief the loading state of the config file named by the environment
+ */
+typedef enum TuneState {
+  TUNE_UNLOADED = 0, ///< the environment is not read yet
+  TUNE_LOADING = 1,  ///< a thread is reading the file
+  TUNE_LOADED = 2,   ///< the parameters are ready
+} TuneState;
+
+/**
+ * @brief the parameters in the order of the config file
+ */
+typedef enum TuneIndex {
+  TUNE_GEMM_BLOCK_K = 0,     ///< MATRIX_GEMM_BLOCK_K
+  TUNE_GEMM_BLOCK_N = 1,     ///< MATRIX_GEMM_BLOCK_N
+  TUNE_TRANSPOSE_LEAF = 2,   ///< MATRIX_TRANSPOSE_LEAF
+  TUNE_STRASSEN_ENABLE = 3,  ///< MATRIX_STRASSEN_ENABLE
+  TUNE_STRASSEN_CUTOFF = 4,  ///< MATRIX_STRASSEN_CUTOFF
+  TUNE_GEMM_3M_ENABLE = 5,   ///< MATRIX_GEMM_3M_ENABLE
+  TUNE_GEMM_3M_CUTOFF = 6,   ///< MATRIX_GEMM_3M_CUTOFF
+  TUNE_PARAMETER_NUMBER = 7, ///< the number of parameters
+} TuneIndex;
+
+/**
+ * @brief a parameter of the config file
+ */
+typedef struct TuneParameterT {
+  const char *name; ///< the name of the macro
+  size_t minimum;   ///< the smallest value accepted
+} TuneParameterT;
+
+// variables
+
+static atomic_size_t tune_values[TUNE_PARAMETER_NUMBER] = {
+    [TUNE_GEMM_BLOCK_K] = MATRIX_GEMM_BLOCK_K,
+    [TUNE_GEMM_BLOCK_N] = MATRIX_GEMM_BLOCK_N,
+    [TUNE_TRANSPOSE_LEAF] = MATRIX_TRANSPOSE_LEAF,
+    [TUNE_STRASSEN_ENABLE] = MATRIX_STRASSEN_ENABLE,
+    [TUNE_STRASSEN_CUTOFF] = MATRIX_STRASSEN_CUTOFF,
+    [TUNE_GEMM_3M_ENABLE] = MATRIX_GEMM_3M_ENABLE,
+    [TUNE_GEMM_3M_CUTOFF] = MATRIX_GEMM_3M_CUTOFF,
+};
+static atomic_int tune_state = TUNE_UNLOADED;
+
+static const TuneParameterT tune_parameters[TUNE_PARAMETER_NUMBER] = {
+    [TUNE_GEMM_BLOCK_K] = {"MATRIX_GEMM_BLOCK_K", 1},
+    [TUNE_GEMM_BLOCK_N] = {"MATRIX_GEMM_BLOCK_N", 1},
+    [TUNE_TRANSPOSE_LEAF] = {"MATRIX_TRANSPOSE_LEAF", 8},
+    [TUNE_STRASSEN_ENABLE] = {"MATRIX_STRASSEN_ENABLE", 0},
+    [TUNE_STRASSEN_CUTOFF] = {"MATRIX_STRASSEN_CUTOFF", 1},
+    [TUNE_GEMM_3M_ENABLE] = {"MATRIX_GEMM_3M_ENABLE", 0},
+    [TUNE_GEMM_3M_CUTOFF] = {"MATRIX_GEMM_3M_CUTOFF", 0},
+};
+
+// functions: helpers
+
+/**
+ * @brief store a value of a parameter, raised to its minimum
+ *
+ * @param[in] index the parameter
+ * @param[in] value the value to store
+ */
+static void store_parameter(TuneIndex index, size_t value) {
+  atomic_store(&tune_values[index], MAX(value, tune_parameters[index].minimum));
+}
+
+/**
+ * @brief load a value of a parameter
+ *
+ * @param[in] index the parameter
+ * @return the value
+ */
+static size_t load_parameter(TuneIndex index) {
+  return atomic_load(&tune_values[index]);
+}
+
+/**
+ * @brief read a config file into the parameters, only "#define NAME VALUE"
+ *        lines are read and the other lines are ignored
+ *
+ * @param[in] file_path the path of the file
+ */
+static void read_tune_file(const char *file_path) {
+  // test: open file
+  FILE *file_handle = fopen(file_path, "r");
+  if (file_handle == NULL) {
+    log_error("panic: failed to open file (%.64s)", file_path);
+    exit(EXIT_FAILURE);
+  }
+  char line[TUNE_MAX_LINE];
+  // a line longer than the buffer is read in pieces of the same line
+  size_t line_number = 0;
+  bool is_line_start = true;
+  while (fgets(line, sizeof(line), file_handle) != NULL) {
+    line_number += is_line_start;
+    is_line_start = strchr(line, '\n') != NULL;
+    const char *cursor = line;
+    while (isspace((unsigned char)*cursor)) {
+      ++cursor;
+    }
+    if (strncmp(cursor, "#define", strlen("#define")) != 0) {
+      continue;
+    }
+    char name[TUNE_MAX_LINE];
+    char value[TUNE_MAX_LINE];
+    if (sscanf(cursor, "#define %255s %255s", name, value) != 2 ||
+        !isdigit((unsigned char)value[0])) {
+      fclose(file_handle);
+      log_error("panic: illegal tuning line %zu in %.64s", line_number,
+                file_path);
+      exit(EXIT_FAILURE);
+    }
+    size_t index = 0;
+    while (index < TUNE_PARAMETER_NUMBER &&
+           strcmp(tune_parameters[index].name, name) != 0) {
+      ++index;
+    }
+    if (index == TUNE_PARAMETER_NUMBER) {
+      fclose(file_handle);
+      log_error("panic: unknown tuning parameter (%.64s) at line %zu in %.64s",
+                name, line_number, file_path);
+      exit(EXIT_FAILURE);
+    }
+    store_parameter(index, strtoull(value, NULL, 10));
+  }
+  fclose(file_handle);
+}
+
+/**
+ * @brief load the config file named by the environment once, before any
+ *        parameter is read or written
+ */
+static void load_tune_environment(void) {
+  if (atomic_load_explicit(&tune_state, memory_order_acquire) == TUNE_LOADED) {
+    return;
+  }
+  int expected = TUNE_UNLOADED;
+  if (atomic_compare_exchange_strong(&tune_state, &expected, TUNE_LOADING)) {
+    const char *file_path = getenv(TUNE_ENVIRONMENT);
+    if (file_path != NULL && file_path[0] != '\0') {
+      read_tune_file(file_path);
+    }
+    atomic_store_explicit(&tune_state, TUNE_LOADED, memory_order_release);
+    return;
+  }
+  // another thread is loading the file
+  while (atomic_load_explicit(&tune_state, memory_order_acquire) !=
+         TUNE_LOADED) {
+  }
+}
+
+// functions: Strassen-Winograd
+
+void set_matrix_strassen(const MatrixStrassenT *option) {
+  load_tune_environment();
+  // NULL restores the defaults
+  if (option == NULL) {
+    store_parameter(TUNE_STRASSEN_CUTOFF, MATRIX_STRASSEN_CUTOFF);
+    store_parameter(TUNE_STRASSEN_ENABLE, MATRIX_STRASSEN_ENABLE);
+    return;
+  }
+  // a cutoff below 1 would never stop
+  store_parameter(TUNE_STRASSEN_CUTOFF, option->cutoff);
+  store_parameter(TUNE_STRASSEN_ENABLE, option->enable);
+}
+
+MatrixStrassenT get_matrix_strassen(void) {
+  load_tune_environment();
+  return (MatrixStrassenT){
+      .enable = load_parameter(TUNE_STRASSEN_ENABLE) != 0,
+      .cutoff = load_parameter(TUNE_STRASSEN_CUTOFF),
+  };
+}
+
+float get_matrix_strassen_error_bound(size_t m, size_t n, size_t k) {
+  MatrixStrassenT option = get_matrix_strassen();
+  // count the levels as kernel_gemm() splits
+  size_t level = 0;
+  size_t inner = k;
+  while (option.enable && MIN(MIN(m, n), k) > option.cutoff) {
+    m /= 2;
+    n /= 2;
+    k /= 2;
+    ++level;
+  }
+  // the classical bound k^2 u, FLT_EPSILON is 2u for the complex products
+  if (level == 0) {
+    return (float)inner * (float)inner * FLT_EPSILON;
+  }
+  // Higham, Accuracy and Stability of Numerical Algorithms, theorem 23.3:
+  // (18^l (k0^2 + 6 k0) - 6 k) u with the inner size k0 at the leaves
+  double leaf = (double)k;
+  double bound = pow(18.0, (double)level) * (leaf * leaf + 6.0 * leaf) -
+                 6.0 * (double)inner;
+  return (float)(bound * FLT_EPSILON);
+}
+
+// functions: 3M
+
+void set_matrix_gemm_3m(const MatrixGemm3mT *option) {
+  load_tune_environment();
+  // NULL restores the defaults
+  if (option == NULL) {
+    store_parameter(TUNE_GEMM_3M_CUTOFF, MATRIX_GEMM_3M_CUTOFF);
+    store_parameter(TUNE_GEMM_3M_ENABLE, MATRIX_GEMM_3M_ENABLE);
+    return;
+  }
+  store_parameter(TUNE_GEMM_3M_CUTOFF, option->cutoff);
+  store_parameter(TUNE_GEMM_3M_ENABLE, option->enable);
+}
+
+MatrixGemm3mT get_matrix_gemm_3m(void) {
+  load_tune_environment();
+  return (MatrixGemm3mT){
+      .enable = load_parameter(TUNE_GEMM_3M_ENABLE) != 0,
+      .cutoff = load_parameter(TUNE_GEMM_3M_CUTOFF),
+  };
+}
+
+// functions: block sizes
+
+void set_matrix_block(const MatrixBlockT *block) {
+  load_tune_environment();
+  // NULL restores the defaults
+  if (block == NULL) {
+    store_parameter(TUNE_GEMM_BLOCK_K, MATRIX_GEMM_BLOCK_K);
+    store_parameter(TUNE_GEMM_BLOCK_N, MATRIX_GEMM_BLOCK_N);
+    store_parameter(TUNE_TRANSPOSE_LEAF, MATRIX_TRANSPOSE_LEAF);
+    return;
+  }
+  store_parameter(TUNE_GEMM_BLOCK_K, block->gemm_k);
+  store_parameter(TUNE_GEMM_BLOCK_N, block->gemm_n);
+  store_parameter(TUNE_TRANSPOSE_LEAF, block->transpose_leaf);
+}
+
+MatrixBlockT get_matrix_block(void) {
+  load_tune_environment();
+  return (MatrixBlockT){
+      .gemm_k = load_parameter(TUNE_GEMM_BLOCK_K),
+      .gemm_n = load_parameter(TUNE_GEMM_BLOCK_N),
+      .transpose_leaf = load_parameter(TUNE_TRANSPOSE_LEAF),
+  };
+}
+
+// functions: config
+
+void load_matrix_tune(const char *file_path) {
+  // boundary test: null pointer
+  if (file_path == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  load_tune_environment();
+  read_tune_file(file_path);
+}
+
+void save_matrix_tune(const char *file_path) {
+  // boundary test: null pointer
+  if (file_path == NULL) {
+    log_error("panic: null pointer error at %s", __func__);
+    exit(EXIT_FAILURE);
+  }
+  load_tune_environment();
+  // test: open file
+  FILE *file_handle = fopen(file_path, "w");
+  if (file_handle == NULL) {
+    log_error("panic: failed to open file (%.64s)", file_path);
+    exit(EXIT_FAILURE);
+  }
+  // the file is also a header which gives the defaults of a build
+  fputs("// tuning parameters of cmatrix, see matrix/matrix_tune.h\n",
+        file_handle);
+  for (size_t i = 0; i < TUNE_PARAMETER_NUMBER; ++i) {
+    fprintf(file_handle, "#define %s %zu\n", tune_parameters[i].name,
+            load_parameter(i));
+  }
+  fclose(file_handle);
+}
@@ -0,0 +1,304 @@
+/**
+ * @file tune/autotune_matrix.c
+ * @brief autotuner of matrix library
+ *
+ * the block sizes of transposition and multiplication, the 3M method and
+ * the cutoff of Strassen-Winograd are swept in that order on the local
+ * machine, every step keeps the best value found so far, and the result is
+ * written as a config file for CMATRIX_TUNE or the "tune" option of meson
+ *
+ * the 3M method weakens the accuracy of the imaginary part, so it is only
+ * swept with --allow-3m and stays off otherwise
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+// include
+
+#include "matrix/matrix.h"
+#include "matrix/matrix_tune.h"
+#include "matrix/utils.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// macros
+
+/**
+ * \def ARRAY_SIZE
+ *
+ * the number of elements of an array
+ */
+#define ARRAY_SIZE(array) (sizeof(array) / sizeof((array)[0]))
+
+// types
+
+/**
+ * @brief the operands shared by all measurements
+ */
+typedef struct TuneStateT {
+  size_t repeat;       ///< the number of timed runs of a candidate
+  bool allow_3m;       ///< whether the 3M method may be chosen
+  MatrixT *square[4];  ///< square operands of the sizes of tune_sizes
+  MatrixT *transposed; ///< the operand of transposition
+} TuneStateT;
+
+// constants
+
+/**
+ * @brief the sizes of the products which choose the algorithms
+ */
+static const uint8_t tune_sizes[] = {64, 128, 192, UINT8_MAX};
+
+/**
+ * @brief the candidates of the block sizes and the cutoffs, 0 turns the
+ *        method off
+ */
+static const size_t transpose_leaves[] = {8, 16, 32, 64, 128};
+static const size_t gemm_depths[] = {16, 32, 64, 128, 256};
+static const size_t gemm_widths[] = {32, 64, 128, 256};
+static const size_t gemm_3m_cutoffs[] = {0, 8, 16, 32, 64, 128};
+static const size_t strassen_cutoffs[] = {0, 32, 48, 64, 96, 128};
+
+// functions: helpers
+
+/**
+ * @brief get the monotonic time
+ *
+ * @return the time in nanoseconds
+ */
+static double get_time_ns(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+/**
+ * @brief get the best time of a function after one warm-up run, the minimum
+ *        is the least disturbed by the other processes of the machine
+ *
+ * @param[in] state the operands
+ * @param[in] run the function to time
+ * @param[in] index the argument of \p run
+ * @return the best time in nanoseconds
+ */
+static double time_best(const TuneStateT *state,
+                        void (*run)(const TuneStateT *, size_t),
+                        size_t index) {
+  run(state, index);
+  double best = -1.0;
+  for (size_t i = 0; i < state->repeat; ++i) {
+    double start = get_time_ns();
+    run(state, index);
+    double time = get_time_ns() - start;
+    best = best < 0.0 ? time : MIN(best, time);
+  }
+  return best;
+}
+
+/**
+ * @brief transpose out of place and in place
+ */
+static void run_transpose(const TuneStateT *state, size_t index) {
+  (void)index;
+  drop_matrix(transpose_matrix(state->transposed));
+  conjugate_transpose_matrix_in_place(state->transposed);
+}
+
+/**
+ * @brief multiply with B read by rows and by columns
+ */
+static void run_panel(const TuneStateT *state, size_t index) {
+  const MatrixT *operand = state->square[index];
+  drop_matrix(mul_matrix(operand, operand));
+  drop_matrix(mul_matrix_with_operation(NO_TRANSPOSE, operand,
+                                        CONJUGATE_TRANSPOSE, operand));
+}
+
+/**
+ * @brief multiply two square matrices
+ */
+static void run_mul(const TuneStateT *state, size_t index) {
+  const MatrixT *operand = state->square[index];
+  drop_matrix(mul_matrix(operand, operand));
+}
+
+/**
+ * @brief get the cost of the products over all sizes, every size is
+ *        weighted by its time with the current settings so that the small
+ *        sizes count as much as the large ones
+ *
+ * @param[in] state the operands
+ * @param[in] baseline the times with the current settings, filled if
+ *            \p is_baseline
+ * @param[in] is_baseline whether this is the run of the current settings
+ * @return the mean ratio to the baseline
+ */
+static double time_products(const TuneStateT *state, double *baseline,
+                            bool is_baseline) {
+  double cost = 0.0;
+  for (size_t i = 0; i < ARRAY_SIZE(tune_sizes); ++i) {
+    double time = time_best(state, run_mul, i);
+    if (is_baseline) {
+      baseline[i] = time;
+    }
+    cost += time / baseline[i];
+  }
+  return cost / ARRAY_SIZE(tune_sizes);
+}
+
+// functions: steps
+
+/**
+ * @brief choose the leaf size of transposition
+ */
+static void tune_transpose(const TuneStateT *state) {
+  MatrixBlockT block = get_matrix_block();
+  size_t best_leaf = block.transpose_leaf;
+  double best_time = -1.0;
+  for (size_t i = 0; i < ARRAY_SIZE(transpose_leaves); ++i) {
+    block.transpose_leaf = transpose_leaves[i];
+    set_matrix_block(&block);
+    double time = time_best(state, run_transpose, 0);
+    printf("transpose leaf %3zu: %10.1f us\n", transpose_leaves[i],
+           time / 1e3);
+    if (best_time < 0.0 || time < best_time) {
+      best_time = time;
+      best_leaf = transpose_leaves[i];
+    }
+  }
+  block.transpose_leaf = best_leaf;
+  set_matrix_block(&block);
+}
+
+/**
+ * @brief choose the panel of multiplication at the largest size
+ */
+static void tune_panel(const TuneStateT *state) {
+  MatrixBlockT block = get_matrix_block();
+  MatrixBlockT best_block = block;
+  double best_time = -1.0;
+  size_t largest = ARRAY_SIZE(tune_sizes) - 1;
+  for (size_t i = 0; i < ARRAY_SIZE(gemm_depths); ++i) {
+    for (size_t j = 0; j < ARRAY_SIZE(gemm_widths); ++j) {
+      block.gemm_k = gemm_depths[i];
+      block.gemm_n = gemm_widths[j];
+      set_matrix_block(&block);
+      double time = time_best(state, run_panel, largest);
+      printf("gemm panel %3zu x %3zu: %10.1f us\n", block.gemm_k,
+             block.gemm_n, time / 1e3);
+      if (best_time < 0.0 || time < best_time) {
+        best_time = time;
+        best_block = block;
+      }
+    }
+  }
+  set_matrix_block(&best_block);
+}
+
+/**
+ * @brief choose whether and from which size the 3M method is used
+ */
+static void tune_gemm_3m(const TuneStateT *state) {
+  double baseline[ARRAY_SIZE(tune_sizes)];
+  MatrixGemm3mT best_option = {.enable = false, .cutoff = 0};
+  double best_cost = -1.0;
+  for (size_t i = 0; i < ARRAY_SIZE(gemm_3m_cutoffs); ++i) {
+    MatrixGemm3mT option = {
+        .enable = gemm_3m_cutoffs[i] != 0,
+        .cutoff = gemm_3m_cutoffs[i],
+    };
+    set_matrix_gemm_3m(&option);
+    double cost = time_products(state, baseline, i == 0);
+    printf("3m cutoff %3zu: %6.3f\n", gemm_3m_cutoffs[i], cost);
+    if (best_cost < 0.0 || cost < best_cost) {
+      best_cost = cost;
+      best_option = option;
+    }
+  }
+  // an unused cutoff keeps its default
+  if (!best_option.enable) {
+    best_option.cutoff = MATRIX_GEMM_3M_CUTOFF;
+  }
+  set_matrix_gemm_3m(&best_option);
+}
+
+/**
+ * @brief choose whether and from which size Strassen-Winograd is used
+ */
+static void tune_strassen(const TuneStateT *state) {
+  double baseline[ARRAY_SIZE(tune_sizes)];
+  MatrixStrassenT best_option = {.enable = false, .cutoff = 0};
+  double best_cost = -1.0;
+  for (size_t i = 0; i < ARRAY_SIZE(strassen_cutoffs); ++i) {
+    MatrixStrassenT option = {
+        .enable = strassen_cutoffs[i] != 0,
+        .cutoff = strassen_cutoffs[i],
+    };
+    set_matrix_strassen(&option);
+    double cost = time_products(state, baseline, i == 0);
+    printf("strassen cutoff %3zu: %6.3f\n", strassen_cutoffs[i], cost);
+    if (best_cost < 0.0 || cost < best_cost) {
+      best_cost = cost;
+      best_option = option;
+    }
+  }
+  if (!best_option.enable) {
+    best_option.cutoff = MATRIX_STRASSEN_CUTOFF;
+  }
+  set_matrix_strassen(&best_option);
+}
+
+// functions: main
+
+int main(int argc, char **argv) {
+  const char *output = "cmatrix_tune.h";
+  TuneStateT state = {.repeat = 9, .allow_3m = false};
+  for (int i = 1; i < argc; ++i) {
+    const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+    if (strcmp(argv[i], "--allow-3m") == 0) {
+      state.allow_3m = true;
+      continue;
+    }
+    if (strcmp(argv[i], "--output") == 0 && value != NULL) {
+      output = value;
+    } else if (strcmp(argv[i], "--repeat") == 0 && value != NULL &&
+               atoi(value) > 0) {
+      state.repeat = (size_t)atoi(value);
+    } else {
+      log_error("usage: %.64s [--output file] [--repeat count] [--allow-3m]",
+                argv[0]);
+      return EXIT_FAILURE;
+    }
+    ++i;
+  }
+  srand(1);
+  for (size_t i = 0; i < ARRAY_SIZE(tune_sizes); ++i) {
+    state.square[i] = new_random_matrix(tune_sizes[i], tune_sizes[i]);
+  }
+  state.transposed = new_random_matrix(UINT8_MAX, UINT8_MAX);
+  // the blocks are measured on the classical product alone
+  set_matrix_strassen(&(MatrixStrassenT){.enable = false, .cutoff = 1});
+  set_matrix_gemm_3m(&(MatrixGemm3mT){.enable = false, .cutoff = 0});
+  tune_transpose(&state);
+  tune_panel(&state);
+  // the less accurate 3M method is only chosen on request
+  if (state.allow_3m) {
+    tune_gemm_3m(&state);
+  } else {
+    set_matrix_gemm_3m(&(MatrixGemm3mT){.enable = false,
+                                        .cutoff = MATRIX_GEMM_3M_CUTOFF});
+  }
+  tune_strassen(&state);
+  save_matrix_tune(output);
+  printf("saved to %s\n", output);
+  for (size_t i = 0; i < ARRAY_SIZE(tune_sizes); ++i) {
+    drop_matrix(state.square[i]);
+  }
+  drop_matrix(state.transposed);
+  return 0;
+}